@@ -0,0 +1,215 @@
+// Copyright 2018 - 2026, Joonas Nättilä and the hel-astro-lab contributors
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "communicator.h"
+
+
+namespace mpi4cpp { namespace mpi {
+
+/**
+ * @brief A constant representing "no process."
+ *
+ * Neighbours beyond a non-periodic boundary of a Cartesian grid are
+ * @c proc_null; sends to and receives from it complete immediately
+ * without transferring data, so halo loops need no special cases at
+ * the domain edges.
+ */
+const int proc_null = MPI_PROC_NULL;
+
+
+/**
+ * @brief Extent and periodicity of one dimension of a Cartesian grid.
+ *
+ * A @c size of 0 lets @c cartesian_dimensions (i.e. @c MPI_Dims_create)
+ * choose it such that the grid is as balanced as possible.
+ */
+struct cartesian_dimension
+{
+  /// Number of processes along the dimension
+  int size;
+
+  /// Is the dimension periodic, i.e. do its ends wrap around?
+  bool periodic;
+
+  cartesian_dimension(int sz = 0, bool p = false) : size(sz), periodic(p) {}
+};
+
+
+/**
+ * @brief Fill in the zero entries of @p dims with a balanced
+ * decomposition of @p nb_proc processes.
+ *
+ * Equivalent to @c MPI_Dims_create: the non-zero entries are kept and
+ * their product must divide @p nb_proc.
+ *
+ * @returns @p dims
+ */
+std::vector<int>& cartesian_dimensions(int nb_proc, std::vector<int>& dims);
+
+
+/**
+ * @brief A communicator whose processes are arranged in a Cartesian
+ * grid, e.g. for the domain decomposition of a 2D or 3D mesh.
+ *
+ * The grid is created with @c MPI_Cart_create with reordering enabled
+ * by default, so the MPI library may renumber the processes to match
+ * the hardware; the rank of a process in the new communicator can thus
+ * differ from its rank in the parent communicator. Processes are
+ * numbered in row-major order of their coordinates.
+ *
+ * The coordinates of the calling process and the ranks of all its
+ * neighbours (the @c 3^ndims()-1 processes whose coordinates differ by
+ * at most one in every dimension) are computed once when the
+ * communicator is created and shared by its copies, so the queries used
+ * in halo exchange loops do not call into MPI:
+ *
+ *   @code
+ *   mpi::cartesian_communicator grid(world, {{0, true}, {0, true}, {0, false}});
+ *   auto [left, right] = grid.shifted_ranks(0);
+ *   int corner = grid.neighbor({1, 1, -1}); // proc_null at the z = 0 wall
+ *   @endcode
+ */
+class cartesian_communicator : public communicator
+{
+ public:
+  /**
+   * Build a Cartesian grid of the processes of @p comm.
+   *
+   * Dimensions of size 0 are chosen with @c cartesian_dimensions. If
+   * the grid has fewer processes than @p comm, the remaining processes
+   * get an invalid communicator (which converts to @c false).
+   *
+   * @param comm The communicator whose processes form the grid.
+   *
+   * @param dims Extent and periodicity of every dimension.
+   *
+   * @param reorder Whether MPI may renumber the processes.
+   */
+  cartesian_communicator(const communicator& comm,
+                         const std::vector<cartesian_dimension>& dims,
+                         bool reorder = true);
+
+  /**
+   * Build the sub-grid of @p comm that keeps the dimensions @p keep
+   * and contains the calling process, equivalent to @c MPI_Cart_sub.
+   * E.g. keeping only dimension 0 of a 3D grid gives the "pencil" of
+   * processes sharing the same y and z coordinates.
+   *
+   * @param comm The grid to slice.
+   *
+   * @param keep The indices of the dimensions to keep.
+   */
+  cartesian_communicator(const cartesian_communicator& comm,
+                         const std::vector<int>& keep);
+
+  /**
+   * Number of dimensions of the grid.
+   */
+  int ndims() const { return static_cast<int>(m_topology->dims.size()); }
+
+  /**
+   * Extent and periodicity of every dimension.
+   */
+  const std::vector<cartesian_dimension>& topology() const { return m_topology->dims; }
+
+  /**
+   * Coordinates of the calling process in the grid.
+   */
+  const std::vector<int>& coordinates() const { return m_topology->coords; }
+
+  /**
+   * Coordinates of process @p rank, equivalent to @c MPI_Cart_coords.
+   */
+  std::vector<int> coordinates(int rank) const;
+
+  /**
+   * Rank of the process at @p coords, equivalent to @c MPI_Cart_rank.
+   * Coordinates outside of periodic dimensions are wrapped around; the
+   * ones outside of other dimensions are invalid.
+   */
+  int rank(const std::vector<int>& coords) const;
+
+  using communicator::rank;
+
+  /**
+   * @brief Ranks of the source and the destination of a shift by
+   * @p disp along dimension @p dim, equivalent to @c MPI_Cart_shift.
+   *
+   * For @p disp = 1 these are the lower and the upper neighbour; they
+   * are @c proc_null beyond a non-periodic boundary. Shifts by +-1 are
+   * looked up in the cached neighbour table.
+   *
+   * @returns The pair (source, destination).
+   */
+  std::pair<int, int> shifted_ranks(int dim, int disp = 1) const;
+
+  /**
+   * Rank of the neighbour at the relative position @p offset, whose
+   * entries are -1, 0 or 1; @c proc_null beyond a non-periodic
+   * boundary. Looked up in the cached neighbour table.
+   */
+  int neighbor(const std::vector<int>& offset) const;
+
+  /**
+   * Ranks of all @c 3^ndims()-1 neighbours, ordered by their offsets
+   * with the last dimension varying fastest, from (-1,...,-1) to
+   * (1,...,1) with (0,...,0) left out.
+   */
+  const std::vector<int>& neighbors() const { return m_topology->neighbors; }
+
+  /**
+   * The neighbourhood of the neighbourhood collectives (see
+   * neighborhood_collectives.h): the lower and the upper neighbour of
+   * every dimension in turn, i.e. the @c 2*ndims() processes returned
+   * by @c shifted_ranks(dim) for all @c dim. Blocks are both received
+   * from and sent to them in this order.
+   */
+  const std::vector<int>& sources() const { return m_topology->shifts; }
+
+  /**
+   * Same as @c sources(): the neighbourhood of a Cartesian grid is
+   * symmetric.
+   */
+  const std::vector<int>& destinations() const { return m_topology->shifts; }
+
+ private:
+  /**
+   * INTERNAL ONLY
+   *
+   * Topology queries of the calling process, computed once per MPI
+   * communicator.
+   */
+  struct cache
+  {
+    std::vector<cartesian_dimension> dims;
+    std::vector<int> coords;
+
+    /// Ranks of the 3^ndims neighbours including the process itself
+    std::vector<int> table;
+
+    /// The table without the process itself
+    std::vector<int> neighbors;
+
+    /// Lower and upper neighbour of every dimension
+    std::vector<int> shifts;
+  };
+
+  /// Fills the cache of the communicator in comm_ptr
+  void init_cache();
+
+  /// Index of @p offset in the neighbour table
+  static std::size_t table_index(const std::vector<int>& offset);
+
+  std::shared_ptr<const cache> m_topology;
+};
+
+
+} } // ns mpi4cpp::mpi
+
+#include "cartesian_communicator_impl.h"
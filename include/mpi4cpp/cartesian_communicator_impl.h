@@ -0,0 +1,181 @@
+// Copyright 2018 - 2026, Joonas Nättilä and the hel-astro-lab contributors
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <cassert>
+
+#include "cartesian_communicator.h"
+
+
+namespace mpi4cpp { namespace mpi {
+
+
+inline std::vector<int>&
+cartesian_dimensions(int nb_proc, std::vector<int>& dims)
+{
+  MPI_CHECK_RESULT(MPI_Dims_create,
+                  (nb_proc, static_cast<int>(dims.size()), dims.data()));
+  return dims;
+}
+
+
+inline
+cartesian_communicator::cartesian_communicator(const communicator& comm,
+                                               const std::vector<cartesian_dimension>& dims,
+                                               bool reorder)
+{
+  std::vector<int> sizes, periods;
+  bool complete = true;
+  for(auto& d : dims) {
+    sizes.push_back(d.size);
+    periods.push_back(d.periodic);
+    complete = complete && d.size > 0;
+  }
+  if (!complete) cartesian_dimensions(comm.size(), sizes);
+
+  MPI_Comm newcomm;
+  MPI_CHECK_RESULT(MPI_Cart_create,
+                  (MPI_Comm(comm), static_cast<int>(sizes.size()),
+                  sizes.data(), periods.data(), int(reorder), &newcomm));
+
+  // processes outside of the grid are left with an invalid communicator
+  if (newcomm != MPI_COMM_NULL) {
+    comm_ptr = std::make_shared<detail::comm_state>(newcomm, true, true);
+    init_cache();
+  } else
+    comm_ptr.reset();
+}
+
+
+inline
+cartesian_communicator::cartesian_communicator(const cartesian_communicator& comm,
+                                               const std::vector<int>& keep)
+{
+  std::vector<int> remain(comm.ndims(), 0);
+  for(int dim : keep) {
+    assert(dim >= 0 && dim < comm.ndims());
+    remain[dim] = 1;
+  }
+
+  MPI_Comm newcomm;
+  MPI_CHECK_RESULT(MPI_Cart_sub, (MPI_Comm(comm), remain.data(), &newcomm));
+  comm_ptr = std::make_shared<detail::comm_state>(newcomm, true, true);
+  init_cache();
+}
+
+
+inline void
+cartesian_communicator::init_cache()
+{
+  auto topo = std::make_shared<cache>();
+
+  int ndims = 0;
+  MPI_CHECK_RESULT(MPI_Cartdim_get, (MPI_Comm(*this), &ndims));
+
+  std::vector<int> sizes(ndims), periods(ndims);
+  topo->coords.resize(ndims);
+  MPI_CHECK_RESULT(MPI_Cart_get,
+                  (MPI_Comm(*this), ndims, sizes.data(), periods.data(),
+                  topo->coords.data()));
+  for(int d=0; d<ndims; d++)
+    topo->dims.emplace_back(sizes[d], periods[d] != 0);
+
+  // walk all offsets in {-1,0,1}^ndims, last dimension fastest
+  std::size_t n = 1;
+  for(int d=0; d<ndims; d++) n *= 3;
+  topo->table.resize(n);
+  topo->neighbors.reserve(n - 1);
+
+  std::vector<int> offset(ndims, -1), coords(ndims);
+  for(std::size_t i=0; i<n; i++) {
+    bool inside = true, self = true;
+    for(int d=0; d<ndims; d++) {
+      coords[d] = topo->coords[d] + offset[d];
+      self = self && offset[d] == 0;
+      if (!periods[d] && (coords[d] < 0 || coords[d] >= sizes[d])) inside = false;
+    }
+
+    int neighbor = proc_null;
+    if (inside)
+      MPI_CHECK_RESULT(MPI_Cart_rank, (MPI_Comm(*this), coords.data(), &neighbor));
+    topo->table[i] = neighbor;
+    if (!self) topo->neighbors.push_back(neighbor);
+
+    for(int d=ndims-1; d>=0; d--) {
+      if (++offset[d] <= 1) break;
+      offset[d] = -1;
+    }
+  }
+
+  // the process itself is in the middle of the table and moving along
+  // dimension d is a stride of 3^(ndims-1-d)
+  std::size_t center = n/2, stride = n;
+  for(int d=0; d<ndims; d++) {
+    stride /= 3;
+    topo->shifts.push_back(topo->table[center - stride]);
+    topo->shifts.push_back(topo->table[center + stride]);
+  }
+
+  m_topology = topo;
+}
+
+
+inline std::size_t
+cartesian_communicator::table_index(const std::vector<int>& offset)
+{
+  std::size_t index = 0;
+  for(int o : offset) {
+    assert(o >= -1 && o <= 1);
+    index = 3*index + static_cast<std::size_t>(o + 1);
+  }
+  return index;
+}
+
+
+inline std::vector<int>
+cartesian_communicator::coordinates(int rank) const
+{
+  std::vector<int> coords(ndims());
+  MPI_CHECK_RESULT(MPI_Cart_coords, (MPI_Comm(*this), rank, ndims(), coords.data()));
+  return coords;
+}
+
+
+inline int
+cartesian_communicator::rank(const std::vector<int>& coords) const
+{
+  assert(int(coords.size()) == ndims());
+  int r;
+  MPI_CHECK_RESULT(MPI_Cart_rank,
+                  (MPI_Comm(*this), const_cast<int*>(coords.data()), &r));
+  return r;
+}
+
+
+inline std::pair<int, int>
+cartesian_communicator::shifted_ranks(int dim, int disp) const
+{
+  assert(dim >= 0 && dim < ndims());
+
+  if (disp == 1 || disp == -1) {
+    int lower = m_topology->shifts[2*dim];
+    int upper = m_topology->shifts[2*dim + 1];
+    return disp == 1 ? std::make_pair(lower, upper) : std::make_pair(upper, lower);
+  }
+
+  int source, dest;
+  MPI_CHECK_RESULT(MPI_Cart_shift, (MPI_Comm(*this), dim, disp, &source, &dest));
+  return std::make_pair(source, dest);
+}
+
+
+inline int
+cartesian_communicator::neighbor(const std::vector<int>& offset) const
+{
+  assert(int(offset.size()) == ndims());
+  return m_topology->table[table_index(offset)];
+}
+
+
+} } // ns mpi4cpp::mpi
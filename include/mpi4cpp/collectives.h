@@ -0,0 +1,908 @@
+// Copyright 2018 - 2026, Joonas Nättilä and the hel-astro-lab contributors
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "detail/mpl.h"
+#include "communicator.h"
+#include "request.h"
+#include "persistent_request.h"
+#include "operations.h"
+#include "detail/mpi_op_cache.h"
+#include "detail/block_layout.h"
+
+
+/**
+ * MPI-4 provides persistent collectives (@c MPI_Allreduce_init etc.).
+ * Without them the persistent collectives of this header start the
+ * corresponding nonblocking collective on every @c start().
+ */
+#if defined(MPI_VERSION) && MPI_VERSION >= 4
+#define MPI4CPP_HAS_PERSISTENT_COLLECTIVES
+#endif
+
+/**
+ * Without MPI-4 large counts the counts and displacements of the vector
+ * collectives (@c gatherv, @c scatterv, @c all_to_allv, ...) are ints.
+ * When the blocks of some process do not fit, the blocking collectives
+ * throw @c MPI_Count_Overflow_Error on all processes, which costs them
+ * one extra @c MPI_Allreduce of a flag. The nonblocking ones lay out
+ * the blocks while they are tested or waited on; only the processes
+ * whose layout overflows throw there and the others are left waiting.
+ */
+
+
+namespace mpi4cpp { namespace mpi {
+
+//--------------------------------------------------
+// broadcast
+
+/**
+ *  @brief Broadcast a value from a root process to all other
+ *  processes.
+ *
+ *  @c broadcast is a collective algorithm that transfers a value from
+ *  an arbitrary @p root process to every other process that is part of
+ *  the given communicator. It maps to a single @c MPI_Bcast, so the
+ *  tree algorithms of the MPI library are used instead of @c size()-1
+ *  sends from the root.
+ *
+ *  The same type families as for @c communicator::send are supported:
+ *  MPI data types (including structs introduced with
+ *  @c MPI4CPP_STRUCT), contiguous ranges such as C arrays,
+ *  @c std::array and @c std::span, and the @c strided_view and
+ *  @c subarray views. Ranges and views are not resized, so they must
+ *  have the same number of elements on all processes.
+ *
+ *  @param comm The communicator over which the broadcast will occur.
+ *
+ *  @param value The value to be transmitted (if the rank of @p comm
+ *  is equal to @p root) or received (if the rank of @p comm is not
+ *  equal to @p root).
+ *
+ *  @param root The rank/process ID of the process that will be
+ *  transmitting the value.
+ */
+template<typename T>
+void broadcast(const communicator& comm, T& value, int root);
+
+/**
+ *  @brief Broadcast an array of @p n values from a root process.
+ *
+ *  All processes must pass the same @p n.
+ */
+template<typename T>
+void broadcast(const communicator& comm, T* values, std::size_t n, int root);
+
+/**
+ *  @brief Broadcast a vector from a root process.
+ *
+ *  The other processes do not need to know the length of the vector:
+ *  the size is broadcast first and their vectors are resized to it
+ *  before the elements follow with a second @c MPI_Bcast.
+ */
+template<typename T, typename A>
+void broadcast(const communicator& comm, std::vector<T,A>& values, int root);
+
+/**
+ *  @brief Broadcast a string from a root process, resizing it on the
+ *  other processes like a @c std::vector.
+ */
+template<typename C, class Tr, class A>
+void broadcast(const communicator& comm, std::basic_string<C,Tr,A>& values, int root);
+
+/**
+ *  @brief Broadcast into a temporary contiguous view that does not own
+ *  its elements (e.g. a @c std::span) or a @c strided_view /
+ *  @c subarray.
+ */
+template<typename R, typename = std::enable_if_t<
+  !std::is_lvalue_reference<R>::value &&
+  (detail::is_borrowed_range<R>::value || detail::is_datatype_view<R>::value)> >
+void broadcast(const communicator& comm, R&& values, int root);
+
+/**
+ *  The data broadcast into a temporary container would be lost.
+ */
+template<typename T, typename A>
+void broadcast(const communicator& comm, std::vector<T,A>&& values, int root) = delete;
+
+template<typename C, class Tr, class A>
+void broadcast(const communicator& comm, std::basic_string<C,Tr,A>&& values, int root) = delete;
+
+
+//--------------------------------------------------
+// reduce
+
+/**
+ *  @brief Combine the values stored by each process into a single
+ *  value at the root.
+ *
+ *  @c reduce is a collective algorithm that combines the values
+ *  stored by each process into a single value at the @c root. The
+ *  values are combined in a user-defined way, specified via a
+ *  function object. The type @c T of the values must be an MPI data
+ *  type (including structs introduced with @c MPI4CPP_STRUCT) or a
+ *  contiguous range of them, e.g. a @c std::array, which is then
+ *  reduced element by element.
+ *
+ *  When the function object and @c T map to a built-in MPI operation
+ *  (see @c is_mpi_op), e.g. @c std::plus<double> or @c maximum<>, the
+ *  operation is chosen at compile time. Any other function object,
+ *  e.g. a lambda, is wrapped into a user-defined @c MPI_Op that is
+ *  created on first use and cached for every (function object, @c T)
+ *  pair, so repeated reductions do not allocate or create operations.
+ *  Such operations are assumed non-commutative unless
+ *  @c is_commutative is specialized for them.
+ *
+ *  @param comm The communicator over which the reduction will occur.
+ *
+ *  @param in_value The local value to be combined with the local
+ *  values of every other process.
+ *
+ *  @param out_value Will receive the result of the reduction
+ *  operation on the root. If it is the same object as @p in_value the
+ *  root reduces in place. Not used on the other processes.
+ *
+ *  @param op The binary operation that combines two values of type
+ *  @c T and returns a third value of type @c T.
+ *
+ *  @param root The process ID number that will receive the final,
+ *  combined value.
+ */
+template<typename T, typename Op>
+void reduce(const communicator& comm, const T& in_value, T& out_value,
+            Op op, int root);
+
+/**
+ *  @brief Contribute a value to a reduction without receiving the
+ *  result, for processes other than the root.
+ */
+template<typename T, typename Op>
+void reduce(const communicator& comm, const T& in_value, Op op, int root);
+
+/**
+ *  @brief Reduce arrays of @p n values element by element into
+ *  @p out_values on the root.
+ *
+ *  @p out_values may be equal to @p in_values for an in-place
+ *  reduction on the root, or null on the other processes.
+ */
+template<typename T, typename Op>
+void reduce(const communicator& comm, const T* in_values, std::size_t n,
+            T* out_values, Op op, int root);
+
+/**
+ *  @brief Reduce vectors element by element. All processes must
+ *  contribute vectors of the same length; @p out_values is resized to
+ *  it on the root.
+ */
+template<typename T, typename A, typename Op>
+void reduce(const communicator& comm, const std::vector<T,A>& in_values,
+            std::vector<T,A>& out_values, Op op, int root);
+
+
+//--------------------------------------------------
+// all_reduce
+
+/**
+ *  @brief Combine the values stored by each process into a single
+ *  value available to all processes.
+ *
+ *  Like @c reduce, but every process receives the result, mapping to
+ *  @c MPI_Allreduce. This is the operation for e.g. the global energy
+ *  sum or the minimum time step:
+ *
+ *    @code
+ *    double dt = mpi::all_reduce(world, local_dt, mpi::minimum<>());
+ *    @endcode
+ *
+ *  If @p out_value is the same object as @p in_value the reduction is
+ *  done in place.
+ */
+template<typename T, typename Op>
+void all_reduce(const communicator& comm, const T& in_value, T& out_value,
+                Op op);
+
+/**
+ *  @brief Combine the values stored by each process and return the
+ *  result on all processes.
+ */
+template<typename T, typename Op>
+T all_reduce(const communicator& comm, const T& in_value, Op op);
+
+/**
+ *  @brief Reduce arrays of @p n values element by element into
+ *  @p out_values on all processes; may be done in place.
+ */
+template<typename T, typename Op>
+void all_reduce(const communicator& comm, const T* in_values, std::size_t n,
+                T* out_values, Op op);
+
+/**
+ *  @brief Reduce vectors of the same length element by element;
+ *  @p out_values is resized to it.
+ */
+template<typename T, typename A, typename Op>
+void all_reduce(const communicator& comm, const std::vector<T,A>& in_values,
+                std::vector<T,A>& out_values, Op op);
+
+
+//--------------------------------------------------
+// gather
+
+/**
+ *  @brief Gather the values stored at every process into a vector at
+ *  the root process.
+ *
+ *  @c gather is a collective algorithm that collects the values
+ *  stored at each process into a vector of values at the @p root
+ *  process. This vector is indexed by the process number that the
+ *  value came from. The type @c T of the values must be an MPI data
+ *  type; the operation maps to a single @c MPI_Gather.
+ *
+ *  @param comm The communicator over which the gather will occur.
+ *
+ *  @param in_value The value to be transmitted by each process.
+ *
+ *  @param out_values Will be resized to @c comm.size() and receive
+ *  the values on the root. Not used on the other processes.
+ *
+ *  @param root The process ID number that will collect the values.
+ */
+template<typename T, typename A>
+void gather(const communicator& comm, const T& in_value,
+            std::vector<T,A>& out_values, int root);
+
+/**
+ *  @brief Contribute a value to a gather, for processes other than
+ *  the root.
+ */
+template<typename T>
+void gather(const communicator& comm, const T& in_value, int root);
+
+/**
+ *  @brief Gather arrays of @p n values from every process into
+ *  @p out_values on the root, which must hold @c n*comm.size() values.
+ *  All processes must contribute the same @p n.
+ */
+template<typename T>
+void gather(const communicator& comm, const T* in_values, std::size_t n,
+            T* out_values, int root);
+
+/**
+ *  @brief Gather arrays of @p n values; @p out_values is resized to
+ *  @c n*comm.size() on the root.
+ */
+template<typename T, typename A>
+void gather(const communicator& comm, const T* in_values, std::size_t n,
+            std::vector<T,A>& out_values, int root);
+
+/**
+ *  @brief Contribute an array of @p n values to a gather, for
+ *  processes other than the root.
+ */
+template<typename T>
+void gather(const communicator& comm, const T* in_values, std::size_t n, int root);
+
+
+/**
+ *  @brief Gather the values stored at every process into vectors of
+ *  values at each process.
+ *
+ *  Like @c gather, but every process receives the result, mapping to
+ *  @c MPI_Allgather. @p out_values is resized to @c comm.size().
+ */
+template<typename T, typename A>
+void all_gather(const communicator& comm, const T& in_value,
+                std::vector<T,A>& out_values);
+
+/**
+ *  @brief Gather arrays of @p n values from every process into
+ *  @p out_values, which must hold @c n*comm.size() values, on all
+ *  processes.
+ */
+template<typename T>
+void all_gather(const communicator& comm, const T* in_values, std::size_t n,
+                T* out_values);
+
+/**
+ *  @brief Gather arrays of @p n values on all processes; @p out_values
+ *  is resized to @c n*comm.size().
+ */
+template<typename T, typename A>
+void all_gather(const communicator& comm, const T* in_values, std::size_t n,
+                std::vector<T,A>& out_values);
+
+
+//--------------------------------------------------
+// gatherv
+
+/**
+ *  @brief Gather vectors of different length from every process into
+ *  one flat vector at the root.
+ *
+ *  The lengths are gathered first, so no process needs to know how
+ *  much the others contribute. The root then receives all elements
+ *  with a single @c MPI_Gatherv directly into @p out_values, which is
+ *  resized to the total length; the elements of process @c r are
+ *  @c out_values[offsets[r]] to @c out_values[offsets[r+1]-1].
+ *
+ *  @param offsets Will be resized to @c comm.size()+1 and receive the
+ *  offsets of the contributions on the root.
+ *
+ *  @p out_values and @p offsets are not used on the other processes.
+ */
+template<typename T, typename A>
+void gatherv(const communicator& comm, const std::vector<T,A>& in_values,
+             std::vector<T,A>& out_values, std::vector<std::size_t>& offsets,
+             int root);
+
+/**
+ *  @brief Gather vectors of different length from every process into
+ *  a vector of vectors at the root.
+ *
+ *  Like the flat @c gatherv; @p out_values is resized to
+ *  @c comm.size() and element @c r holds the contribution of process
+ *  @c r. Each contribution is moved into its own vector with a single
+ *  block copy; use the flat version to avoid even that.
+ */
+template<typename T, typename A, typename AA>
+void gatherv(const communicator& comm, const std::vector<T,A>& in_values,
+             std::vector<std::vector<T,A>,AA>& out_values, int root);
+
+/**
+ *  @brief Contribute a vector to a @c gatherv, for processes other
+ *  than the root.
+ */
+template<typename T, typename A>
+void gatherv(const communicator& comm, const std::vector<T,A>& in_values,
+             int root);
+
+/**
+ *  @brief Gather vectors of different length from every process into
+ *  one flat vector at each process.
+ *
+ *  Like @c gatherv, but every process receives the result: the
+ *  lengths are exchanged with @c MPI_Allgather and the elements with a
+ *  single @c MPI_Allgatherv.
+ */
+template<typename T, typename A>
+void all_gatherv(const communicator& comm, const std::vector<T,A>& in_values,
+                 std::vector<T,A>& out_values, std::vector<std::size_t>& offsets);
+
+/**
+ *  @brief Gather vectors of different length from every process into
+ *  a vector of vectors at each process.
+ */
+template<typename T, typename A, typename AA>
+void all_gatherv(const communicator& comm, const std::vector<T,A>& in_values,
+                 std::vector<std::vector<T,A>,AA>& out_values);
+
+
+//--------------------------------------------------
+// scatter
+
+/**
+ *  @brief Scatter the values stored at the root to all processes
+ *  within the communicator.
+ *
+ *  @c scatter is a collective algorithm that scatters the values
+ *  stored in the @p root process (inside a vector) to all of the
+ *  processes in the communicator. The vector @p in_values (only
+ *  significant at the @p root) is indexed by the process number to
+ *  which the corresponding value will be sent. The type @c T of the
+ *  values must be an MPI data type; the operation maps to a single
+ *  @c MPI_Scatter.
+ *
+ *  @param comm The communicator over which the scatter will occur.
+ *
+ *  @param in_values A vector of @c comm.size() values on the root. Not
+ *  used on the other processes.
+ *
+ *  @param out_value The value received by this process.
+ *
+ *  @param root The process ID number that will scatter the values.
+ */
+template<typename T, typename A>
+void scatter(const communicator& comm, const std::vector<T,A>& in_values,
+             T& out_value, int root);
+
+/**
+ *  @brief Receive a value of a scatter, for processes other than the
+ *  root.
+ */
+template<typename T>
+void scatter(const communicator& comm, T& out_value, int root);
+
+/**
+ *  @brief Scatter arrays of @p n values: process @c r receives
+ *  elements @c r*n to @c (r+1)*n-1 of @p in_values, which holds
+ *  @c n*comm.size() values on the root.
+ */
+template<typename T>
+void scatter(const communicator& comm, const T* in_values, T* out_values,
+             std::size_t n, int root);
+
+/**
+ *  @brief Receive an array of @p n values of a scatter, for processes
+ *  other than the root.
+ */
+template<typename T>
+void scatter(const communicator& comm, T* out_values, std::size_t n, int root);
+
+
+//--------------------------------------------------
+// scatterv
+
+/**
+ *  @brief Scatter blocks of different length from a flat vector at
+ *  the root, e.g. the particles read from a file at startup.
+ *
+ *  Process @c r receives the @c sizes[r] elements of @p in_values that
+ *  follow the blocks of the lower ranks. The sizes are scattered first,
+ *  so only the root needs to know them, and @p out_values is resized
+ *  before all blocks go with a single @c MPI_Scatterv.
+ *
+ *  @param in_values The blocks of all processes back to back. Only
+ *  used on the root.
+ *
+ *  @param sizes The number of elements for each process. Only used
+ *  on the root.
+ *
+ *  @param out_values Will be resized to and receive the block of this
+ *  process.
+ */
+template<typename T, typename A>
+void scatterv(const communicator& comm, const std::vector<T,A>& in_values,
+              const std::vector<std::size_t>& sizes,
+              std::vector<T,A>& out_values, int root);
+
+/**
+ *  @brief Scatter a vector of vectors at the root: process @c r
+ *  receives @c in_values[r].
+ *
+ *  The root copies the blocks into one flat buffer (a single block
+ *  copy each) and scatters it like the flat @c scatterv.
+ */
+template<typename T, typename A, typename AA>
+void scatterv(const communicator& comm,
+              const std::vector<std::vector<T,A>,AA>& in_values,
+              std::vector<T,A>& out_values, int root);
+
+/**
+ *  @brief Receive a block of a @c scatterv, for processes other than
+ *  the root; @p out_values is resized to the block.
+ */
+template<typename T, typename A>
+void scatterv(const communicator& comm, std::vector<T,A>& out_values, int root);
+
+
+//--------------------------------------------------
+// all_to_all
+
+/**
+ *  @brief Send a different value to every process and receive one
+ *  value from each of them.
+ *
+ *  @c all_to_all is a collective algorithm that transmits
+ *  @c in_values[r] to process @c r and stores the value received from
+ *  process @c r in @c out_values[r]. It maps to a single
+ *  @c MPI_Alltoall; @p out_values is resized to @c comm.size().
+ *
+ *  @param comm The communicator over which the exchange will occur.
+ *
+ *  @param in_values One value for each process.
+ *
+ *  @param out_values Will receive the value of each process.
+ */
+template<typename T, typename A>
+void all_to_all(const communicator& comm, const std::vector<T,A>& in_values,
+                std::vector<T,A>& out_values);
+
+/**
+ *  @brief Exchange arrays of @p n values with every process:
+ *  @p in_values and @p out_values both hold @c comm.size() blocks of
+ *  @p n elements.
+ */
+template<typename T>
+void all_to_all(const communicator& comm, const T* in_values, std::size_t n,
+                T* out_values);
+
+
+//--------------------------------------------------
+// all_to_allv
+
+/**
+ *  @brief Reusable receive buffer of @c all_to_allv.
+ *
+ *  Holds the blocks received from all processes back to back in
+ *  @c values, with the block of process @c r in
+ *  [@c begin(r), @c end(r)). Besides the received values the buffer
+ *  keeps the counts and displacements handed to MPI and a staging
+ *  area for the outgoing buckets. All of them are only resized, never
+ *  shrunk, so an exchange that is repeated every time step with the
+ *  same buffer does not allocate once the capacities have grown to
+ *  the largest exchange.
+ */
+template<typename T, typename A = std::allocator<T> >
+class all_to_allv_buffer
+{
+ public:
+  /// The received blocks back to back
+  std::vector<T,A> values;
+
+  /// Offsets of the blocks in @c values followed by the total
+  std::vector<std::size_t> offsets;
+
+  /// Number of elements received from process @p source
+  std::size_t count(int source) const
+  { return offsets[source+1] - offsets[source]; }
+
+  /// First element received from process @p source
+  T* begin(int source) { return values.data() + offsets[source]; }
+  const T* begin(int source) const { return values.data() + offsets[source]; }
+
+  /// One past the last element received from process @p source
+  T* end(int source) { return values.data() + offsets[source+1]; }
+  const T* end(int source) const { return values.data() + offsets[source+1]; }
+
+  /// INTERNAL ONLY
+  std::vector<T,A> m_send;
+  std::vector<std::size_t> m_send_sizes;
+  std::vector<std::size_t> m_recv_sizes;
+  detail::block_layout m_send_layout;
+  detail::block_layout m_recv_layout;
+};
+
+/**
+ *  @brief Exchange blocks of different length between all processes,
+ *  e.g. the particles that left the local domain.
+ *
+ *  Process @c r receives @c buckets[r] of every process. The bucket
+ *  sizes are exchanged first with an @c MPI_Alltoall of the counts, the
+ *  receive displacements are derived from them and the payload of all
+ *  buckets goes with a single @c MPI_Alltoallv directly into
+ *  @c out.values. The buckets are copied into a staging buffer kept
+ *  in @p out (one block copy each) because @c MPI_Alltoallv needs the
+ *  outgoing blocks in one buffer.
+ *
+ *    @code
+ *    std::vector<std::vector<Particle>> outgoing(world.size());
+ *    mpi::all_to_allv_buffer<Particle> incoming; // reused every step
+ *    ...
+ *    mpi::all_to_allv(world, outgoing, incoming);
+ *    for(int r=0; r<world.size(); r++)
+ *      particles.insert(particles.end(), incoming.begin(r), incoming.end(r));
+ *    @endcode
+ *
+ *  @param comm The communicator over which the exchange will occur.
+ *
+ *  @param buckets One (possibly empty) vector for each process.
+ *
+ *  @param out Will receive the blocks of all processes; see
+ *  @c all_to_allv_buffer.
+ */
+template<typename T, typename A, typename AA>
+void all_to_allv(const communicator& comm,
+                 const std::vector<std::vector<T,A>,AA>& buckets,
+                 all_to_allv_buffer<T,A>& out);
+
+/**
+ *  @brief Exchange blocks of different length that are already back
+ *  to back in @p in_values: the first @c sizes[0] elements go to
+ *  process 0, the next @c sizes[1] to process 1 and so on. No staging
+ *  copy is made.
+ */
+template<typename T, typename A>
+void all_to_allv(const communicator& comm, const std::vector<T,A>& in_values,
+                 const std::vector<std::size_t>& sizes,
+                 all_to_allv_buffer<T,A>& out);
+
+
+//--------------------------------------------------
+// all_to_allw
+
+/**
+ *  @brief Exchange blocks that are described by a different datatype
+ *  for every process, e.g. the faces, edges and corners of a grid.
+ *
+ *  @c in_blocks[r] is sent to and @c out_blocks[r] is received from
+ *  process @c r with a single @c MPI_Alltoallw; the blocks are
+ *  transmitted directly from and into the arrays they view without
+ *  packing. The blocks may be @c strided_view and @c subarray views
+ *  (of possibly different shapes) or contiguous ranges such as
+ *  @c std::span; the type signatures of a sent and the matching
+ *  received block must agree like for @c send / @c recv.
+ *
+ *  Without MPI-4 large counts the byte distance between the blocks
+ *  must fit into an @c int since it is passed as a displacement.
+ *
+ *  @param comm The communicator over which the exchange will occur.
+ *
+ *  @param in_blocks One view to send to each process.
+ *
+ *  @param out_blocks One view to receive into from each process.
+ */
+template<typename S, typename R>
+void all_to_allw(const communicator& comm, const std::vector<S>& in_blocks,
+                 const std::vector<R>& out_blocks);
+
+
+//--------------------------------------------------
+// nonblocking collectives
+//
+// The nonblocking collectives start the operation and return a
+// request that completes it, so that e.g. a global reduction overlaps
+// with local work. The requests are used like those of @c isend and
+// @c irecv, also with @c wait_all, @c test_some etc. All buffers must
+// stay alive and untouched until the request has completed.
+//
+// Vectors and strings whose size is not known on every process are
+// transmitted in two steps: the sizes first, then, once they have
+// arrived, the payload into the resized containers. The second step is
+// posted while the request is tested or waited on, on a duplicate of
+// the communicator made when the first such collective is started, so
+// other collectives may be started meanwhile. The payloads of several
+// such requests are posted in the order they were started.
+
+/**
+ *  @brief Start a barrier: the request completes once all processes
+ *  in @p comm have entered it. Maps to @c MPI_Ibarrier.
+ */
+request ibarrier(const communicator& comm);
+
+/**
+ *  @brief Start a broadcast of a value from the @p root process.
+ *
+ *  Supports the same types as @c broadcast: MPI data types, contiguous
+ *  ranges and datatype views (which are not resized). Maps to a single
+ *  @c MPI_Ibcast.
+ */
+template<typename T>
+request ibroadcast(const communicator& comm, T& value, int root);
+
+/**
+ *  @brief Start a broadcast of an array of @p n values from the
+ *  @p root process.
+ */
+template<typename T>
+request ibroadcast(const communicator& comm, T* values, std::size_t n, int root);
+
+/**
+ *  @brief Start a broadcast of a vector from the @p root process; the
+ *  vectors of the other processes are resized once the size has
+ *  arrived.
+ */
+template<typename T, typename A>
+request ibroadcast(const communicator& comm, std::vector<T,A>& values, int root);
+
+/**
+ *  @brief Start a broadcast of a string from the @p root process,
+ *  resizing it on the other processes like a @c std::vector.
+ */
+template<typename C, class Tr, class A>
+request ibroadcast(const communicator& comm, std::basic_string<C,Tr,A>& values, int root);
+
+/**
+ *  @brief Start a reduction of @p in_value into @p out_value on the
+ *  @p root process; see @c reduce.
+ *
+ *  The reduction runs while the request is tested or waited on, after
+ *  @p op may have gone out of scope. User-defined function objects must
+ *  therefore be stateless (e.g. lambdas without captures); a copy of
+ *  them is kept for the cached @c MPI_Op.
+ */
+template<typename T, typename Op>
+request ireduce(const communicator& comm, const T& in_value, T& out_value,
+                Op op, int root);
+
+/**
+ *  @brief Start a reduction of arrays of @p n values element by element
+ *  into @p out_values on the root; may be done in place.
+ */
+template<typename T, typename Op>
+request ireduce(const communicator& comm, const T* in_values, std::size_t n,
+                T* out_values, Op op, int root);
+
+/**
+ *  @brief Start a reduction of vectors of the same length;
+ *  @p out_values is resized to it on the root.
+ */
+template<typename T, typename A, typename Op>
+request ireduce(const communicator& comm, const std::vector<T,A>& in_values,
+                std::vector<T,A>& out_values, Op op, int root);
+
+/**
+ *  @brief Start a reduction of @p in_value whose result becomes
+ *  available in @p out_value on all processes; see @c all_reduce.
+ *
+ *  User-defined function objects must be stateless like for
+ *  @c ireduce. If @p out_value is the same object as @p in_value the
+ *  reduction is done in place.
+ *
+ *    @code
+ *    double local = compute_energy();
+ *    double total;
+ *    mpi::request req = mpi::iall_reduce(world, local, total, std::plus<>());
+ *    push_particles();   // overlaps with the reduction
+ *    req.wait();
+ *    @endcode
+ */
+template<typename T, typename Op>
+request iall_reduce(const communicator& comm, const T& in_value, T& out_value,
+                    Op op);
+
+/**
+ *  @brief Start a reduction of arrays of @p n values element by element
+ *  into @p out_values on all processes; may be done in place.
+ */
+template<typename T, typename Op>
+request iall_reduce(const communicator& comm, const T* in_values, std::size_t n,
+                    T* out_values, Op op);
+
+/**
+ *  @brief Start a reduction of vectors of the same length;
+ *  @p out_values is resized to it.
+ */
+template<typename T, typename A, typename Op>
+request iall_reduce(const communicator& comm, const std::vector<T,A>& in_values,
+                    std::vector<T,A>& out_values, Op op);
+
+/**
+ *  @brief Start gathering a value from every process into
+ *  @p out_values on all processes; @p out_values is resized to
+ *  @c comm.size() right away.
+ */
+template<typename T, typename A>
+request iall_gather(const communicator& comm, const T& in_value,
+                    std::vector<T,A>& out_values);
+
+/**
+ *  @brief Start gathering arrays of @p n values from every process;
+ *  @p out_values must have room for @c comm.size()*n elements.
+ */
+template<typename T>
+request iall_gather(const communicator& comm, const T* in_values, std::size_t n,
+                    T* out_values);
+
+/**
+ *  @brief Start sending @c in_values[r] to every process @c r; see
+ *  @c all_to_all. @p out_values is resized to @c comm.size() right away.
+ */
+template<typename T, typename A>
+request iall_to_all(const communicator& comm, const std::vector<T,A>& in_values,
+                    std::vector<T,A>& out_values);
+
+/**
+ *  @brief Start exchanging arrays of @p n values with every process.
+ */
+template<typename T>
+request iall_to_all(const communicator& comm, const T* in_values, std::size_t n,
+                    T* out_values);
+
+/**
+ *  @brief Start exchanging blocks of different length between all
+ *  processes; see @c all_to_allv.
+ *
+ *  The buckets are copied into the staging area of @p out right away,
+ *  so they may be reused immediately. The bucket sizes are exchanged
+ *  with an @c MPI_Ialltoall; the payload follows with an
+ *  @c MPI_Ialltoallv into @c out.values once they have arrived.
+ */
+template<typename T, typename A, typename AA>
+request iall_to_allv(const communicator& comm,
+                     const std::vector<std::vector<T,A>,AA>& buckets,
+                     all_to_allv_buffer<T,A>& out);
+
+/**
+ *  @brief Start exchanging blocks of different length that are already
+ *  back to back in @p in_values, which must stay alive until the
+ *  request has completed.
+ */
+template<typename T, typename A>
+request iall_to_allv(const communicator& comm, const std::vector<T,A>& in_values,
+                     const std::vector<std::size_t>& sizes,
+                     all_to_allv_buffer<T,A>& out);
+
+
+//--------------------------------------------------
+// persistent collectives
+//
+// The persistent collectives bind a collective operation to its
+// buffers once, so that e.g. the reduction of the time step is started
+// again every iteration with @c start() and completed with @c wait(),
+// @c test() or the helpers of nonblocking.h. MPI can choose the
+// algorithm and the schedule a single time. With MPI-4 they map to the
+// @c MPI_*_init collectives; otherwise every @c start() initiates the
+// corresponding nonblocking collective (see
+// @c MPI4CPP_HAS_PERSISTENT_COLLECTIVES).
+//
+// Like all collectives, they are created and started in the same order
+// on all processes. The buffers must stay alive, and must not be
+// resized, for as long as the request is used.
+
+/**
+ *  @brief Create a persistent barrier.
+ */
+persistent_request barrier_init(const communicator& comm);
+
+/**
+ *  @brief Create a persistent broadcast of @p value from the @p root
+ *  process.
+ *
+ *  Supports MPI data types, contiguous ranges and datatype views.
+ */
+template<typename T>
+persistent_request broadcast_init(const communicator& comm, T& value, int root);
+
+/**
+ *  @brief Create a persistent broadcast of an array of @p n values
+ *  from the @p root process.
+ */
+template<typename T>
+persistent_request broadcast_init(const communicator& comm, T* values,
+                                  std::size_t n, int root);
+
+/**
+ *  @brief Create a persistent reduction of @p in_value whose result
+ *  becomes available in @p out_value on all processes.
+ *
+ *  User-defined function objects must be stateless like for
+ *  @c iall_reduce. If @p out_value is the same object as @p in_value
+ *  the reduction is done in place.
+ *
+ *    @code
+ *    double local_dt, dt;
+ *    auto min_dt = mpi::all_reduce_init(world, local_dt, dt, mpi::minimum<>());
+ *    for(int step=0; step<nsteps; step++) {
+ *      local_dt = courant_condition();
+ *      min_dt.start();
+ *      min_dt.wait();
+ *      advance(dt);
+ *    }
+ *    @endcode
+ */
+template<typename T, typename Op>
+persistent_request all_reduce_init(const communicator& comm, const T& in_value,
+                                   T& out_value, Op op);
+
+/**
+ *  @brief Create a persistent reduction of arrays of @p n values
+ *  element by element into @p out_values on all processes.
+ */
+template<typename T, typename Op>
+persistent_request all_reduce_init(const communicator& comm, const T* in_values,
+                                   std::size_t n, T* out_values, Op op);
+
+/**
+ *  @brief Create a persistent exchange of blocks of fixed but
+ *  different lengths between all processes, e.g. for a fixed halo
+ *  pattern.
+ *
+ *  The first @c sizes[r] elements of @p in_values following those of
+ *  the lower ranks go to process @c r. The sizes are exchanged once,
+ *  here, with a blocking @c MPI_Alltoall and @p out is laid out for
+ *  them; every @c start() then transfers the current contents of
+ *  @p in_values into @c out.values. Use @c all_to_allv when the sizes
+ *  change between the exchanges.
+ *
+ *  @p out is bound to the request: it must not be passed to other
+ *  exchanges or resized while the request exists, and @p in_values
+ *  must keep its storage.
+ */
+template<typename T, typename A>
+persistent_request all_to_allv_init(const communicator& comm,
+                                    const std::vector<T,A>& in_values,
+                                    const std::vector<std::size_t>& sizes,
+                                    all_to_allv_buffer<T,A>& out);
+
+
+} } // ns mpi4cpp::mpi
+
+#include "collectives_impl.h"
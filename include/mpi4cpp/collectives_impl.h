@@ -0,0 +1,1403 @@
+// Copyright 2018 - 2026, Joonas Nättilä and the hel-astro-lab contributors
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <type_traits>
+
+#include "collectives.h"
+
+
+namespace mpi4cpp { namespace mpi {
+
+//--------------------------------------------------
+// broadcast
+
+namespace detail {
+  // We're broadcasting an array of a type that has an associated MPI
+  // datatype, so we map directly to that datatype.
+  template<typename T>
+  inline void
+  array_broadcast_impl(const communicator& comm, T* values, std::size_t n,
+                       int root, mpl::true_ /*unused*/)
+  {
+    large_count count(get_mpi_datatype<T>(), n);
+    MPI_CHECK_RESULT(MPI4CPP_LARGE(MPI_Bcast),
+                    (values, count.count(), count.datatype(),
+                    root, MPI_Comm(comm)));
+  }
+
+  // Views with a derived datatype go as a single element of that type
+  inline void
+  datatype_broadcast_impl(const communicator& comm, void* base,
+                          MPI_Datatype type, int root)
+  {
+    MPI_CHECK_RESULT(MPI_Bcast, (base, 1, type, root, MPI_Comm(comm)));
+  }
+
+  // Resizable containers learn their size from the root first
+  template<class Container>
+  inline void
+  dynamic_broadcast_impl(const communicator& comm, Container& values, int root)
+  {
+    std::size_t n = values.size();
+    MPI_CHECK_RESULT(MPI_Bcast,
+                    (&n, 1, get_mpi_datatype<std::size_t>(), root, MPI_Comm(comm)));
+    values.resize(n);
+
+    using value_type = typename Container::value_type;
+    array_broadcast_impl(comm, values.data(), n, root,
+                         is_mpi_datatype<value_type>());
+  }
+}
+
+template<typename T>
+inline void
+broadcast(const communicator& comm, T& value, int root)
+{
+  // all but the root receive into the range
+  if constexpr (detail::is_contiguous_range<T>::value) {
+    static_assert(!std::is_const<std::remove_pointer_t<decltype(std::data(value))>>::value,
+                  "cannot broadcast into a read-only range");
+    detail::array_broadcast_impl(comm, std::data(value), std::size(value),
+                                 root, is_mpi_datatype<detail::range_value_t<T>>());
+  } else if constexpr (detail::is_datatype_view<T>::value) {
+    static_assert(!std::is_const<std::remove_pointer_t<decltype(value.base())>>::value,
+                  "cannot broadcast into a read-only view");
+    detail::datatype_broadcast_impl(comm, value.base(), value.datatype(), root);
+  } else
+    detail::array_broadcast_impl(comm, &value, 1, root, is_mpi_datatype<T>());
+}
+
+template<typename T>
+inline void
+broadcast(const communicator& comm, T* values, std::size_t n, int root)
+{
+  detail::array_broadcast_impl(comm, values, n, root, is_mpi_datatype<T>());
+}
+
+template<typename T, typename A>
+inline void
+broadcast(const communicator& comm, std::vector<T,A>& values, int root)
+{
+  detail::dynamic_broadcast_impl(comm, values, root);
+}
+
+template<typename C, class Tr, class A>
+inline void
+broadcast(const communicator& comm, std::basic_string<C,Tr,A>& values, int root)
+{
+  detail::dynamic_broadcast_impl(comm, values, root);
+}
+
+// temporary views (e.g. a subspan) still refer to the caller's buffer
+template<typename R, typename>
+inline void
+broadcast(const communicator& comm, R&& values, int root)
+{
+  broadcast(comm, values, root);
+}
+
+
+//--------------------------------------------------
+// reduce / all_reduce
+
+namespace detail {
+  /// @brief user-defined MPI operation applying the function object
+  /// type @c Op to values of type @c T
+  template<typename Op, typename T>
+  struct user_op
+  {
+    // function object of the reduction in progress on this thread;
+    // only needed for function objects that carry state
+    static inline thread_local const Op* current = nullptr;
+
+    // copy of a stateless function object for nonblocking reductions,
+    // which run after the caller's function object may have gone
+    static inline const Op* detached = nullptr;
+
+    static void detach(const Op& op)
+    {
+      static_assert(std::is_empty<Op>::value,
+                    "nonblocking reductions need stateless function objects");
+      static const Op instance(op);
+      detached = &instance;
+    }
+
+    static T apply(const T& x, const T& y)
+    {
+      if constexpr (std::is_empty<Op>::value && std::is_default_constructible<Op>::value)
+        return Op()(x, y);
+      else if constexpr (std::is_empty<Op>::value)
+        return (current ? *current : *detached)(x, y);
+      else
+        return (*current)(x, y);
+    }
+
+    // MPI combines the values of the lower ranks from the left
+    static void perform(void* invec, void* inoutvec, count_type* len,
+                        MPI_Datatype* /*unused*/)
+    {
+      const T* in = static_cast<const T*>(invec);
+      T* inout    = static_cast<T*>(inoutvec);
+      for(count_type i=0; i<*len; i++) inout[i] = apply(in[i], inout[i]);
+    }
+
+    static MPI_Op create()
+    {
+      MPI_Op op;
+      MPI_CHECK_RESULT(MPI4CPP_LARGE(MPI_Op_create),
+                      (&perform, is_commutative<Op,T>::value, &op));
+      return op;
+    }
+  };
+
+  /// @brief the @c MPI_Op of a reduction with @p op over values of
+  /// type @c T: a built-in operation chosen at compile time ...
+  template<typename Op, typename T, bool = is_mpi_op<Op,T>::value>
+  class reduction_op
+  {
+   public:
+    explicit reduction_op(const Op& /*unused*/) {}
+
+    MPI_Op get() const { return is_mpi_op<Op,T>::op(); }
+  };
+
+  /// ... or the cached user-defined operation, which sees @p op for
+  /// as long as this object lives
+  template<typename Op, typename T>
+  class reduction_op<Op,T,false>
+  {
+   public:
+    explicit reduction_op(const Op& op)
+      : m_previous(user_op<Op,T>::current)
+    {
+      user_op<Op,T>::current = &op;
+    }
+
+    ~reduction_op() { user_op<Op,T>::current = m_previous; }
+
+    reduction_op(const reduction_op&) = delete;
+    reduction_op& operator=(const reduction_op&) = delete;
+
+    MPI_Op get() const
+    {
+      return mpi_op_cache().get_or_create<Op,T>(&user_op<Op,T>::create);
+    }
+
+   private:
+    const Op* m_previous;
+  };
+
+  /// @brief the @c MPI_Op of a nonblocking reduction with @p op, which
+  /// must not depend on the lifetime of @p op
+  template<typename Op, typename T>
+  inline MPI_Op
+  nonblocking_op(const Op& op)
+  {
+    if constexpr (is_mpi_op<Op,T>::value)
+      return is_mpi_op<Op,T>::op();
+    else {
+      user_op<Op,T>::detach(op);
+      return mpi_op_cache().get_or_create<Op,T>(&user_op<Op,T>::create);
+    }
+  }
+
+
+  // We're reducing arrays of a type that has an associated MPI
+  // datatype, so we map directly to that datatype.
+  template<typename T, typename Op>
+  inline void
+  array_reduce_impl(const communicator& comm, const T* in_values, std::size_t n,
+                    T* out_values, const Op& op, int root)
+  {
+    reduction_op<Op,T> mpi_op(op);
+    MPI_Datatype type = get_mpi_datatype<T>();
+
+    // the root may reduce into its input buffer
+    bool in_place = in_values == out_values && comm.rank() == root;
+
+    for_each_chunk(n, [&](std::size_t offset, count_type count) {
+      MPI_CHECK_RESULT(MPI4CPP_LARGE(MPI_Reduce),
+                      (in_place ? MPI_IN_PLACE : in_values + offset,
+                      out_values ? out_values + offset : nullptr,
+                      count, type, mpi_op.get(), root, MPI_Comm(comm)));
+    });
+  }
+
+  template<typename T, typename Op>
+  inline void
+  array_all_reduce_impl(const communicator& comm, const T* in_values, std::size_t n,
+                        T* out_values, const Op& op)
+  {
+    reduction_op<Op,T> mpi_op(op);
+    MPI_Datatype type = get_mpi_datatype<T>();
+
+    bool in_place = in_values == out_values;
+
+    for_each_chunk(n, [&](std::size_t offset, count_type count) {
+      MPI_CHECK_RESULT(MPI4CPP_LARGE(MPI_Allreduce),
+                      (in_place ? MPI_IN_PLACE : in_values + offset,
+                      out_values + offset,
+                      count, type, mpi_op.get(), MPI_Comm(comm)));
+    });
+  }
+}
+
+template<typename T, typename Op>
+inline void
+reduce(const communicator& comm, const T& in_value, T& out_value, Op op, int root)
+{
+  // contiguous ranges are reduced element by element
+  if constexpr (detail::is_contiguous_range<T>::value)
+    detail::array_reduce_impl(comm, std::data(in_value), std::size(in_value),
+                              std::data(out_value), op, root);
+  else
+    detail::array_reduce_impl(comm, &in_value, 1, &out_value, op, root);
+}
+
+template<typename T, typename Op>
+inline void
+reduce(const communicator& comm, const T& in_value, Op op, int root)
+{
+  if constexpr (detail::is_contiguous_range<T>::value)
+    detail::array_reduce_impl(comm, std::data(in_value), std::size(in_value),
+                              static_cast<detail::range_value_t<T>*>(nullptr), op, root);
+  else
+    detail::array_reduce_impl(comm, &in_value, 1, static_cast<T*>(nullptr), op, root);
+}
+
+template<typename T, typename Op>
+inline void
+reduce(const communicator& comm, const T* in_values, std::size_t n,
+       T* out_values, Op op, int root)
+{
+  detail::array_reduce_impl(comm, in_values, n, out_values, op, root);
+}
+
+template<typename T, typename A, typename Op>
+inline void
+reduce(const communicator& comm, const std::vector<T,A>& in_values,
+       std::vector<T,A>& out_values, Op op, int root)
+{
+  if (&in_values != &out_values && comm.rank() == root)
+    out_values.resize(in_values.size());
+  T* out = comm.rank() == root ? out_values.data() : nullptr;
+  detail::array_reduce_impl(comm, in_values.data(), in_values.size(), out, op, root);
+}
+
+template<typename T, typename Op>
+inline void
+all_reduce(const communicator& comm, const T& in_value, T& out_value, Op op)
+{
+  if constexpr (detail::is_contiguous_range<T>::value)
+    detail::array_all_reduce_impl(comm, std::data(in_value), std::size(in_value),
+                                  std::data(out_value), op);
+  else
+    detail::array_all_reduce_impl(comm, &in_value, 1, &out_value, op);
+}
+
+template<typename T, typename Op>
+inline T
+all_reduce(const communicator& comm, const T& in_value, Op op)
+{
+  T out_value;
+  all_reduce(comm, in_value, out_value, op);
+  return out_value;
+}
+
+template<typename T, typename Op>
+inline void
+all_reduce(const communicator& comm, const T* in_values, std::size_t n,
+           T* out_values, Op op)
+{
+  detail::array_all_reduce_impl(comm, in_values, n, out_values, op);
+}
+
+template<typename T, typename A, typename Op>
+inline void
+all_reduce(const communicator& comm, const std::vector<T,A>& in_values,
+           std::vector<T,A>& out_values, Op op)
+{
+  if (&in_values != &out_values)
+    out_values.resize(in_values.size());
+  detail::array_all_reduce_impl(comm, in_values.data(), in_values.size(),
+                                out_values.data(), op);
+}
+
+
+//--------------------------------------------------
+// gather / gatherv
+
+namespace detail {
+  // Split a flat vector of blocks into one vector per block
+  template<typename T, typename A, typename AA>
+  inline void
+  split_blocks(const std::vector<T,A>& flat, const block_layout& layout,
+               std::vector<std::vector<T,A>,AA>& out_values)
+  {
+    out_values.resize(layout.counts.size());
+    for(std::size_t i=0; i<out_values.size(); i++) {
+      auto first = flat.begin() + layout.displs[i];
+      out_values[i].assign(first, first + layout.counts[i]);
+    }
+  }
+
+  // We're gathering arrays of a type that has an associated MPI
+  // datatype, so we map directly to that datatype.
+  template<typename T>
+  inline void
+  array_gather_impl(const communicator& comm, const T* in_values, std::size_t n,
+                    T* out_values, int root, mpl::true_ /*unused*/)
+  {
+    large_count count(get_mpi_datatype<T>(), n);
+    MPI_CHECK_RESULT(MPI4CPP_LARGE(MPI_Gather),
+                    (const_cast<T*>(in_values), count.count(), count.datatype(),
+                    out_values, count.count(), count.datatype(),
+                    root, MPI_Comm(comm)));
+  }
+
+  template<typename T>
+  inline void
+  array_all_gather_impl(const communicator& comm, const T* in_values, std::size_t n,
+                        T* out_values, mpl::true_ /*unused*/)
+  {
+    large_count count(get_mpi_datatype<T>(), n);
+    MPI_CHECK_RESULT(MPI4CPP_LARGE(MPI_Allgather),
+                    (const_cast<T*>(in_values), count.count(), count.datatype(),
+                    out_values, count.count(), count.datatype(),
+                    MPI_Comm(comm)));
+  }
+
+  // Run the layout step @p assign and agree on its outcome: without
+  // MPI-4 large counts a layout may overflow the int counts on some
+  // processes only, and then all of them throw MPI_Count_Overflow_Error
+  // instead of the others waiting forever in the following collective
+  template<typename F>
+  inline void
+  agreed_layout(const communicator& comm, F&& assign)
+  {
+#ifdef MPI4CPP_HAS_LARGE_COUNT
+    assign();
+#else
+    int fits = 1;
+    try {
+      assign();
+    } catch (const MPI_Count_Overflow_Error&) {
+      fits = 0;
+    }
+    MPI_CHECK_RESULT(MPI_Allreduce,
+                    (MPI_IN_PLACE, &fits, 1, MPI_INT, MPI_LAND, MPI_Comm(comm)));
+    if (!fits) throw MPI_Count_Overflow_Error();
+#endif
+  }
+
+  // The root learns the lengths of the contributions first and
+  // receives them all into one flat vector
+  template<typename T, typename A>
+  inline void
+  gatherv_impl(const communicator& comm, const std::vector<T,A>& in_values,
+               std::vector<T,A>* out_values, block_layout* layout, int root)
+  {
+    std::size_t n = in_values.size();
+    std::vector<std::size_t> sizes(out_values ? comm.size() : 0);
+    MPI_Datatype size_type = get_mpi_datatype<std::size_t>();
+    MPI_CHECK_RESULT(MPI_Gather,
+                    (&n, 1, size_type, sizes.data(), 1, size_type,
+                    root, MPI_Comm(comm)));
+
+    T* out = nullptr;
+    agreed_layout(comm, [&] {
+      if (out_values) {
+        out_values->resize(layout->assign(sizes.data(), sizes.size()));
+        out = out_values->data();
+      }
+    });
+
+    MPI_Datatype type = get_mpi_datatype<T>();
+    large_count count(type, n);
+    MPI_CHECK_RESULT(MPI4CPP_LARGE(MPI_Gatherv),
+                    (const_cast<T*>(in_values.data()), count.count(), count.datatype(),
+                    out,
+                    layout ? layout->counts.data() : nullptr,
+                    layout ? layout->displs.data() : nullptr,
+                    type, root, MPI_Comm(comm)));
+  }
+
+  template<typename T, typename A>
+  inline void
+  all_gatherv_impl(const communicator& comm, const std::vector<T,A>& in_values,
+                   std::vector<T,A>& out_values, block_layout& layout)
+  {
+    std::size_t n = in_values.size();
+    std::vector<std::size_t> sizes(comm.size());
+    MPI_Datatype size_type = get_mpi_datatype<std::size_t>();
+    MPI_CHECK_RESULT(MPI_Allgather,
+                    (&n, 1, size_type, sizes.data(), 1, size_type,
+                    MPI_Comm(comm)));
+
+    out_values.resize(layout.assign(sizes.data(), sizes.size()));
+
+    MPI_Datatype type = get_mpi_datatype<T>();
+    large_count count(type, n);
+    MPI_CHECK_RESULT(MPI4CPP_LARGE(MPI_Allgatherv),
+                    (const_cast<T*>(in_values.data()), count.count(), count.datatype(),
+                    out_values.data(), layout.counts.data(), layout.displs.data(),
+                    type, MPI_Comm(comm)));
+  }
+}
+
+template<typename T, typename A>
+inline void
+gather(const communicator& comm, const T& in_value,
+       std::vector<T,A>& out_values, int root)
+{
+  if (comm.rank() == root) {
+    out_values.resize(comm.size());
+    detail::array_gather_impl(comm, &in_value, 1, out_values.data(), root,
+                              is_mpi_datatype<T>());
+  } else
+    detail::array_gather_impl(comm, &in_value, 1, static_cast<T*>(nullptr), root,
+                              is_mpi_datatype<T>());
+}
+
+template<typename T>
+inline void
+gather(const communicator& comm, const T& in_value, int root)
+{
+  detail::array_gather_impl(comm, &in_value, 1, static_cast<T*>(nullptr), root,
+                            is_mpi_datatype<T>());
+}
+
+template<typename T>
+inline void
+gather(const communicator& comm, const T* in_values, std::size_t n,
+       T* out_values, int root)
+{
+  detail::array_gather_impl(comm, in_values, n, out_values, root,
+                            is_mpi_datatype<T>());
+}
+
+template<typename T, typename A>
+inline void
+gather(const communicator& comm, const T* in_values, std::size_t n,
+       std::vector<T,A>& out_values, int root)
+{
+  if (comm.rank() == root) {
+    out_values.resize(n*comm.size());
+    detail::array_gather_impl(comm, in_values, n, out_values.data(), root,
+                              is_mpi_datatype<T>());
+  } else
+    detail::array_gather_impl(comm, in_values, n, static_cast<T*>(nullptr), root,
+                              is_mpi_datatype<T>());
+}
+
+template<typename T>
+inline void
+gather(const communicator& comm, const T* in_values, std::size_t n, int root)
+{
+  detail::array_gather_impl(comm, in_values, n, static_cast<T*>(nullptr), root,
+                            is_mpi_datatype<T>());
+}
+
+template<typename T, typename A>
+inline void
+all_gather(const communicator& comm, const T& in_value,
+           std::vector<T,A>& out_values)
+{
+  out_values.resize(comm.size());
+  detail::array_all_gather_impl(comm, &in_value, 1, out_values.data(),
+                                is_mpi_datatype<T>());
+}
+
+template<typename T>
+inline void
+all_gather(const communicator& comm, const T* in_values, std::size_t n,
+           T* out_values)
+{
+  detail::array_all_gather_impl(comm, in_values, n, out_values,
+                                is_mpi_datatype<T>());
+}
+
+template<typename T, typename A>
+inline void
+all_gather(const communicator& comm, const T* in_values, std::size_t n,
+           std::vector<T,A>& out_values)
+{
+  out_values.resize(n*comm.size());
+  detail::array_all_gather_impl(comm, in_values, n, out_values.data(),
+                                is_mpi_datatype<T>());
+}
+
+template<typename T, typename A>
+inline void
+gatherv(const communicator& comm, const std::vector<T,A>& in_values,
+        std::vector<T,A>& out_values, std::vector<std::size_t>& offsets,
+        int root)
+{
+  if (comm.rank() == root) {
+    detail::block_layout layout;
+    detail::gatherv_impl(comm, in_values, &out_values, &layout, root);
+    layout.offsets(offsets);
+  } else
+    detail::gatherv_impl(comm, in_values,
+                         static_cast<std::vector<T,A>*>(nullptr), nullptr, root);
+}
+
+template<typename T, typename A, typename AA>
+inline void
+gatherv(const communicator& comm, const std::vector<T,A>& in_values,
+        std::vector<std::vector<T,A>,AA>& out_values, int root)
+{
+  if (comm.rank() == root) {
+    detail::block_layout layout;
+    std::vector<T,A> flat;
+    detail::gatherv_impl(comm, in_values, &flat, &layout, root);
+    detail::split_blocks(flat, layout, out_values);
+  } else
+    detail::gatherv_impl(comm, in_values,
+                         static_cast<std::vector<T,A>*>(nullptr), nullptr, root);
+}
+
+template<typename T, typename A>
+inline void
+gatherv(const communicator& comm, const std::vector<T,A>& in_values, int root)
+{
+  detail::gatherv_impl(comm, in_values,
+                       static_cast<std::vector<T,A>*>(nullptr), nullptr, root);
+}
+
+template<typename T, typename A>
+inline void
+all_gatherv(const communicator& comm, const std::vector<T,A>& in_values,
+            std::vector<T,A>& out_values, std::vector<std::size_t>& offsets)
+{
+  detail::block_layout layout;
+  detail::all_gatherv_impl(comm, in_values, out_values, layout);
+  layout.offsets(offsets);
+}
+
+template<typename T, typename A, typename AA>
+inline void
+all_gatherv(const communicator& comm, const std::vector<T,A>& in_values,
+            std::vector<std::vector<T,A>,AA>& out_values)
+{
+  detail::block_layout layout;
+  std::vector<T,A> flat;
+  detail::all_gatherv_impl(comm, in_values, flat, layout);
+  detail::split_blocks(flat, layout, out_values);
+}
+
+
+//--------------------------------------------------
+// scatter / scatterv
+
+namespace detail {
+  // We're scattering arrays of a type that has an associated MPI
+  // datatype, so we map directly to that datatype.
+  template<typename T>
+  inline void
+  array_scatter_impl(const communicator& comm, const T* in_values, T* out_values,
+                     std::size_t n, int root, mpl::true_ /*unused*/)
+  {
+    large_count count(get_mpi_datatype<T>(), n);
+    MPI_CHECK_RESULT(MPI4CPP_LARGE(MPI_Scatter),
+                    (const_cast<T*>(in_values), count.count(), count.datatype(),
+                    out_values, count.count(), count.datatype(),
+                    root, MPI_Comm(comm)));
+  }
+
+  // Each process learns the length of its block first; only the root
+  // has the layout of all blocks
+  template<typename T, typename A>
+  inline void
+  scatterv_impl(const communicator& comm, const T* in_values,
+                const std::size_t* sizes, std::vector<T,A>& out_values, int root)
+  {
+    std::size_t n = 0;
+    MPI_Datatype size_type = get_mpi_datatype<std::size_t>();
+    MPI_CHECK_RESULT(MPI_Scatter,
+                    (const_cast<std::size_t*>(sizes), 1, size_type,
+                    &n, 1, size_type, root, MPI_Comm(comm)));
+
+    block_layout layout;
+    agreed_layout(comm, [&] {
+      if (sizes) layout.assign(sizes, comm.size());
+    });
+
+    out_values.resize(n);
+
+    MPI_Datatype type = get_mpi_datatype<T>();
+    large_count count(type, n);
+    MPI_CHECK_RESULT(MPI4CPP_LARGE(MPI_Scatterv),
+                    (const_cast<T*>(in_values),
+                    sizes ? layout.counts.data() : nullptr,
+                    sizes ? layout.displs.data() : nullptr, type,
+                    out_values.data(), count.count(), count.datatype(),
+                    root, MPI_Comm(comm)));
+  }
+}
+
+template<typename T, typename A>
+inline void
+scatter(const communicator& comm, const std::vector<T,A>& in_values,
+        T& out_value, int root)
+{
+  detail::array_scatter_impl(comm, in_values.data(), &out_value, 1, root,
+                             is_mpi_datatype<T>());
+}
+
+template<typename T>
+inline void
+scatter(const communicator& comm, T& out_value, int root)
+{
+  detail::array_scatter_impl(comm, static_cast<const T*>(nullptr), &out_value, 1,
+                             root, is_mpi_datatype<T>());
+}
+
+template<typename T>
+inline void
+scatter(const communicator& comm, const T* in_values, T* out_values,
+        std::size_t n, int root)
+{
+  detail::array_scatter_impl(comm, in_values, out_values, n, root,
+                             is_mpi_datatype<T>());
+}
+
+template<typename T>
+inline void
+scatter(const communicator& comm, T* out_values, std::size_t n, int root)
+{
+  detail::array_scatter_impl(comm, static_cast<const T*>(nullptr), out_values, n,
+                             root, is_mpi_datatype<T>());
+}
+
+template<typename T, typename A>
+inline void
+scatterv(const communicator& comm, const std::vector<T,A>& in_values,
+         const std::vector<std::size_t>& sizes,
+         std::vector<T,A>& out_values, int root)
+{
+  if (comm.rank() == root) {
+    assert(int(sizes.size()) == comm.size());
+    detail::scatterv_impl(comm, in_values.data(), sizes.data(), out_values, root);
+  } else
+    detail::scatterv_impl(comm, static_cast<const T*>(nullptr), nullptr,
+                          out_values, root);
+}
+
+template<typename T, typename A, typename AA>
+inline void
+scatterv(const communicator& comm,
+         const std::vector<std::vector<T,A>,AA>& in_values,
+         std::vector<T,A>& out_values, int root)
+{
+  if (comm.rank() == root) {
+    assert(int(in_values.size()) == comm.size());
+    std::vector<std::size_t> sizes;
+    std::vector<T,A> flat;
+    for(auto& block : in_values) {
+      sizes.push_back(block.size());
+      flat.insert(flat.end(), block.begin(), block.end());
+    }
+    detail::scatterv_impl(comm, flat.data(), sizes.data(), out_values, root);
+  } else
+    detail::scatterv_impl(comm, static_cast<const T*>(nullptr), nullptr,
+                          out_values, root);
+}
+
+template<typename T, typename A>
+inline void
+scatterv(const communicator& comm, std::vector<T,A>& out_values, int root)
+{
+  detail::scatterv_impl(comm, static_cast<const T*>(nullptr), nullptr,
+                        out_values, root);
+}
+
+
+//--------------------------------------------------
+// all_to_all / all_to_allv / all_to_allw
+
+namespace detail {
+  // We're exchanging arrays of a type that has an associated MPI
+  // datatype, so we map directly to that datatype.
+  template<typename T>
+  inline void
+  array_all_to_all_impl(const communicator& comm, const T* in_values, std::size_t n,
+                        T* out_values, mpl::true_ /*unused*/)
+  {
+    large_count count(get_mpi_datatype<T>(), n);
+    MPI_CHECK_RESULT(MPI4CPP_LARGE(MPI_Alltoall),
+                    (const_cast<T*>(in_values), count.count(), count.datatype(),
+                    out_values, count.count(), count.datatype(),
+                    MPI_Comm(comm)));
+  }
+
+  // The block sizes are exchanged first so that every process can lay
+  // out its receive buffer; all scratch lives in the buffer object
+  template<typename T, typename A>
+  inline void
+  all_to_allv_impl(const communicator& comm, const T* in_values,
+                   const std::size_t* sizes, all_to_allv_buffer<T,A>& out)
+  {
+    std::size_t p = comm.size();
+    out.m_recv_sizes.resize(p);
+
+    MPI_Datatype size_type = get_mpi_datatype<std::size_t>();
+    MPI_CHECK_RESULT(MPI_Alltoall,
+                    (const_cast<std::size_t*>(sizes), 1, size_type,
+                    out.m_recv_sizes.data(), 1, size_type, MPI_Comm(comm)));
+
+    agreed_layout(comm, [&] {
+      out.m_send_layout.assign(sizes, p);
+      out.values.resize(out.m_recv_layout.assign(out.m_recv_sizes.data(), p));
+    });
+    out.m_recv_layout.offsets(out.offsets);
+
+    MPI_Datatype type = get_mpi_datatype<T>();
+    MPI_CHECK_RESULT(MPI4CPP_LARGE(MPI_Alltoallv),
+                    (const_cast<T*>(in_values),
+                    out.m_send_layout.counts.data(), out.m_send_layout.displs.data(),
+                    type, out.values.data(),
+                    out.m_recv_layout.counts.data(), out.m_recv_layout.displs.data(),
+                    type, MPI_Comm(comm)));
+  }
+
+  // Count, datatype and byte displacement of every block of an
+  // all_to_allw, relative to the lowest address of the blocks. The
+  // displacements are displ_type, or MPI_Aint for the neighbourhood
+  // variant.
+  template<typename V, typename D>
+  inline void*
+  alltoallw_blocks(const std::vector<V>& blocks, std::vector<count_type>& counts,
+                   std::vector<D>& displs, std::vector<MPI_Datatype>& types)
+  {
+    std::size_t n = blocks.size();
+    std::vector<MPI_Aint> addresses(n);
+    std::vector<void*> bases(n);
+    counts.resize(n);
+    displs.resize(n);
+    types.resize(n);
+
+    for(std::size_t i=0; i<n; i++) {
+      const V& block = blocks[i];
+      if constexpr (is_datatype_view<V>::value) {
+        bases[i]  = const_cast<void*>(static_cast<const void*>(block.base()));
+        counts[i] = 1;
+        types[i]  = block.datatype();
+      } else {
+        static_assert(is_contiguous_range<V>::value,
+                      "all_to_allw blocks must be datatype views or contiguous ranges");
+        bases[i]  = const_cast<void*>(static_cast<const void*>(std::data(block)));
+        counts[i] = checked_count(std::size(block));
+        types[i]  = get_mpi_datatype<range_value_t<V> >();
+      }
+      MPI_CHECK_RESULT(MPI_Get_address, (bases[i], &addresses[i]));
+    }
+
+    // empty blocks (e.g. an empty vector with a null data()) transfer
+    // nothing, so they neither choose the base nor get a displacement
+    std::size_t lowest = n;
+    for(std::size_t i=0; i<n; i++)
+      if (counts[i] != 0 &&
+          (lowest == n || MPI_Aint_diff(addresses[i], addresses[lowest]) < 0)) lowest = i;
+    if (lowest == n) lowest = 0;
+
+    for(std::size_t i=0; i<n; i++) {
+      if (counts[i] == 0) {
+        displs[i] = 0;
+        continue;
+      }
+      MPI_Aint displ = MPI_Aint_diff(addresses[i], addresses[lowest]);
+      // displacements are ints without MPI-4 large counts
+      if constexpr (sizeof(D) < sizeof(MPI_Aint))
+        if (displ > static_cast<MPI_Aint>(MPI4CPP_MAX_COUNT)) throw MPI_Count_Overflow_Error();
+      displs[i] = static_cast<D>(displ);
+    }
+    return n ? bases[lowest] : nullptr;
+  }
+}
+
+template<typename T, typename A>
+inline void
+all_to_all(const communicator& comm, const std::vector<T,A>& in_values,
+           std::vector<T,A>& out_values)
+{
+  assert(in_values.size() == std::size_t(comm.size()));
+  out_values.resize(comm.size());
+  detail::array_all_to_all_impl(comm, in_values.data(), 1, out_values.data(),
+                                is_mpi_datatype<T>());
+}
+
+template<typename T>
+inline void
+all_to_all(const communicator& comm, const T* in_values, std::size_t n,
+           T* out_values)
+{
+  detail::array_all_to_all_impl(comm, in_values, n, out_values,
+                                is_mpi_datatype<T>());
+}
+
+template<typename T, typename A, typename AA>
+inline void
+all_to_allv(const communicator& comm,
+            const std::vector<std::vector<T,A>,AA>& buckets,
+            all_to_allv_buffer<T,A>& out)
+{
+  std::size_t p = comm.size();
+  assert(buckets.size() == p);
+
+  out.m_send_sizes.resize(p);
+  std::size_t total = 0;
+  for(std::size_t r=0; r<p; r++) {
+    out.m_send_sizes[r] = buckets[r].size();
+    total += buckets[r].size();
+  }
+
+  out.m_send.resize(total);
+  auto it = out.m_send.begin();
+  for(auto& bucket : buckets) it = std::copy(bucket.begin(), bucket.end(), it);
+
+  detail::all_to_allv_impl(comm, out.m_send.data(), out.m_send_sizes.data(), out);
+}
+
+template<typename T, typename A>
+inline void
+all_to_allv(const communicator& comm, const std::vector<T,A>& in_values,
+            const std::vector<std::size_t>& sizes,
+            all_to_allv_buffer<T,A>& out)
+{
+  assert(sizes.size() == std::size_t(comm.size()));
+  detail::all_to_allv_impl(comm, in_values.data(), sizes.data(), out);
+}
+
+template<typename S, typename R>
+inline void
+all_to_allw(const communicator& comm, const std::vector<S>& in_blocks,
+            const std::vector<R>& out_blocks)
+{
+  assert(in_blocks.size() == std::size_t(comm.size()));
+  assert(out_blocks.size() == std::size_t(comm.size()));
+
+  std::vector<detail::count_type> send_counts, recv_counts;
+  std::vector<detail::displ_type> send_displs, recv_displs;
+  std::vector<MPI_Datatype> send_types, recv_types;
+  void* send_base = detail::alltoallw_blocks(in_blocks, send_counts, send_displs, send_types);
+  void* recv_base = detail::alltoallw_blocks(out_blocks, recv_counts, recv_displs, recv_types);
+
+  MPI_CHECK_RESULT(MPI4CPP_LARGE(MPI_Alltoallw),
+                  (send_base, send_counts.data(), send_displs.data(), send_types.data(),
+                  recv_base, recv_counts.data(), recv_displs.data(), recv_types.data(),
+                  MPI_Comm(comm)));
+}
+
+
+//--------------------------------------------------
+// nonblocking collectives
+
+namespace detail {
+  template<typename T>
+  inline request
+  array_ibroadcast_impl(const communicator& comm, T* values, std::size_t n,
+                        int root, mpl::true_ /*unused*/)
+  {
+    request req;
+    large_count count(get_mpi_datatype<T>(), n);
+    MPI_CHECK_RESULT(MPI4CPP_LARGE(MPI_Ibcast),
+                    (values, count.count(), count.datatype(),
+                    root, MPI_Comm(comm), req.trivial()));
+    return req;
+  }
+
+  inline request
+  datatype_ibroadcast_impl(const communicator& comm, void* base,
+                           MPI_Datatype type, int root)
+  {
+    request req;
+    MPI_CHECK_RESULT(MPI_Ibcast, (base, 1, type, root, MPI_Comm(comm), req.trivial()));
+    return req;
+  }
+
+  /// @brief state of the broadcast of a resizable container: the size
+  /// is broadcast first, then the elements into the resized container
+  template<class Container>
+  struct dynamic_ibroadcast_data : two_step_collective
+  {
+    using value_type = typename Container::value_type;
+
+    dynamic_ibroadcast_data(const communicator& comm, Container& values, int root)
+      : comm(comm), values(values), size(values.size()), root(root)
+    { }
+
+    void post_sizes(MPI_Request* req)
+    {
+      MPI_CHECK_RESULT(MPI_Ibcast,
+                      (&size, 1, get_mpi_datatype<std::size_t>(),
+                      root, MPI_Comm(comm), req));
+    }
+
+    void post_payload(MPI_Comm payload_comm, MPI_Request* req) override
+    {
+      values.resize(size);
+      large_count count(get_mpi_datatype<value_type>(), size);
+      MPI_CHECK_RESULT(MPI4CPP_LARGE(MPI_Ibcast),
+                      (values.data(), count.count(), count.datatype(),
+                      root, payload_comm, req));
+    }
+
+    communicator comm;
+    Container& values;
+    std::size_t size;
+    int root;
+  };
+
+  template<typename T, typename Op>
+  inline request
+  array_ireduce_impl(const communicator& comm, const T* in_values, std::size_t n,
+                     T* out_values, const Op& op, int root)
+  {
+    request req;
+    bool in_place = in_values == out_values && comm.rank() == root;
+    MPI_CHECK_RESULT(MPI4CPP_LARGE(MPI_Ireduce),
+                    (in_place ? MPI_IN_PLACE : in_values, out_values,
+                    checked_count(n), get_mpi_datatype<T>(),
+                    nonblocking_op<Op,T>(op), root, MPI_Comm(comm), req.trivial()));
+    return req;
+  }
+
+  template<typename T, typename Op>
+  inline request
+  array_iall_reduce_impl(const communicator& comm, const T* in_values, std::size_t n,
+                         T* out_values, const Op& op)
+  {
+    request req;
+    bool in_place = in_values == out_values;
+    MPI_CHECK_RESULT(MPI4CPP_LARGE(MPI_Iallreduce),
+                    (in_place ? MPI_IN_PLACE : in_values, out_values,
+                    checked_count(n), get_mpi_datatype<T>(),
+                    nonblocking_op<Op,T>(op), MPI_Comm(comm), req.trivial()));
+    return req;
+  }
+
+  template<typename T>
+  inline request
+  array_iall_gather_impl(const communicator& comm, const T* in_values, std::size_t n,
+                         T* out_values, mpl::true_ /*unused*/)
+  {
+    request req;
+    large_count count(get_mpi_datatype<T>(), n);
+    MPI_CHECK_RESULT(MPI4CPP_LARGE(MPI_Iallgather),
+                    (const_cast<T*>(in_values), count.count(), count.datatype(),
+                    out_values, count.count(), count.datatype(),
+                    MPI_Comm(comm), req.trivial()));
+    return req;
+  }
+
+  template<typename T>
+  inline request
+  array_iall_to_all_impl(const communicator& comm, const T* in_values, std::size_t n,
+                         T* out_values, mpl::true_ /*unused*/)
+  {
+    request req;
+    large_count count(get_mpi_datatype<T>(), n);
+    MPI_CHECK_RESULT(MPI4CPP_LARGE(MPI_Ialltoall),
+                    (const_cast<T*>(in_values), count.count(), count.datatype(),
+                    out_values, count.count(), count.datatype(),
+                    MPI_Comm(comm), req.trivial()));
+    return req;
+  }
+
+  /// @brief state of a nonblocking all_to_allv: the send sizes are in
+  /// @c out.m_send_sizes; the receive sizes arrive in
+  /// @c out.m_recv_sizes before the payload is posted
+  template<typename T, typename A>
+  struct iall_to_allv_data : two_step_collective
+  {
+    iall_to_allv_data(const communicator& comm, const T* in_values,
+                      all_to_allv_buffer<T,A>& out)
+      : comm(comm), in_values(in_values), out(out)
+    { }
+
+    void post_sizes(MPI_Request* req)
+    {
+      std::size_t p = comm.size();
+      out.m_recv_sizes.resize(p);
+      MPI_Datatype size_type = get_mpi_datatype<std::size_t>();
+      MPI_CHECK_RESULT(MPI_Ialltoall,
+                      (out.m_send_sizes.data(), 1, size_type,
+                      out.m_recv_sizes.data(), 1, size_type, MPI_Comm(comm), req));
+    }
+
+    void post_payload(MPI_Comm payload_comm, MPI_Request* req) override
+    {
+      std::size_t p = comm.size();
+      out.m_send_layout.assign(out.m_send_sizes.data(), p);
+      out.values.resize(out.m_recv_layout.assign(out.m_recv_sizes.data(), p));
+      out.m_recv_layout.offsets(out.offsets);
+
+      MPI_Datatype type = get_mpi_datatype<T>();
+      MPI_CHECK_RESULT(MPI4CPP_LARGE(MPI_Ialltoallv),
+                      (const_cast<T*>(in_values),
+                      out.m_send_layout.counts.data(), out.m_send_layout.displs.data(),
+                      type, out.values.data(),
+                      out.m_recv_layout.counts.data(), out.m_recv_layout.displs.data(),
+                      type, payload_comm, req));
+    }
+
+    communicator comm;
+    const T* in_values;
+    all_to_allv_buffer<T,A>& out;
+  };
+}
+
+inline request
+ibarrier(const communicator& comm)
+{
+  request req;
+  MPI_CHECK_RESULT(MPI_Ibarrier, (MPI_Comm(comm), req.trivial()));
+  return req;
+}
+
+template<typename T>
+inline request
+ibroadcast(const communicator& comm, T& value, int root)
+{
+  if constexpr (detail::is_contiguous_range<T>::value)
+    return detail::array_ibroadcast_impl(comm, std::data(value), std::size(value), root,
+                                         is_mpi_datatype<detail::range_value_t<T> >());
+  else if constexpr (detail::is_datatype_view<T>::value)
+    return detail::datatype_ibroadcast_impl(comm, value.base(), value.datatype(), root);
+  else
+    return detail::array_ibroadcast_impl(comm, &value, 1, root, is_mpi_datatype<T>());
+}
+
+template<typename T>
+inline request
+ibroadcast(const communicator& comm, T* values, std::size_t n, int root)
+{
+  return detail::array_ibroadcast_impl(comm, values, n, root, is_mpi_datatype<T>());
+}
+
+template<typename T, typename A>
+inline request
+ibroadcast(const communicator& comm, std::vector<T,A>& values, int root)
+{
+  using data_t = detail::dynamic_ibroadcast_data<std::vector<T,A> >;
+  return request(std::make_shared<data_t>(comm, values, root));
+}
+
+template<typename C, class Tr, class A>
+inline request
+ibroadcast(const communicator& comm, std::basic_string<C,Tr,A>& values, int root)
+{
+  using data_t = detail::dynamic_ibroadcast_data<std::basic_string<C,Tr,A> >;
+  return request(std::make_shared<data_t>(comm, values, root));
+}
+
+template<typename T, typename Op>
+inline request
+ireduce(const communicator& comm, const T& in_value, T& out_value, Op op, int root)
+{
+  if constexpr (detail::is_contiguous_range<T>::value)
+    return detail::array_ireduce_impl(comm, std::data(in_value), std::size(in_value),
+                                      std::data(out_value), op, root);
+  else
+    return detail::array_ireduce_impl(comm, &in_value, 1, &out_value, op, root);
+}
+
+template<typename T, typename Op>
+inline request
+ireduce(const communicator& comm, const T* in_values, std::size_t n,
+        T* out_values, Op op, int root)
+{
+  return detail::array_ireduce_impl(comm, in_values, n, out_values, op, root);
+}
+
+template<typename T, typename A, typename Op>
+inline request
+ireduce(const communicator& comm, const std::vector<T,A>& in_values,
+        std::vector<T,A>& out_values, Op op, int root)
+{
+  if (comm.rank() == root) out_values.resize(in_values.size());
+  T* out = comm.rank() == root ? out_values.data() : nullptr;
+  return detail::array_ireduce_impl(comm, in_values.data(), in_values.size(), out,
+                                    op, root);
+}
+
+template<typename T, typename Op>
+inline request
+iall_reduce(const communicator& comm, const T& in_value, T& out_value, Op op)
+{
+  if constexpr (detail::is_contiguous_range<T>::value)
+    return detail::array_iall_reduce_impl(comm, std::data(in_value), std::size(in_value),
+                                          std::data(out_value), op);
+  else
+    return detail::array_iall_reduce_impl(comm, &in_value, 1, &out_value, op);
+}
+
+template<typename T, typename Op>
+inline request
+iall_reduce(const communicator& comm, const T* in_values, std::size_t n,
+            T* out_values, Op op)
+{
+  return detail::array_iall_reduce_impl(comm, in_values, n, out_values, op);
+}
+
+template<typename T, typename A, typename Op>
+inline request
+iall_reduce(const communicator& comm, const std::vector<T,A>& in_values,
+            std::vector<T,A>& out_values, Op op)
+{
+  out_values.resize(in_values.size());
+  return detail::array_iall_reduce_impl(comm, in_values.data(), in_values.size(),
+                                        out_values.data(), op);
+}
+
+template<typename T, typename A>
+inline request
+iall_gather(const communicator& comm, const T& in_value,
+            std::vector<T,A>& out_values)
+{
+  out_values.resize(comm.size());
+  return detail::array_iall_gather_impl(comm, &in_value, 1, out_values.data(),
+                                        is_mpi_datatype<T>());
+}
+
+template<typename T>
+inline request
+iall_gather(const communicator& comm, const T* in_values, std::size_t n,
+            T* out_values)
+{
+  return detail::array_iall_gather_impl(comm, in_values, n, out_values,
+                                        is_mpi_datatype<T>());
+}
+
+template<typename T, typename A>
+inline request
+iall_to_all(const communicator& comm, const std::vector<T,A>& in_values,
+            std::vector<T,A>& out_values)
+{
+  assert(in_values.size() == std::size_t(comm.size()));
+  out_values.resize(comm.size());
+  return detail::array_iall_to_all_impl(comm, in_values.data(), 1, out_values.data(),
+                                        is_mpi_datatype<T>());
+}
+
+template<typename T>
+inline request
+iall_to_all(const communicator& comm, const T* in_values, std::size_t n,
+            T* out_values)
+{
+  return detail::array_iall_to_all_impl(comm, in_values, n, out_values,
+                                        is_mpi_datatype<T>());
+}
+
+template<typename T, typename A, typename AA>
+inline request
+iall_to_allv(const communicator& comm,
+             const std::vector<std::vector<T,A>,AA>& buckets,
+             all_to_allv_buffer<T,A>& out)
+{
+  std::size_t p = comm.size();
+  assert(buckets.size() == p);
+
+  out.m_send_sizes.resize(p);
+  std::size_t total = 0;
+  for(std::size_t r=0; r<p; r++) {
+    out.m_send_sizes[r] = buckets[r].size();
+    total += buckets[r].size();
+  }
+
+  out.m_send.resize(total);
+  auto it = out.m_send.begin();
+  for(auto& bucket : buckets) it = std::copy(bucket.begin(), bucket.end(), it);
+
+  using data_t = detail::iall_to_allv_data<T,A>;
+  return request(std::make_shared<data_t>(comm, out.m_send.data(), out));
+}
+
+template<typename T, typename A>
+inline request
+iall_to_allv(const communicator& comm, const std::vector<T,A>& in_values,
+             const std::vector<std::size_t>& sizes,
+             all_to_allv_buffer<T,A>& out)
+{
+  assert(sizes.size() == std::size_t(comm.size()));
+  out.m_send_sizes.assign(sizes.begin(), sizes.end());
+
+  using data_t = detail::iall_to_allv_data<T,A>;
+  return request(std::make_shared<data_t>(comm, in_values.data(), out));
+}
+
+
+//--------------------------------------------------
+// persistent collectives
+
+namespace detail {
+  /// @brief counts and displacements of a persistent all_to_allv,
+  /// copied out of its @c all_to_allv_buffer since MPI reads them on
+  /// every start
+  struct persistent_alltoallv_layout
+  {
+    persistent_alltoallv_layout(const block_layout& send, const block_layout& recv)
+      : send(send), recv(recv)
+    { }
+
+    block_layout send, recv;
+  };
+
+  inline persistent_request
+  datatype_broadcast_init_impl(const communicator& comm, void* base,
+                               count_type count, MPI_Datatype type, int root)
+  {
+#ifdef MPI4CPP_HAS_PERSISTENT_COLLECTIVES
+    MPI_Request req;
+    MPI_CHECK_RESULT(MPI4CPP_LARGE(MPI_Bcast_init),
+                    (base, count, type, root, MPI_Comm(comm), MPI_INFO_NULL, &req));
+    return persistent_request(req);
+#else
+    return persistent_request([=](MPI_Request* req) {
+      MPI_CHECK_RESULT(MPI_Ibcast, (base, count, type, root, MPI_Comm(comm), req));
+    });
+#endif
+  }
+
+  template<typename T>
+  inline persistent_request
+  array_broadcast_init_impl(const communicator& comm, T* values, std::size_t n,
+                            int root, mpl::true_ /*unused*/)
+  {
+    return datatype_broadcast_init_impl(comm, values, checked_count(n),
+                                        get_mpi_datatype<T>(), root);
+  }
+
+  template<typename T, typename Op>
+  inline persistent_request
+  array_all_reduce_init_impl(const communicator& comm, const T* in_values,
+                             std::size_t n, T* out_values, const Op& op)
+  {
+    const void* in       = in_values == out_values ? MPI_IN_PLACE : in_values;
+    count_type count     = checked_count(n);
+    MPI_Datatype type    = get_mpi_datatype<T>();
+    MPI_Op mpi_op        = nonblocking_op<Op,T>(op);
+
+#ifdef MPI4CPP_HAS_PERSISTENT_COLLECTIVES
+    MPI_Request req;
+    MPI_CHECK_RESULT(MPI4CPP_LARGE(MPI_Allreduce_init),
+                    (in, out_values, count, type, mpi_op,
+                    MPI_Comm(comm), MPI_INFO_NULL, &req));
+    return persistent_request(req);
+#else
+    return persistent_request([=](MPI_Request* req) {
+      MPI_CHECK_RESULT(MPI_Iallreduce,
+                      (in, out_values, count, type, mpi_op, MPI_Comm(comm), req));
+    });
+#endif
+  }
+}
+
+inline persistent_request
+barrier_init(const communicator& comm)
+{
+#ifdef MPI4CPP_HAS_PERSISTENT_COLLECTIVES
+  MPI_Request req;
+  MPI_CHECK_RESULT(MPI_Barrier_init, (MPI_Comm(comm), MPI_INFO_NULL, &req));
+  return persistent_request(req);
+#else
+  return persistent_request([=](MPI_Request* req) {
+    MPI_CHECK_RESULT(MPI_Ibarrier, (MPI_Comm(comm), req));
+  });
+#endif
+}
+
+template<typename T>
+inline persistent_request
+broadcast_init(const communicator& comm, T& value, int root)
+{
+  if constexpr (detail::is_contiguous_range<T>::value)
+    return detail::array_broadcast_init_impl(comm, std::data(value), std::size(value), root,
+                                             is_mpi_datatype<detail::range_value_t<T> >());
+  else if constexpr (detail::is_datatype_view<T>::value)
+    return detail::datatype_broadcast_init_impl(comm, value.base(), 1, value.datatype(), root);
+  else
+    return detail::array_broadcast_init_impl(comm, &value, 1, root, is_mpi_datatype<T>());
+}
+
+template<typename T>
+inline persistent_request
+broadcast_init(const communicator& comm, T* values, std::size_t n, int root)
+{
+  return detail::array_broadcast_init_impl(comm, values, n, root, is_mpi_datatype<T>());
+}
+
+template<typename T, typename Op>
+inline persistent_request
+all_reduce_init(const communicator& comm, const T& in_value, T& out_value, Op op)
+{
+  if constexpr (detail::is_contiguous_range<T>::value)
+    return detail::array_all_reduce_init_impl(comm, std::data(in_value), std::size(in_value),
+                                              std::data(out_value), op);
+  else
+    return detail::array_all_reduce_init_impl(comm, &in_value, 1, &out_value, op);
+}
+
+template<typename T, typename Op>
+inline persistent_request
+all_reduce_init(const communicator& comm, const T* in_values, std::size_t n,
+                T* out_values, Op op)
+{
+  return detail::array_all_reduce_init_impl(comm, in_values, n, out_values, op);
+}
+
+template<typename T, typename A>
+inline persistent_request
+all_to_allv_init(const communicator& comm, const std::vector<T,A>& in_values,
+                 const std::vector<std::size_t>& sizes,
+                 all_to_allv_buffer<T,A>& out)
+{
+  std::size_t p = comm.size();
+  assert(sizes.size() == p);
+
+  // the layout is fixed from here on
+  out.m_send_sizes.assign(sizes.begin(), sizes.end());
+  out.m_recv_sizes.resize(p);
+  MPI_Datatype size_type = get_mpi_datatype<std::size_t>();
+  MPI_CHECK_RESULT(MPI_Alltoall,
+                  (out.m_send_sizes.data(), 1, size_type,
+                  out.m_recv_sizes.data(), 1, size_type, MPI_Comm(comm)));
+
+  detail::agreed_layout(comm, [&] {
+    out.m_send_layout.assign(out.m_send_sizes.data(), p);
+    out.values.resize(out.m_recv_layout.assign(out.m_recv_sizes.data(), p));
+  });
+  out.m_recv_layout.offsets(out.offsets);
+
+  auto layout = std::make_shared<detail::persistent_alltoallv_layout>(
+                   out.m_send_layout, out.m_recv_layout);
+  T* in                    = const_cast<T*>(in_values.data());
+  T* recv                  = out.values.data();
+  MPI_Datatype type        = get_mpi_datatype<T>();
+
+#ifdef MPI4CPP_HAS_PERSISTENT_COLLECTIVES
+  MPI_Request req;
+  MPI_CHECK_RESULT(MPI4CPP_LARGE(MPI_Alltoallv_init),
+                  (in, layout->send.counts.data(), layout->send.displs.data(), type,
+                  recv, layout->recv.counts.data(), layout->recv.displs.data(), type,
+                  MPI_Comm(comm), MPI_INFO_NULL, &req));
+  persistent_request preq(req);
+  preq.set_data(layout);
+  return preq;
+#else
+  return persistent_request([=](MPI_Request* req) {
+    MPI_CHECK_RESULT(MPI_Ialltoallv,
+                    (in, layout->send.counts.data(), layout->send.displs.data(), type,
+                    recv, layout->recv.counts.data(), layout->recv.displs.data(), type,
+                    MPI_Comm(comm), req));
+  });
+#endif
+}
+
+
+} } // ns mpi4cpp::mpi
@@ -3,17 +3,25 @@
 
 #pragma once
 
-//#include <optional>
-
+#include <optional>
+#include <array>
 #include <vector>
 #include <iterator>
 #include <memory>
+#include <string>
+#include <type_traits>
 
 #include "detail/mpl.h"
+#include "detail/large_count.h"
+#include "detail/contiguous_range.h"
+#include "detail/comm_state.h"
 #include "exception.h"
 #include "status.h"
 #include "datatype.h"
 #include "request.h"
+#include "message.h"
+#include "persistent_request.h"
+#include "subarray.h"
 
 
 
@@ -62,7 +70,7 @@ const int any_tag = MPI_ANY_TAG;
  *   when the communicator is managed by the user or MPI library
  *   (e.g., MPI_COMM_WORLD).
  */
-//enum comm_create_kind { comm_duplicate, comm_take_ownership, comm_attach };
+enum comm_create_kind { comm_duplicate, comm_take_ownership, comm_attach };
 
 
 class communicator
@@ -78,7 +86,17 @@ class communicator
    */
   communicator();
 
-  //communicator(const MPI_Comm& comm, comm_create_kind kind);
+  /**
+   * Build a new communicator based on the MPI communicator @p comm.
+   *
+   * @p comm may be any valid MPI communicator. If @p comm is
+   * MPI_COMM_NULL, an empty communicator (that cannot be used for
+   * communication) is created and the @p kind parameter is ignored.
+   * Otherwise, the @p kind parameter determines how the communicator
+   * will be related to @p comm; see @c comm_create_kind.
+   */
+  communicator(const MPI_Comm& comm, comm_create_kind kind);
+
   //communicator(const communicator& comm, const boost::mpi::group& subgroup);
 
 
@@ -86,21 +104,54 @@ class communicator
    * @brief Determine the rank of the executing process in a
    * communicator.
    *
-   * This routine is equivalent to @c MPI_Comm_rank.
+   * This routine is equivalent to @c MPI_Comm_rank, which is called
+   * only once per MPI communicator; afterwards the rank is read from
+   * the state shared by all communicators referring to it.
    *
    *   @returns The rank of the process in the communicator, which
    *   will be a value in [0, size())
+   *
+   *   @throws MPI_Invalid_Comm_Error if the communicator is not valid
+   *   for communication; the same holds for @c size() and the node
+   *   facts.
    */
-  int rank() const;
+  int rank() const { return state().rank(); }
 
   /**
    * @brief Determine the number of processes in a communicator.
    *
-   * This routine is equivalent to @c MPI_Comm_size.
+   * This routine is equivalent to @c MPI_Comm_size and cached like
+   * @c rank().
    *
    *   @returns The number of processes in the communicator.
    */
-  int size() const;
+  int size() const { return state().size(); }
+
+  /**
+   * @brief Determine the rank of the executing process among the
+   * processes of the communicator that share its node.
+   *
+   * The node facts are computed with @c MPI_Comm_split_type once per
+   * MPI communicator: when it is created by the environment or by a
+   * collective operation such as @c dup or @c split, or otherwise,
+   * for adopted @c MPI_Comm handles, on the first call of
+   * @c node_rank, @c node_size or @c single_node, which then must be
+   * made by all processes.
+   */
+  int node_rank() const { return state().node().rank; }
+
+  /**
+   * @brief Determine the number of processes of the communicator on
+   * the node of the executing process; see @c node_rank.
+   */
+  int node_size() const { return state().node().size; }
+
+  /**
+   * @brief Do all processes of the communicator share a node, i.e.
+   * can all communication go through shared memory? See
+   * @c node_rank.
+   */
+  bool single_node() const { return state().node().single_node; }
 
   /** @brief Determine if this communicator is valid for
    * communication.
@@ -141,6 +192,61 @@ class communicator
   void abort(int errcode) const;
 
 
+  //--------------------------------------------------
+  // Communicator creation
+
+  /**
+   * @brief Duplicate the communicator, equivalent to @c MPI_Comm_dup.
+   *
+   * The duplicate has the same processes but a separate communication
+   * context: messages and collectives on it never match those on this
+   * communicator. Give each library component its own duplicate, so
+   * that their tags cannot collide. This is a collective operation.
+   */
+  communicator dup() const;
+
+  /**
+   * @brief Split the communicator into disjoint sub-communicators,
+   * equivalent to @c MPI_Comm_split.
+   *
+   * All processes that pass the same @p color end up in the same new
+   * communicator, ranked by @p key (ties are broken by their rank in
+   * this communicator). Processes passing @c MPI_UNDEFINED as @p color
+   * get an invalid communicator. This is a collective operation.
+   */
+  communicator split(int color, int key) const;
+
+  /**
+   * @brief Split the communicator by @p color, keeping the relative
+   * order of the ranks.
+   */
+  communicator split(int color) const;
+
+  /**
+   * @brief Split the communicator by a type of resource, equivalent to
+   * @c MPI_Comm_split_type.
+   *
+   * With @c MPI_COMM_TYPE_SHARED (see @c split_shared) the processes
+   * that can share memory, i.e. those on the same node, form one
+   * communicator. MPI libraries may provide finer types, e.g.
+   * @c OMPI_COMM_TYPE_SOCKET for the processes on the same socket with
+   * Open MPI, which allow building per-socket communicators for
+   * hierarchical algorithms.
+   *
+   * @param type The split type.
+   *
+   * @param key Orders the processes in the new communicator like for
+   * @c split; by default they keep their relative order.
+   */
+  communicator split_type(int type, std::optional<int> key = std::nullopt) const;
+
+  /**
+   * @brief Split the communicator into one communicator per
+   * shared-memory node.
+   */
+  communicator split_shared() const;
+
+
   //--------------------------------------------------
   // Point-to-point communication
 
@@ -229,11 +335,25 @@ class communicator
    * 
    *  Std::vectors of MPI data type
    *  are considered variable size, e.g. their number of elements is 
-   *  unknown and must be transmitted (although the serialization process
-   *  is skipped). You can use the array specialized versions of 
-   *  communication methods is both sender and receiver know the vector 
-   *  size.
+   *  unknown to the receiver (although the serialization process
+   *  is skipped). They are sent as a single message; the receiver 
+   *  matches it with @c MPI_Mprobe, sizes the vector from the message 
+   *  and receives it with @c MPI_Mrecv. You can use the array specialized 
+   *  versions of communication methods is both sender and receiver know 
+   *  the vector size.
    *  
+   *  Contiguous ranges of MPI data types, i.e., types for which
+   *  @c std::data() and @c std::size() give a pointer to the elements 
+   *  and their number (C arrays, @c std::array, @c std::span, 
+   *  @c std::basic_string(_view) or user containers with @c data() and 
+   *  @c size() members), are sent like the array @c send of their 
+   *  elements with a single MPI_Send. Views of part of a larger buffer 
+   *  are thus sent without copying.
+   *
+   *  Non-contiguous parts of an array described by a @c strided_view
+   *  or a @c subarray are sent with a single MPI_Send of their cached
+   *  derived datatype, again without copying.
+   *
    *  Note that the transmission mode for variable-length data is an 
    *  implementation detail that is subject to change.
    *
@@ -282,7 +402,7 @@ class communicator
    *  correctly receive the message.
    */
   template<typename T>
-  void send(int dest, int tag, const T* values, int n) const;
+  void send(int dest, int tag, const T* values, std::size_t n) const;
 
   /**
    * @brief Receive data from a remote process.
@@ -321,6 +441,38 @@ class communicator
   template<typename T, typename A>
   status recv(int source, int tag, std::vector<T,A>& value) const;
 
+  /**
+   *  @brief Receive a string of unknown length.
+   *
+   *  Like the @c std::vector receive, the string is resized to fit the
+   *  matched message exactly.
+   */
+  template<typename C, class Tr, class A>
+  status recv(int source, int tag, std::basic_string<C,Tr,A>& value) const;
+
+  /**
+   *  @brief Receive into a temporary contiguous view, e.g. a 
+   *  @c std::span of part of a larger buffer.
+   *
+   *  Receiving into a contiguous range (through this or the @c T& 
+   *  overload) fills at most @c std::size(values) elements; the range
+   *  is never resized. Only views that do not own their elements (see
+   *  @c detail::is_borrowed_range) are accepted as temporaries.
+   */
+  template<typename R, typename = std::enable_if_t<
+    !std::is_lvalue_reference<R>::value && 
+    (detail::is_borrowed_range<R>::value || detail::is_datatype_view<R>::value)> >
+  status recv(int source, int tag, R&& values) const;
+
+  /**
+   *  The data received into a temporary container would be lost.
+   */
+  template<typename T, typename A>
+  status recv(int source, int tag, std::vector<T,A>&& values) const = delete;
+
+  template<typename C, class Tr, class A>
+  status recv(int source, int tag, std::basic_string<C,Tr,A>&& values) const = delete;
+
 
   /**
    * @brief Receive an array of values from a remote process.
@@ -352,12 +504,105 @@ class communicator
    *   @returns Information about the received message.
    */
   template<typename T>
-  status recv(int source, int tag, T* values, int n) const;
+  status recv(int source, int tag, T* values, std::size_t n) const;
+
+
+  /**
+   *  @brief Send data to one process and receive data from another.
+   *
+   *  This routine sends @p svalue with tag @p stag to the process @p
+   *  dest and receives @p rvalue with tag @p rtag from the process @p
+   *  source in a single deadlock-free operation, e.g. for pairwise
+   *  exchanges where both sides send first. The messages are
+   *  compatible with plain @c send and @c recv on the other side.
+   *
+   *  If @c T is an MPI datatype, an invocation of this routine will be
+   *  mapped to a single call to @c MPI_Sendrecv.
+   *
+   *  @param dest The rank of the remote process to which the data
+   *  will be sent.
+   *
+   *  @param stag The tag that will be associated with the sent message.
+   *
+   *  @param svalue The value that will be transmitted to @p dest.
+   *
+   *  @param source The process that will be sending data to us. This 
+   *  may be the constant @c any_source.
+   *
+   *  @param rtag The tag of the message to receive. This may be the 
+   *  constant @c any_tag.
+   *
+   *  @param rvalue Will contain the received value.
+   *
+   *  @returns Information about the received message.
+   */
+  template<typename T>
+  status sendrecv(int dest, int stag, const T& svalue, 
+                  int source, int rtag, T& rvalue) const;
+
+  /**
+   *  @brief Exchange arrays of values with @c MPI_Sendrecv.
+   *
+   *  Sends @p sn values from @p svalues to @p dest and receives at 
+   *  most @p rn values into @p rvalues from @p source.
+   */
+  template<typename T>
+  status sendrecv(int dest, int stag, const T* svalues, std::size_t sn,
+                  int source, int rtag, T* rvalues, std::size_t rn) const;
+
+  /**
+   *  @brief Exchange @c std::array of values with @c MPI_Sendrecv.
+   */
+  template<typename T, std::size_t N>
+  status sendrecv(int dest, int stag, const std::array<T,N>& svalues,
+                  int source, int rtag, std::array<T,N>& rvalues) const;
+
+  /**
+   *  @brief Exchange vectors of values.
+   *
+   *  The vectors use the same single message format as @c send/recv
+   *  of vectors, so the received vector is resized to whatever the
+   *  source sent. Since its size is not known in advance, the receive
+   *  is done with a matched probe while the send is in flight instead
+   *  of a single @c MPI_Sendrecv.
+   */
+  template<typename T, typename A>
+  status sendrecv(int dest, int stag, const std::vector<T,A>& svalues,
+                  int source, int rtag, std::vector<T,A>& rvalues) const;
+
+  /**
+   *  @brief Send a value to one process and replace it with a value
+   *  received from another.
+   *
+   *  Equivalent to @c sendrecv but uses a single buffer, mapping to
+   *  @c MPI_Sendrecv_replace. Vectors of known size can use the array 
+   *  version with @c data() and @c size().
+   */
+  template<typename T>
+  status sendrecv_replace(int dest, int stag, int source, int rtag, 
+                          T& value) const;
+
+  /**
+   *  @brief Send an array to one process and replace it with an array
+   *  of @p n values received from another.
+   */
+  template<typename T>
+  status sendrecv_replace(int dest, int stag, int source, int rtag, 
+                          T* values, std::size_t n) const;
+
+  /**
+   *  @brief Send a @c std::array to one process and replace it with 
+   *  one received from another.
+   */
+  template<typename T, std::size_t N>
+  status sendrecv_replace(int dest, int stag, int source, int rtag, 
+                          std::array<T,N>& values) const;
 
 
   // We're sending/receiving a vector with associated MPI datatype.
-  // We need to send/recv the size and then the data and make sure 
-  // blocking and non blocking method agrees on the format.
+  // The vector goes as one message and the receiver sizes its buffer 
+  // from the matched message; blocking and non blocking methods must 
+  // agree on the format.
 
   template<typename T, typename A>
   void send_vector(int dest, int tag, const std::vector<T,A>& value, 
@@ -369,28 +614,6 @@ class communicator
 
   protected:
 
-  /**
-   * INTERNAL ONLY
-   *
-   * Function object that frees an MPI communicator and deletes the
-   * memory associated with it. Intended to be used as a deleter with
-   * shared_ptr.
-   */
-  struct comm_free
-  {
-    void operator()(MPI_Comm* comm) const
-    {
-      assert( comm != nullptr );
-      assert(*comm != MPI_COMM_NULL);
-      int finalized;
-      MPI_CHECK_RESULT(MPI_Finalized, (&finalized));
-      if (finalized == 0)
-        MPI_CHECK_RESULT(MPI_Comm_free, (comm));
-      delete comm;
-    }
-  };
-
-
   //--------------------------------------------------
 
   /**
@@ -415,7 +638,7 @@ class communicator
    */
   template<typename T>
   void 
-  array_send_impl(int dest, int tag, const T* values, int n, mpl::true_ /*unused*/) const;
+  array_send_impl(int dest, int tag, const T* values, std::size_t n, mpl::true_ /*unused*/) const;
 
   /**
    * We're receiving an array of a type that has an associated MPI
@@ -423,7 +646,47 @@ class communicator
    */
   template<typename T>
   status 
-  array_recv_impl(int source, int tag, T* values, int n, mpl::true_ /*unused*/) const;
+  array_recv_impl(int source, int tag, T* values, std::size_t n, mpl::true_ /*unused*/) const;
+
+  //--------------------------------------------------
+
+  /**
+   * We're exchanging arrays of a type that has an associated MPI
+   * datatype, so we map directly to that datatype.
+   */
+  template<typename T>
+  status 
+  array_sendrecv_impl(int dest, int stag, const T* svalues, std::size_t sn,
+                      int source, int rtag, T* rvalues, std::size_t rn, 
+                      mpl::true_ /*unused*/) const;
+
+  /**
+   * We're exchanging vectors of a type that has an associated MPI
+   * datatype; the received vector is sized from the matched message.
+   */
+  template<typename T, typename A>
+  status 
+  sendrecv_vector(int dest, int stag, const std::vector<T,A>& svalues,
+                  int source, int rtag, std::vector<T,A>& rvalues, 
+                  mpl::true_ /*unused*/) const;
+
+  /**
+   * We're replacing an array of a type that has an associated MPI
+   * datatype, so we map directly to that datatype.
+   */
+  template<typename T>
+  status 
+  array_sendrecv_replace_impl(int dest, int stag, int source, int rtag, 
+                              T* values, std::size_t n, mpl::true_ /*unused*/) const;
+
+  /**
+   * We're sending/receiving a view whose layout is given by a derived
+   * datatype (@c strided_view, @c subarray); one element of it is
+   * transmitted starting from @p base.
+   */
+  void datatype_send_impl(int dest, int tag, const void* base, MPI_Datatype type) const;
+
+  status datatype_recv_impl(int source, int tag, void* base, MPI_Datatype type) const;
 
   //--------------------------------------------------
   // Non-blocking communications
@@ -566,11 +829,58 @@ class communicator
    *  @returns a @c request object that describes this communication.
    */
   template<typename T>
-  request isend(int dest, int tag, const T* values, int n) const;
+  request isend(int dest, int tag, const T* values, std::size_t n) const;
 
   template<typename T, class A>
   request isend(int dest, int tag, const std::vector<T,A>& values) const;
 
+  /**
+   *  @brief Send a vector without blocking, taking ownership of it.
+   *
+   *  The vector is moved (not copied) into the returned request, which
+   *  keeps it alive until the request and all its copies are gone. The
+   *  caller therefore does not need to keep a buffer around until the
+   *  send has completed. The message is identical to that of the other
+   *  vector sends.
+   *
+   *  @returns a @c request object that describes this communication;
+   *  the sent vector is accessible via @c request::data<std::vector<T,A>>().
+   */
+  template<typename T, class A>
+  request isend(int dest, int tag, std::vector<T,A>&& values) const;
+
+  /**
+   *  @brief Send a string without blocking, taking ownership of it.
+   *
+   *  Like the @c std::vector variant; the string is accessible via 
+   *  @c request::data<std::basic_string<C,Tr,A>>().
+   */
+  template<typename C, class Tr, class A>
+  request isend(int dest, int tag, std::basic_string<C,Tr,A>&& values) const;
+
+  /**
+   *  @brief Send a shared value without blocking, sharing ownership
+   *  of it.
+   *
+   *  Sends @c *value like @c isend(dest, tag, *value) but the returned
+   *  request holds a reference to @p value, keeping it alive until the
+   *  send has completed. @c T may be any type accepted by @c isend, 
+   *  including @c std::vector. The value is not copied; it should not 
+   *  be modified while the send is in flight.
+   */
+  template<typename T>
+  request isend(int dest, int tag, std::shared_ptr<T> value) const;
+
+  /**
+   *  @brief Send a shared array of @p n values without blocking, 
+   *  sharing ownership of it.
+   *
+   *  Like @c isend(dest, tag, values.get(), n) but the returned
+   *  request keeps the buffer owned by @p values alive.
+   */
+  template<typename T>
+  request isend(int dest, int tag, std::shared_ptr<T> values, std::size_t n) const;
+
 
   /**
    * @brief Initiate receipt of an array of values from a remote process.
@@ -599,10 +909,100 @@ class communicator
    *    @returns a @c request object that describes this communication.
    */
   template<typename T>
-  request irecv(int source, int tag, T* values, int n) const;
+  request irecv(int source, int tag, T* values, std::size_t n) const;
 
+  /**
+   * @brief Initiate receipt of a vector of values of unknown size.
+   *
+   * The message is matched with @c MPI_Improbe right away if it has
+   * already arrived, and otherwise when the returned request is first
+   * tested or waited on; only then is @p values resized and the payload
+   * received. The vector must therefore outlive the request.
+   *
+   * Receives of this kind that are still unmatched are matched in the
+   * order in which they are tested, not in posting order. Several of
+   * them with the same @p source and @p tag must be completed in
+   * posting order (e.g. with @c wait_all) to keep the non-overtaking
+   * guarantee of MPI.
+   */
   template<typename T, typename A>
   request irecv(int source, int tag, std::vector<T,A>& values) const;
+
+  /**
+   * @brief Initiate receipt of a string of unknown length.
+   *
+   * Works like the @c std::vector variant; the string must outlive 
+   * the request.
+   */
+  template<typename C, class Tr, class A>
+  request irecv(int source, int tag, std::basic_string<C,Tr,A>& values) const;
+
+  /**
+   * @brief Initiate receipt into a temporary contiguous view.
+   *
+   * At most @c std::size(values) elements are received into the buffer
+   * the view refers to; that buffer (not the view) must outlive the request.
+   * Only views that do not own their elements are accepted.
+   */
+  template<typename R, typename = std::enable_if_t<
+    !std::is_lvalue_reference<R>::value && 
+    (detail::is_borrowed_range<R>::value || detail::is_datatype_view<R>::value)> >
+  request irecv(int source, int tag, R&& values) const;
+
+  /**
+   * The request would refer to a temporary container.
+   */
+  template<typename T, typename A>
+  request irecv(int source, int tag, std::vector<T,A>&& values) const = delete;
+
+  template<typename C, class Tr, class A>
+  request irecv(int source, int tag, std::basic_string<C,Tr,A>&& values) const = delete;
+
+
+  //--------------------------------------------------
+  // Persistent communications
+
+  /**
+   *  @brief Create a persistent request for repeatedly sending a value.
+   *
+   *  The send is set up once with @c MPI_Send_init but not started;
+   *  each call to @c persistent_request::start() then transmits the
+   *  current contents of @p value to @p dest with tag @p tag, like an
+   *  @c isend. The value must stay alive (at the same address) as long
+   *  as the request is used. @p value may also be a @c strided_view or
+   *  @c subarray, e.g. for a halo face sent every step.
+   *
+   *  @returns an inactive @c persistent_request.
+   */
+  template<typename T>
+  persistent_request send_init(int dest, int tag, const T& value) const;
+
+  /**
+   *  @brief Create a persistent request for repeatedly sending an
+   *  array of @p n values.
+   */
+  template<typename T>
+  persistent_request send_init(int dest, int tag, const T* values, std::size_t n) const;
+
+  /**
+   *  @brief Create a persistent request for repeatedly receiving a
+   *  value.
+   *
+   *  The receive is set up once with @c MPI_Recv_init but not started;
+   *  each call to @c persistent_request::start() then receives into
+   *  @p value from @p source with tag @p tag, like an @c irecv.
+   *
+   *  @returns an inactive @c persistent_request.
+   */
+  template<typename T>
+  persistent_request recv_init(int source, int tag, T& value) const;
+
+  /**
+   *  @brief Create a persistent request for repeatedly receiving an
+   *  array of at most @p n values.
+   */
+  template<typename T>
+  persistent_request recv_init(int source, int tag, T* values, std::size_t n) const;
   
   private:
 
@@ -627,7 +1027,7 @@ class communicator
    */
   template<typename T>
   request 
-  array_isend_impl(int dest, int tag, const T* values, int n, 
+  array_isend_impl(int dest, int tag, const T* values, std::size_t n, 
                    mpl::true_ /*unused*/) const;
 
   /**
@@ -636,12 +1036,13 @@ class communicator
    */
   template<typename T>
   request 
-  array_irecv_impl(int source, int tag, T* values, int n, mpl::true_ /*unused*/) const;
+  array_irecv_impl(int source, int tag, T* values, std::size_t n, mpl::true_ /*unused*/) const;
 
 
   // We're sending/receivig a vector with associated MPI datatype.
-  // We need to send/recv the size and then the data and make sure 
-  // blocking and non blocking method agrees on the format.
+  // The vector goes as one message and the receiver sizes its buffer 
+  // from the matched message; blocking and non blocking methods must 
+  // agree on the format.
   template<typename T, typename A>
   request irecv_vector(int source, int tag, std::vector<T,A>& values, 
                        mpl::true_ /*primitive*/) const;
@@ -650,6 +1051,35 @@ class communicator
   request isend_vector(int dest, int tag, const std::vector<T,A>& values,
                        mpl::true_ /*unused*/) const;
 
+  /**
+   * We're setting up persistent communication of an array of a type 
+   * that has an associated MPI datatype, so we map directly to that 
+   * datatype.
+   */
+  template<typename T>
+  persistent_request
+  array_send_init_impl(int dest, int tag, const T* values, std::size_t n, 
+                       mpl::true_ /*unused*/) const;
+
+  template<typename T>
+  persistent_request
+  array_recv_init_impl(int source, int tag, T* values, std::size_t n, 
+                       mpl::true_ /*unused*/) const;
+
+  /**
+   * Non-blocking and persistent communication of a view with a derived
+   * datatype, see @c datatype_send_impl.
+   */
+  request datatype_isend_impl(int dest, int tag, const void* base, MPI_Datatype type) const;
+
+  request datatype_irecv_impl(int source, int tag, void* base, MPI_Datatype type) const;
+
+  persistent_request 
+  datatype_send_init_impl(int dest, int tag, const void* base, MPI_Datatype type) const;
+
+  persistent_request 
+  datatype_recv_init_impl(int source, int tag, void* base, MPI_Datatype type) const;
+
 
   
   public:
@@ -672,7 +1102,7 @@ class communicator
    *   @returns Returns information about the first message that
    *   matches the given criteria.
    */
-  //status probe(int source = any_source, int tag = any_tag) const;
+  status probe(int source = any_source, int tag = any_tag) const;
 
   /**
    * @brief Determine if a message is available to be received.
@@ -693,10 +1123,35 @@ class communicator
    *
    *   @returns If a matching message is available, returns
    *   information about that message. Otherwise, returns an empty
-   *   @c boost::optional.
+   *   @c std::optional.
+   */
+  std::optional<status>
+  iprobe(int source = any_source, int tag = any_tag) const;
+
+  /**
+   * @brief Waits until a message is available and matches it.
+   *
+   * Like @c probe, but the matched message is removed from the
+   * communicator and can only be received through the returned
+   * handle. Unlike a @c probe followed by @c recv, this is safe when
+   * several threads receive with the same (@p source, @p tag). The
+   * functionality is equivalent to @c MPI_Mprobe.
+   *
+   *   @returns The matched message; its @c status() tells the size of
+   *   the message via @c status::count<T>().
    */
-  //optional<status>
-  //iprobe(int source = any_source, int tag = any_tag) const;
+  message mprobe(int source = any_source, int tag = any_tag) const;
+
+  /**
+   * @brief Matches a message if one is available to be received.
+   *
+   * Non-blocking version of @c mprobe, equivalent to @c MPI_Improbe.
+   *
+   *   @returns The matched message, or an empty @c std::optional if no
+   *   matching message is available.
+   */
+  std::optional<message>
+  improbe(int source = any_source, int tag = any_tag) const;
 
 
 #ifdef barrier
@@ -722,7 +1177,25 @@ class communicator
 
 
  protected:
-  std::shared_ptr<MPI_Comm> comm_ptr;
+  /// Two step collectives queue their payloads in the shared state
+  friend class request;
+
+  /// Share @p state; an empty state gives an invalid communicator
+  explicit communicator(std::shared_ptr<detail::comm_state> state);
+
+  /// Take ownership of @p comm just created by all of its processes,
+  /// which lets the node facts be computed right away
+  static communicator adopt_collective(MPI_Comm comm);
+
+  /// The MPI communicator and its cached facts, shared by all copies
+  std::shared_ptr<detail::comm_state> comm_ptr;
+
+  /// The shared state of a valid communicator
+  detail::comm_state& state() const
+  {
+    if (!comm_ptr) throw MPI_Invalid_Comm_Error();
+    return *comm_ptr;
+  }
 
 };
 
@@ -3,6 +3,9 @@
 
 #pragma once
 
+#include <cassert>
+#include <cstdlib>
+
 #include "communicator.h"
 
 
@@ -11,28 +14,51 @@ namespace mpi4cpp { namespace mpi {
 
 inline communicator::communicator()
 {
-  comm_ptr.reset(new MPI_Comm(MPI_COMM_WORLD));
+  comm_ptr = detail::world_comm_state();
 }
 
-inline int 
-communicator::size() const
+inline communicator::communicator(const MPI_Comm& comm, comm_create_kind kind)
 {
-  int size_;
-  MPI_CHECK_RESULT(MPI_Comm_size, (MPI_Comm(*this), &size_));
-  return size_;
+  if (comm == MPI_COMM_NULL)
+    /* MPI_COMM_NULL indicates that the communicator is not usable. */
+    return;
+
+  switch (kind) {
+  case comm_duplicate:
+    {
+      MPI_Comm newcomm;
+      MPI_CHECK_RESULT(MPI_Comm_dup, (comm, &newcomm));
+      MPI_Comm_set_errhandler(newcomm, MPI_ERRORS_RETURN);
+      comm_ptr = std::make_shared<detail::comm_state>(newcomm, true, true);
+      break;
+    }
+
+  case comm_take_ownership:
+    // the predefined communicators must never be freed
+    assert(comm != MPI_COMM_WORLD && comm != MPI_COMM_SELF);
+    comm_ptr = std::make_shared<detail::comm_state>(comm, true);
+    break;
+
+  case comm_attach:
+    comm_ptr = std::make_shared<detail::comm_state>(comm, false);
+    break;
+  }
 }
 
-inline int 
-communicator::rank() const
+inline communicator::communicator(std::shared_ptr<detail::comm_state> state)
+  : comm_ptr(std::move(state))
+{}
+
+inline communicator
+communicator::adopt_collective(MPI_Comm comm)
 {
-  int rank_;
-  MPI_CHECK_RESULT(MPI_Comm_rank, (MPI_Comm(*this), &rank_));
-  return rank_;
+  if (comm == MPI_COMM_NULL) return communicator(std::shared_ptr<detail::comm_state>());
+  return communicator(std::make_shared<detail::comm_state>(comm, true, true));
 }
 
 inline communicator::operator MPI_Comm() const
 {
-  if (comm_ptr) return *comm_ptr;
+  if (comm_ptr) return comm_ptr->comm;
   else return MPI_COMM_NULL;
 }
 
@@ -45,6 +71,85 @@ communicator::abort(int errcode) const
 }
 
 
+inline communicator
+communicator::dup() const
+{
+  return communicator(MPI_Comm(*this), comm_duplicate);
+}
+
+inline communicator
+communicator::split(int color, int key) const
+{
+  MPI_Comm newcomm;
+  MPI_CHECK_RESULT(MPI_Comm_split, (MPI_Comm(*this), color, key, &newcomm));
+  return adopt_collective(newcomm);
+}
+
+inline communicator
+communicator::split(int color) const
+{
+  return split(color, rank());
+}
+
+inline communicator
+communicator::split_type(int type, std::optional<int> key) const
+{
+  MPI_Comm newcomm;
+  MPI_CHECK_RESULT(MPI_Comm_split_type,
+                  (MPI_Comm(*this), type, key ? *key : rank(), MPI_INFO_NULL, &newcomm));
+  return adopt_collective(newcomm);
+}
+
+inline communicator
+communicator::split_shared() const
+{
+  return split_type(MPI_COMM_TYPE_SHARED);
+}
+
+
+inline status
+communicator::probe(int source, int tag) const
+{
+  status stat;
+  MPI_CHECK_RESULT(MPI_Probe,
+                  (source, tag, MPI_Comm(*this), &stat.m_status));
+  return stat;
+}
+
+inline std::optional<status>
+communicator::iprobe(int source, int tag) const
+{
+  status stat;
+  int flag = 0;
+  MPI_CHECK_RESULT(MPI_Iprobe,
+                  (source, tag, MPI_Comm(*this), &flag, &stat.m_status));
+  if (flag) return stat;
+  else return std::optional<status>();
+}
+
+inline message
+communicator::mprobe(int source, int tag) const
+{
+  status stat;
+  MPI_Message msg;
+  MPI_CHECK_RESULT(MPI_Mprobe,
+                  (source, tag, MPI_Comm(*this), &msg, &stat.m_status));
+  return message(msg, stat);
+}
+
+inline std::optional<message>
+communicator::improbe(int source, int tag) const
+{
+  status stat;
+  MPI_Message msg;
+  int flag = 0;
+  MPI_CHECK_RESULT(MPI_Improbe,
+                  (source, tag, MPI_Comm(*this), &flag, &msg, &stat.m_status));
+  if (flag) return message(msg, stat);
+  else return std::optional<message>();
+}
+
+
 inline void 
 communicator::barrier() const
 {
@@ -52,4 +157,14 @@ communicator::barrier() const
 }
 
 
+inline bool
+operator==(const communicator& comm1, const communicator& comm2)
+{
+  int result;
+  MPI_CHECK_RESULT(MPI_Comm_compare,
+                  (MPI_Comm(comm1), MPI_Comm(comm2), &result));
+  return result == MPI_IDENT;
+}
+
+
 } } // ns mpi4cpp::mpi
@@ -0,0 +1,218 @@
+// Copyright 2018 - 2026, Joonas Nättilä and the hel-astro-lab contributors
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+/*
+ *  This header lets C++20 coroutines co_await nonblocking requests.
+ *  It is empty for earlier standards; MPI4CPP_HAS_COROUTINES tells
+ *  whether it is available.
+ */
+
+#if __cplusplus >= 202002L && defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+#define MPI4CPP_HAS_COROUTINES
+#endif
+
+#ifdef MPI4CPP_HAS_COROUTINES
+
+#include <cassert>
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <utility>
+
+#include "request.h"
+#include "request_set.h"
+#include "status.h"
+
+namespace mpi4cpp { namespace mpi {
+
+class scheduler;
+
+/**
+ *  @brief A coroutine driven by a @c scheduler.
+ *
+ *  A function returning @c task may @c co_await nonblocking requests,
+ *  e.g. @c co_await @c world.irecv(left, tag, halo). It does not start
+ *  before it is handed to @c scheduler::spawn, which then owns it; its
+ *  frame is freed when it returns.
+ */
+class task
+{
+ public:
+  struct promise_type
+  {
+    task get_return_object()
+    {
+      return task(std::coroutine_handle<promise_type>::from_promise(*this));
+    }
+    std::suspend_always initial_suspend() noexcept { return {}; }
+    std::suspend_never final_suspend() noexcept { return {}; }
+    void return_void() {}
+    void unhandled_exception() { std::terminate(); }
+
+    ~promise_type();
+
+    /// The scheduler that resumes this task
+    scheduler* sched{nullptr};
+  };
+
+  task(task&& other) noexcept : m_handle(std::exchange(other.m_handle, nullptr)) {}
+  task(const task&) = delete;
+  task& operator=(const task&) = delete;
+
+  /// A task that was never spawned is destroyed unstarted
+  ~task() { if (m_handle) m_handle.destroy(); }
+
+ private:
+  friend class scheduler;
+
+  explicit task(std::coroutine_handle<promise_type> handle) : m_handle(handle) {}
+
+  std::coroutine_handle<promise_type> m_handle;
+};
+
+
+/**
+ *  @brief Runs tasks and resumes them as their requests complete.
+ *
+ *  A task that awaits a request which has not completed yet is parked
+ *  in the internal @c request_set; @c poll() and @c run() complete
+ *  requests with @c MPI_Testsome / @c MPI_Waitsome and resume the
+ *  tasks waiting for them. Thousands of tasks can interleave their
+ *  communication this way on a single thread.
+ *
+ *  @code
+ *  mpi::task update(mpi::communicator& world, tile& t) {
+ *    mpi::request send = world.isend(t.right, t.id, t.boundary);
+ *    co_await world.irecv(t.left, t.id, t.halo);
+ *    t.unpack();
+ *    co_await std::move(send);
+ *  }
+ *
+ *  mpi::scheduler sched;
+ *  for(auto& t : tiles) sched.spawn(update(world, t));
+ *  sched.run();
+ *  @endcode
+ *
+ *  Tasks may spawn other tasks but must not call @c poll() or @c run()
+ *  of their scheduler.
+ */
+class scheduler
+{
+ public:
+  scheduler() = default;
+  scheduler(const scheduler&) = delete;
+  scheduler& operator=(const scheduler&) = delete;
+
+  /**
+   *  Take @p t over and run it until it first suspends.
+   */
+  void spawn(task t)
+  {
+    std::coroutine_handle<task::promise_type> handle = std::exchange(t.m_handle, nullptr);
+    handle.promise().sched = this;
+    ++m_tasks;
+    handle.resume();
+  }
+
+  /**
+   *  Resume the tasks whose requests have completed, without waiting.
+   *
+   *  @returns The number of completed requests.
+   */
+  std::size_t poll() { return m_requests.test_some(); }
+
+  /**
+   *  Run until all tasks have finished.
+   */
+  void run()
+  {
+    while (!m_requests.empty()) m_requests.wait_some();
+    assert(m_tasks == 0);
+  }
+
+  /**
+   *  The number of unfinished tasks.
+   */
+  std::size_t size() const { return m_tasks; }
+
+  /**
+   *  Have all tasks finished?
+   */
+  bool empty() const { return m_tasks == 0; }
+
+ private:
+  friend class request_awaiter;
+  friend struct task::promise_type;
+
+  /// Resume @p handle with the status of @p req once it completes,
+  /// after the continuation @p req may already have
+  void park(request req, std::coroutine_handle<> handle, status* result)
+  {
+    std::function<void(const status&)> previous = std::move(req.m_continuation);
+    req.then([previous = std::move(previous), handle, result](const status& stat) {
+      if (previous) previous(stat);
+      *result = stat;
+      handle.resume();
+    });
+    m_requests.add(std::move(req));
+  }
+
+  request_set m_requests;
+  std::size_t m_tasks{0};
+};
+
+inline task::promise_type::~promise_type()
+{
+  if (sched) --sched->m_tasks;
+}
+
+
+/**
+ *  @brief The awaiter of a request in a @c task: the task goes on
+ *  right away if the request has completed and is parked in its
+ *  scheduler otherwise. @c co_await yields the @c status.
+ */
+class request_awaiter
+{
+ public:
+  explicit request_awaiter(request&& req) : m_request(std::move(req)) {}
+
+  bool await_ready()
+  {
+    if (std::optional<status> result = m_request.test()) {
+      m_status = *result;
+      return true;
+    }
+    return false;
+  }
+
+  void await_suspend(std::coroutine_handle<task::promise_type> handle)
+  {
+    assert(handle.promise().sched);
+    handle.promise().sched->park(std::move(m_request), handle, &m_status);
+  }
+
+  status await_resume() const { return m_status; }
+
+ private:
+  request m_request;
+  status  m_status;
+};
+
+/**
+ *  Await the completion of @p req in a @c task. The request is
+ *  consumed, so named requests are awaited with @c std::move. A
+ *  continuation attached with @c request::then is called before the
+ *  task resumes.
+ */
+inline request_awaiter operator co_await(request&& req)
+{
+  return request_awaiter(std::move(req));
+}
+
+} } // end namespace mpi4cpp::mpi
+
+#endif // MPI4CPP_HAS_COROUTINES
@@ -139,7 +139,7 @@ MPI4CPP_DATATYPE(long, MPI_LONG, integer);
 MPI4CPP_DATATYPE(float, MPI_FLOAT, floating_point);
 MPI4CPP_DATATYPE(double, MPI_DOUBLE, floating_point);
 MPI4CPP_DATATYPE(long double, MPI_LONG_DOUBLE, floating_point);
-MPI4CPP_DATATYPE(unsigned char, MPI_UNSIGNED_CHAR, builtin);
+MPI4CPP_DATATYPE(unsigned char, MPI_UNSIGNED_CHAR, integer);
 MPI4CPP_DATATYPE(unsigned short, MPI_UNSIGNED_SHORT, integer);
 MPI4CPP_DATATYPE(unsigned, MPI_UNSIGNED, integer);
 MPI4CPP_DATATYPE(unsigned long, MPI_UNSIGNED_LONG, integer);
@@ -183,9 +183,9 @@ MPI4CPP_DATATYPE(wchar_t, MPI_WCHAR, builtin);
 
 // Define long long or __int64 specialization of is_mpi_datatype, if possible.
 #if (defined(MPI_LONG_LONG_INT) || (defined(MPI_VERSION) && MPI_VERSION >= 2))
-MPI4CPP_DATATYPE(long long, MPI_LONG_LONG_INT, builtin);
+MPI4CPP_DATATYPE(long long, MPI_LONG_LONG_INT, integer);
 #elif (defined(MPI_LONG_LONG_INT) || (defined(MPI_VERSION) && MPI_VERSION >= 2))
-MPI4CPP_DATATYPE(__int64, MPI_LONG_LONG_INT, builtin); 
+MPI4CPP_DATATYPE(__int64, MPI_LONG_LONG_INT, integer); 
 #endif
 
 // Define unsigned long long or unsigned __int64 specialization of
@@ -195,15 +195,15 @@ MPI4CPP_DATATYPE(__int64, MPI_LONG_LONG_INT, builtin);
 // MPI_UNSIGNED_LONG_LONG.
 #if (defined(MPI_UNSIGNED_LONG_LONG) \
    || (defined(MPI_VERSION) && MPI_VERSION >= 2))
-MPI4CPP_DATATYPE(unsigned long long, MPI_UNSIGNED_LONG_LONG, builtin);
+MPI4CPP_DATATYPE(unsigned long long, MPI_UNSIGNED_LONG_LONG, integer);
 #elif (defined(MPI_UNSIGNED_LONG_LONG) \
    || (defined(MPI_VERSION) && MPI_VERSION >= 2))
-MPI4CPP_DATATYPE(unsigned __int64, MPI_UNSIGNED_LONG_LONG, builtin); 
+MPI4CPP_DATATYPE(unsigned __int64, MPI_UNSIGNED_LONG_LONG, integer); 
 #endif
 
 // Define signed char specialization of is_mpi_datatype, if possible.
 #if defined(MPI_SIGNED_CHAR) || (defined(MPI_VERSION) && MPI_VERSION >= 2)
-MPI4CPP_DATATYPE(signed char, MPI_SIGNED_CHAR, builtin);
+MPI4CPP_DATATYPE(signed char, MPI_SIGNED_CHAR, integer);
 #endif
 
 
@@ -224,8 +224,8 @@ namespace detail {
 template<>
 inline MPI_Datatype get_mpi_datatype<bool>(const bool& /*unused*/)
 {
-  static MPI_Datatype type = detail::build_mpi_datatype_for_bool();
-  return type;
+  return detail::mpi_datatype_cache().get_or_create<bool>(
+      detail::build_mpi_datatype_for_bool);
 }
 
 template<>
@@ -236,3 +236,5 @@ struct is_mpi_datatype<bool>
 
 
 } } // ns mpi4cpp::mpi
+
+#include "mpi4cpp/detail/struct_datatype.h"
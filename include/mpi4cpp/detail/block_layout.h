@@ -0,0 +1,51 @@
+// Copyright 2018 - 2026, Joonas Nättilä and the hel-astro-lab contributors
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "mpi4cpp/detail/large_count.h"
+
+
+namespace mpi4cpp { namespace mpi { namespace detail {
+
+/// @brief element counts and displacements of the per-process blocks
+/// of a vector collective (@c MPI_Gatherv, @c MPI_Scatterv, ...)
+struct block_layout
+{
+  std::vector<count_type> counts;
+  std::vector<displ_type> displs;
+
+  /// lay out blocks of the given sizes back to back; returns the
+  /// total number of elements. Without MPI-4 large counts, counts and
+  /// displacements are ints; larger layouts throw
+  /// @c MPI_Count_Overflow_Error.
+  std::size_t assign(const std::size_t* sizes, std::size_t n)
+  {
+    counts.resize(n);
+    displs.resize(n);
+
+    std::size_t total = 0;
+    for(std::size_t i=0; i<n; i++) {
+      counts[i] = checked_count(sizes[i]);
+      displs[i] = static_cast<displ_type>(checked_count(total));
+      total += sizes[i];
+    }
+    checked_count(total);
+    return total;
+  }
+
+  /// offsets of the blocks followed by the total
+  void offsets(std::vector<std::size_t>& offs) const
+  {
+    offs.resize(displs.size() + 1);
+    for(std::size_t i=0; i<displs.size(); i++)
+      offs[i] = static_cast<std::size_t>(displs[i]);
+    offs.back() = displs.empty() ? 0 : offs[displs.size()-1] + counts.back();
+  }
+};
+
+
+} } } // ns mpi4cpp::mpi::detail
@@ -0,0 +1,182 @@
+// Copyright 2018 - 2026, Joonas Nättilä and the hel-astro-lab contributors
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+
+#include "mpi4cpp/exception.h"
+
+
+namespace mpi4cpp { namespace mpi { namespace detail {
+
+
+/// @brief state of a nonblocking collective that exchanges sizes
+/// before its payload, e.g. the broadcast of a @c std::vector
+///
+/// The sizes are posted on the communicator when the collective is
+/// started; the payload is posted on the private duplicate of
+/// @c comm_state::payload_comm() once they have arrived.
+struct two_step_collective
+{
+  virtual ~two_step_collective() = default;
+
+  /// Post the payload on @p comm into @p req
+  virtual void post_payload(MPI_Comm comm, MPI_Request* req) = 0;
+
+  MPI_Request sizes{MPI_REQUEST_NULL};
+  MPI_Request payload{MPI_REQUEST_NULL};
+  bool posted{false};
+};
+
+
+/// @brief an MPI communicator together with the facts about it that
+/// are queried once and shared by all copies of the communicators
+/// referring to it
+///
+/// Rank and size are queried once, when the state is created or, for
+/// the world state that may be created before @c MPI_Init, on first
+/// use; afterwards @c communicator::rank() and @c size() are plain
+/// loads behind a flag. The node
+/// facts need the collective @c MPI_Comm_split_type; they are computed
+/// when the state is created by a collective operation (environment,
+/// dup, split, topologies) and otherwise on first use.
+class comm_state
+{
+ public:
+  /// @param owned free @p comm with the last copy
+  /// @param collective called by all processes of @p comm, so the node
+  /// facts can be computed right away
+  /// @param deferred do not call MPI until rank or size are used
+  comm_state(MPI_Comm comm, bool owned, bool collective = false, bool deferred = false)
+    : comm(comm), m_owned(owned)
+  {
+    if (!deferred) query();
+    if (collective) node();
+  }
+
+  ~comm_state()
+  {
+    int finalized;
+    MPI_CHECK_RESULT(MPI_Finalized, (&finalized));
+    // the predefined communicators are never freed
+    if (finalized != 0) return;
+    if (m_payload_comm != MPI_COMM_NULL)
+      MPI_CHECK_RESULT(MPI_Comm_free, (&m_payload_comm));
+    if (m_owned && comm != MPI_COMM_WORLD && comm != MPI_COMM_SELF)
+      MPI_CHECK_RESULT(MPI_Comm_free, (&comm));
+  }
+
+  comm_state(const comm_state&) = delete;
+  comm_state& operator=(const comm_state&) = delete;
+
+  MPI_Comm comm;
+
+  /// rank of the calling process in @c comm
+  int rank() { query(); return m_rank; }
+
+  /// number of processes in @c comm
+  int size() { query(); return m_size; }
+
+  /// ranks of the processes sharing a node with the calling process
+  struct node_info
+  {
+    int rank;
+    int size;
+    bool single_node;
+  };
+
+  /// node facts; collective over @c comm on first use
+  const node_info& node()
+  {
+    std::call_once(m_node_once, [this] {
+      MPI_Comm shared;
+      MPI_CHECK_RESULT(MPI_Comm_split_type,
+                      (comm, MPI_COMM_TYPE_SHARED, rank(), MPI_INFO_NULL, &shared));
+      MPI_CHECK_RESULT(MPI_Comm_rank, (shared, &m_node.rank));
+      MPI_CHECK_RESULT(MPI_Comm_size, (shared, &m_node.size));
+      MPI_CHECK_RESULT(MPI_Comm_free, (&shared));
+      m_node.single_node = m_node.size == size();
+    });
+    return m_node;
+  }
+
+  /// Queue @p op, whose sizes have just been posted on @c comm; the
+  /// first call is collective over @c comm
+  ///
+  /// The payloads go to a duplicate of @c comm, so that collectives
+  /// started meanwhile on @c comm cannot match them, and are posted in
+  /// the order the collectives were started, which is the same on all
+  /// processes, whichever request they test first.
+  void start_two_step(std::shared_ptr<two_step_collective> op)
+  {
+    std::call_once(m_payload_once, [this] {
+      MPI_CHECK_RESULT(MPI_Comm_dup, (comm, &m_payload_comm));
+    });
+    m_two_step.push_back(std::move(op));
+  }
+
+  /// Post the payloads of the queued collectives up to @p op as their
+  /// sizes arrive, waiting for the sizes if @p wait
+  ///
+  /// @returns Whether the payload of @p op has been posted
+  bool post_payloads(two_step_collective* op, bool wait)
+  {
+    while (!op->posted) {
+      two_step_collective& next = *m_two_step.front();
+      int flag = 1;
+      if (wait) {
+        MPI_CHECK_RESULT(MPI_Wait, (&next.sizes, MPI_STATUS_IGNORE));
+      } else {
+        MPI_CHECK_RESULT(MPI_Test, (&next.sizes, &flag, MPI_STATUS_IGNORE));
+      }
+      if (!flag) return false;
+
+      next.post_payload(m_payload_comm, &next.payload);
+      next.posted = true;
+      m_two_step.pop_front();
+    }
+    return true;
+  }
+
+ private:
+  void query()
+  {
+    if (m_queried.load(std::memory_order_acquire)) return;
+    std::call_once(m_query_once, [this] {
+      MPI_CHECK_RESULT(MPI_Comm_rank, (comm, &m_rank));
+      MPI_CHECK_RESULT(MPI_Comm_size, (comm, &m_size));
+      m_queried.store(true, std::memory_order_release);
+    });
+  }
+
+  bool m_owned;
+  int m_rank{0};
+  int m_size{0};
+  std::atomic<bool> m_queried{false};
+  std::once_flag m_query_once;
+  std::once_flag m_node_once;
+  node_info m_node{0, 1, false};
+
+  std::once_flag m_payload_once;
+  MPI_Comm m_payload_comm{MPI_COMM_NULL};
+  std::deque<std::shared_ptr<two_step_collective>> m_two_step;
+};
+
+
+/// @brief the state of @c MPI_COMM_WORLD shared by all default
+/// constructed communicators, which may be created before MPI is
+/// initialized; the environment computes its node facts
+inline const std::shared_ptr<comm_state>&
+world_comm_state()
+{
+  static const std::shared_ptr<comm_state> state =
+    std::make_shared<comm_state>(MPI_COMM_WORLD, false, false, true);
+  return state;
+}
+
+
+} } } // ns mpi4cpp::mpi::detail
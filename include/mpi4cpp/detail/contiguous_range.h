@@ -0,0 +1,64 @@
+// Copyright 2018 - 2026, Joonas Nättilä and the hel-astro-lab contributors
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <array>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+#include "mpi4cpp/detail/mpl.h"
+
+
+namespace mpi4cpp { namespace mpi { namespace detail {
+
+/// @brief Type trait that determines if @c T is a contiguous range, i.e.,
+/// @c std::data() and @c std::size() of it give a pointer to its
+/// elements and their number.
+///
+/// This covers C-style arrays, @c std::array, @c std::span,
+/// @c std::basic_string(_view) and user containers with @c data() and
+/// @c size() members.
+template<typename T, typename = void>
+struct is_contiguous_range
+  : mpl::false_
+{ };
+
+template<typename T>
+struct is_contiguous_range<T, std::void_t<
+    decltype(std::data(std::declval<T&>())),
+    decltype(std::size(std::declval<T&>())) > >
+  : mpl::bool_<std::is_pointer<decltype(std::data(std::declval<T&>()))>::value>
+{ };
+
+template<typename T>
+struct is_std_array : mpl::false_ { };
+
+template<typename T, std::size_t N>
+struct is_std_array<std::array<T,N> > : mpl::true_ { };
+
+/// @brief Type trait that determines if @c T is a contiguous range that
+/// does not own its elements, e.g. @c std::span or a pointer and a
+/// size, so that a temporary of it still refers to live storage.
+///
+/// Ranges keeping their elements on the heap (@c std::vector,
+/// @c std::string) are never trivially copyable while views are; the
+/// ranges holding them inline, C arrays and @c std::array, are
+/// excluded explicitly. Specialize it for other types.
+template<typename T>
+struct is_borrowed_range
+  : mpl::bool_<is_contiguous_range<T>::value
+               && std::is_trivially_copyable<std::remove_cv_t<T> >::value
+               && !std::is_array<T>::value
+               && !is_std_array<std::remove_cv_t<T> >::value>
+{ };
+
+/// Element type of a contiguous range, without const
+template<typename T>
+using range_value_t = typename std::remove_const<
+    typename std::remove_pointer<decltype(std::data(std::declval<T&>()))>::type
+  >::type;
+
+
+} } } // ns mpi4cpp::mpi::detail
@@ -0,0 +1,182 @@
+// Copyright 2018 - 2026, Joonas Nättilä and the hel-astro-lab contributors
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <cstddef>
+#include <climits>
+#include <optional>
+
+#include "mpi4cpp/exception.h"
+
+
+/**
+ * MPI-4 provides large count (@c MPI_Count) versions of the
+ * communication routines with a @c _c suffix. MPI4CPP_LARGE(MPI_Send)
+ * selects @c MPI_Send_c when they are available and plain @c MPI_Send
+ * otherwise; in the latter case counts beyond @c MPI4CPP_MAX_COUNT are
+ * expressed with a derived datatype (see @c detail::large_count).
+ */
+#if defined(MPI_VERSION) && MPI_VERSION >= 4
+#define MPI4CPP_HAS_LARGE_COUNT
+#define MPI4CPP_LARGE(MPIFunc) MPIFunc##_c
+#else
+#define MPI4CPP_LARGE(MPIFunc) MPIFunc
+#endif
+
+/**
+ * Largest element count passed to MPI as a plain @c int.
+ */
+#ifndef MPI4CPP_MAX_COUNT
+#define MPI4CPP_MAX_COUNT INT_MAX
+#endif
+
+
+namespace mpi4cpp { namespace mpi { namespace detail {
+
+#ifdef MPI4CPP_HAS_LARGE_COUNT
+using count_type = MPI_Count;
+using displ_type = MPI_Aint;
+#else
+using count_type = int;
+using displ_type = int;
+#endif
+
+/// @brief @p n as a count or displacement of the vector variants of
+/// the collectives, which cannot use the derived datatype of
+/// @c large_count; without MPI-4 it must fit into an @c int, otherwise
+/// @c MPI_Count_Overflow_Error is thrown.
+inline count_type checked_count(std::size_t n)
+{
+#ifndef MPI4CPP_HAS_LARGE_COUNT
+  if (n > static_cast<std::size_t>(MPI4CPP_MAX_COUNT)) throw MPI_Count_Overflow_Error();
+#endif
+  return static_cast<count_type>(n);
+}
+
+
+/// @brief Derived datatype describing @p n consecutive elements of
+/// @p type, built from blocks of at most @c MPI4CPP_MAX_COUNT elements.
+///
+/// The type signature equals that of @p n elements of @p type, so
+/// messages sent with it match receives of plain element counts and
+/// vice versa.
+inline MPI_Datatype build_large_datatype(MPI_Datatype type, std::size_t n)
+{
+  const int block = MPI4CPP_MAX_COUNT;
+  int nblocks   = static_cast<int>(n / block);
+  int remainder = static_cast<int>(n % block);
+
+  MPI_Aint lb, extent;
+  MPI_CHECK_RESULT(MPI_Type_get_extent, (type, &lb, &extent));
+
+  MPI_Datatype blocks, rest;
+  MPI_CHECK_RESULT(MPI_Type_vector, (nblocks, block, block, type, &blocks));
+  MPI_CHECK_RESULT(MPI_Type_contiguous, (remainder, type, &rest));
+
+  int          block_lengths[2] = { 1, 1 };
+  MPI_Aint     offsets[2]       = { 0, static_cast<MPI_Aint>(nblocks)*block*extent };
+  MPI_Datatype datatypes[2]     = { blocks, rest };
+
+  MPI_Datatype large;
+  MPI_CHECK_RESULT(MPI_Type_create_struct,
+                  (2, block_lengths, offsets, datatypes, &large));
+  MPI_CHECK_RESULT(MPI_Type_commit, (&large));
+
+  MPI_CHECK_RESULT(MPI_Type_free, (&blocks));
+  MPI_CHECK_RESULT(MPI_Type_free, (&rest));
+  return large;
+}
+
+
+/// @brief Element count and datatype to hand to MPI for @p n elements.
+///
+/// With MPI-4 this is simply the count for the @c _c routines. Otherwise
+/// counts that do not fit into an @c int are sent as one element of a
+/// temporary derived datatype; it is freed when this object goes out of
+/// scope, which is safe even for pending nonblocking operations.
+class large_count
+{
+ public:
+  large_count(MPI_Datatype type, std::size_t n)
+    : m_count(static_cast<count_type>(n)), m_datatype(type)
+  {
+#ifndef MPI4CPP_HAS_LARGE_COUNT
+    if (n > static_cast<std::size_t>(MPI4CPP_MAX_COUNT)) {
+      m_count    = 1;
+      m_datatype = build_large_datatype(type, n);
+      m_derived  = true;
+    }
+#endif
+  }
+
+  ~large_count()
+  {
+    if (m_derived) MPI_Type_free(&m_datatype);
+  }
+
+  large_count(const large_count&) = delete;
+  large_count& operator=(const large_count&) = delete;
+
+  count_type   count()    const { return m_count; }
+  MPI_Datatype datatype() const { return m_datatype; }
+
+ private:
+  count_type   m_count;
+  MPI_Datatype m_datatype;
+  bool         m_derived{false};
+};
+
+
+/// @brief Call @p f(offset, count) for consecutive chunks of @p n
+/// elements whose counts fit into a @c count_type.
+///
+/// Reductions cannot describe large counts with the derived datatype
+/// of @c large_count because the built-in operations only apply to
+/// built-in datatypes; without MPI-4 they are split into several calls
+/// instead. @p f is called at least once, also for @p n = 0.
+template<class F>
+inline void for_each_chunk(std::size_t n, F f)
+{
+#ifdef MPI4CPP_HAS_LARGE_COUNT
+  f(std::size_t(0), static_cast<count_type>(n));
+#else
+  const std::size_t block = MPI4CPP_MAX_COUNT;
+  std::size_t offset = 0;
+  do {
+    std::size_t count = n - offset < block ? n - offset : block;
+    f(offset, static_cast<count_type>(count));
+    offset += count;
+  } while (offset < n);
+#endif
+}
+
+
+/// @brief Number of elements of @p type in the message described by
+/// @p stat, or an empty optional if it is not a whole number of them.
+inline std::optional<std::size_t>
+get_count(const MPI_Status& stat, MPI_Datatype type)
+{
+#ifdef MPI4CPP_HAS_LARGE_COUNT
+  MPI_Count count = 0;
+  MPI_CHECK_RESULT(MPI_Get_count_c, (&stat, type, &count));
+  if (count == MPI_UNDEFINED) return std::optional<std::size_t>();
+  return static_cast<std::size_t>(count);
+#else
+  int count = 0;
+  MPI_CHECK_RESULT(MPI_Get_count, (&stat, type, &count));
+  if (count != MPI_UNDEFINED) return static_cast<std::size_t>(count);
+
+  // The count may not fit into an int; deduce it from the byte size.
+  MPI_Count bytes = 0, size = 0;
+  MPI_CHECK_RESULT(MPI_Get_elements_x, (&stat, MPI_BYTE, &bytes));
+  MPI_CHECK_RESULT(MPI_Type_size_x,    (type, &size));
+  if (bytes == MPI_UNDEFINED || size <= 0 || bytes % size != 0
+      || bytes / size <= INT_MAX)
+    return std::optional<std::size_t>();
+  return static_cast<std::size_t>(bytes / size);
+#endif
+}
+
+
+} } } // ns mpi4cpp::mpi::detail
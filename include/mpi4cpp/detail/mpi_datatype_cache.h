@@ -3,8 +3,10 @@
 
 #pragma once
 
+#include <atomic>
 #include <type_traits>
-#include <typeinfo>
+#include <vector>
+#include <functional>
 #include <assert.h>
 
 #include "mpi4cpp/datatype_fwd.h"
@@ -14,22 +16,38 @@
 namespace mpi4cpp { namespace mpi { namespace detail {
 
 
-/// @brief comparison function object for two std::type_info pointers
+/// @brief the cached MPI data type of @c T
 ///
-/// is implemented using the before() member function of the std::type_info
-/// class
-struct type_info_compare
+/// Every type has its own slot so that a lookup is a single atomic
+/// load. Filled slots are registered in the @c mpi_datatype_map so
+/// that their datatypes can be freed.
+template<class T>
+inline std::atomic<MPI_Datatype> mpi_datatype_slot{MPI_DATATYPE_NULL};
+
+
+/// @brief key of a derived MPI data type describing a layout (e.g. 
+/// strided or subarray) of some element type
+///
+/// The layout kind and its parameters are flattened into @c shape.
+struct shape_key
 {
-  bool operator()(std::type_info const* lhs, std::type_info const* rhs) const
+  MPI_Datatype type;
+  std::vector<long> shape;
+
+  bool operator<(const shape_key& rhs) const
   {
-    return lhs->before(*rhs);
+    if (type != rhs.type) return std::less<MPI_Datatype>()(type, rhs.type);
+    return shape < rhs.shape;
   }
 };
 
 
-/// @brief a map of MPI data types, indexed by their type_info
-///
+/// @brief the cache of created MPI data types, indexed by C++ type
+/// or by shape
 ///
+/// Lookups by type are lock-free; creating a datatype, registering it
+/// and the shape lookups are serialized with a mutex, so the cache can
+/// be used from many threads at once (MPI_THREAD_MULTIPLE).
 class mpi_datatype_map
 {
   struct implementation;
@@ -71,8 +89,7 @@ public:
     //BOOST_MPL_ASSERT((is_mpi_datatype<T>));
 
     // check whether the type already exists
-    std::type_info const* t = &typeid(T);
-    MPI_Datatype datatype = get(t);
+    MPI_Datatype datatype = get<T>();
 
     if (datatype == MPI_DATATYPE_NULL) {
 
@@ -82,16 +99,54 @@ public:
       // need to create a type
       //mpi_datatype_oarchive ar(x);
       //datatype = ar.get_mpi_datatype();
-      //set(t, datatype);
+      //set<T>(datatype);
     }
 
     return datatype;
   }
   
+  /// free all cached datatypes (unless MPI is already finalized)
   void clear(); 
 
-  MPI_Datatype get(const std::type_info* t);
-  void set(const std::type_info* t, MPI_Datatype datatype);
+  /// cached datatype of @c T, or @c MPI_DATATYPE_NULL
+  template<class T>
+  MPI_Datatype get() const
+  {
+    return mpi_datatype_slot<T>.load(std::memory_order_acquire);
+  }
+
+  /// cache @p datatype as the datatype of @c T
+  template<class T>
+  void set(MPI_Datatype datatype)
+  {
+    set_slot(mpi_datatype_slot<T>, datatype);
+  }
+
+  /// cached datatype of @c T; on first use it is built with the
+  /// committed datatype returned by @p create. Concurrent first calls
+  /// build it only once.
+  template<class T, class F>
+  MPI_Datatype get_or_create(F create)
+  {
+    MPI_Datatype datatype = get<T>();
+    if (datatype != MPI_DATATYPE_NULL) return datatype;
+    return create_slot(mpi_datatype_slot<T>, create);
+  }
+
+  /// cached datatype of a layout, built with @p create on first use
+  template<class F>
+  MPI_Datatype get_or_create(const shape_key& key, F create);
+
+  MPI_Datatype get(const shape_key& key);
+  void set(const shape_key& key, MPI_Datatype datatype);
+
+private:
+  using slot_type = std::atomic<MPI_Datatype>;
+
+  void set_slot(slot_type& slot, MPI_Datatype datatype);
+
+  template<class F>
+  MPI_Datatype create_slot(slot_type& slot, F create);
 };
 
 /// Retrieve the MPI datatype cache
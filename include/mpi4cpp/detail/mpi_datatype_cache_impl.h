@@ -5,16 +5,23 @@
 
 #include <mpi4cpp/detail/mpi_datatype_cache.h>
 #include <map>
+#include <mutex>
+#include <vector>
 #include <cassert>
 
 namespace mpi4cpp { namespace mpi { namespace detail {
 
-typedef std::map<std::type_info const*,MPI_Datatype,type_info_compare>
-    stored_map_type;
+typedef std::map<shape_key,MPI_Datatype> stored_shape_map_type;
 
 struct mpi_datatype_map::implementation
 {
-  stored_map_type map;
+  // recursive, as creating a struct datatype looks up its members
+  std::recursive_mutex mutex;
+
+  // slots of all types that have a datatype
+  std::vector<slot_type*> slots;
+
+  stored_shape_map_type shapes;
 };
 
 inline mpi_datatype_map::mpi_datatype_map()
@@ -24,15 +31,24 @@ inline mpi_datatype_map::mpi_datatype_map()
 
 inline void mpi_datatype_map::clear()
 {
+  std::lock_guard<std::recursive_mutex> lock(impl->mutex);
+
   // do not free after call to MPI_FInalize
   int finalized=0;
   MPI_CHECK_RESULT(MPI_Finalized,(&finalized));
-    
-  if (finalized == 0) {
+
+  for (auto slot : impl->slots) {
+    MPI_Datatype datatype = slot->exchange(MPI_DATATYPE_NULL);
     // ignore errors in the destructor
-    for (auto & it : impl->map)
+    if (finalized == 0)
+      MPI_Type_free(&datatype);
+  }
+  if (finalized == 0) {
+    for (auto & it : impl->shapes)
       MPI_Type_free(&(it.second));
   }
+  impl->slots.clear();
+  impl->shapes.clear();
 }
 
 
@@ -42,18 +58,56 @@ inline mpi_datatype_map::~mpi_datatype_map()
   delete impl;
 }
 
-inline MPI_Datatype mpi_datatype_map::get(const std::type_info* t)
+inline void mpi_datatype_map::set_slot(slot_type& slot, MPI_Datatype datatype)
+{
+    std::lock_guard<std::recursive_mutex> lock(impl->mutex);
+    if (slot.load(std::memory_order_relaxed) == MPI_DATATYPE_NULL)
+        impl->slots.push_back(&slot);
+    slot.store(datatype, std::memory_order_release);
+}
+
+template<class F>
+inline MPI_Datatype mpi_datatype_map::create_slot(slot_type& slot, F create)
+{
+    std::lock_guard<std::recursive_mutex> lock(impl->mutex);
+
+    // someone else may have created it while we were waiting
+    MPI_Datatype datatype = slot.load(std::memory_order_relaxed);
+    if (datatype == MPI_DATATYPE_NULL) {
+        datatype = create();
+        impl->slots.push_back(&slot);
+        slot.store(datatype, std::memory_order_release);
+    }
+    return datatype;
+}
+
+template<class F>
+inline MPI_Datatype mpi_datatype_map::get_or_create(const shape_key& key, F create)
+{
+    std::lock_guard<std::recursive_mutex> lock(impl->mutex);
+    auto pos = impl->shapes.find(key);
+    if (pos != impl->shapes.end())
+        return pos->second;
+
+    MPI_Datatype datatype = create();
+    impl->shapes[key] = datatype;
+    return datatype;
+}
+
+inline MPI_Datatype mpi_datatype_map::get(const shape_key& key)
 {
-    auto pos = impl->map.find(t);
-    if (pos != impl->map.end())
+    std::lock_guard<std::recursive_mutex> lock(impl->mutex);
+    auto pos = impl->shapes.find(key);
+    if (pos != impl->shapes.end())
         return pos->second;
     else
         return MPI_DATATYPE_NULL;
 }
 
-inline void mpi_datatype_map::set(const std::type_info* t, MPI_Datatype datatype)
+inline void mpi_datatype_map::set(const shape_key& key, MPI_Datatype datatype)
 {
-    impl->map[t] = datatype;
+    std::lock_guard<std::recursive_mutex> lock(impl->mutex);
+    impl->shapes[key] = datatype;
 }
 
 inline mpi_datatype_map& mpi_datatype_cache()
@@ -0,0 +1,96 @@
+// Copyright 2018 - 2026, Joonas Nättilä and the hel-astro-lab contributors
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+#include "mpi4cpp/exception.h"
+
+
+namespace mpi4cpp { namespace mpi { namespace detail {
+
+
+/// @brief the cached user-defined MPI operation applying the function
+/// object type @c Op to values of type @c T
+///
+/// Like @c mpi_datatype_slot, a lookup is a single atomic load.
+template<class Op, class T>
+inline std::atomic<MPI_Op> mpi_op_slot{MPI_OP_NULL};
+
+
+/// @brief the cache of user-defined MPI operations, indexed by
+/// function object type and value type
+///
+/// The counterpart of the @c mpi_datatype_map for the operations of
+/// the reductions: each operation is created once with
+/// @c MPI_Op_create and freed by @c clear() before @c MPI_Finalize.
+class mpi_op_map
+{
+  using slot_type = std::atomic<MPI_Op>;
+
+  std::mutex mutex;
+
+  // slots of all created operations
+  std::vector<slot_type*> slots;
+
+public:
+  mpi_op_map() = default;
+  mpi_op_map(const mpi_op_map&) = delete;
+  mpi_op_map& operator=(const mpi_op_map&) = delete;
+
+  ~mpi_op_map()
+  {
+    clear();
+  }
+
+  /// cached operation for @c Op and @c T; on first use it is built
+  /// with the operation returned by @p create. Concurrent first calls
+  /// build it only once.
+  template<class Op, class T, class F>
+  MPI_Op get_or_create(F create)
+  {
+    slot_type& slot = mpi_op_slot<Op,T>;
+    MPI_Op op = slot.load(std::memory_order_acquire);
+    if (op != MPI_OP_NULL) return op;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    op = slot.load(std::memory_order_relaxed);
+    if (op == MPI_OP_NULL) {
+      op = create();
+      slots.push_back(&slot);
+      slot.store(op, std::memory_order_release);
+    }
+    return op;
+  }
+
+  /// free all cached operations (unless MPI is already finalized)
+  void clear()
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    // do not free after call to MPI_Finalize
+    int finalized=0;
+    MPI_CHECK_RESULT(MPI_Finalized,(&finalized));
+
+    for (auto slot : slots) {
+      MPI_Op op = slot->exchange(MPI_OP_NULL);
+      // ignore errors in the destructor
+      if (finalized == 0)
+        MPI_Op_free(&op);
+    }
+    slots.clear();
+  }
+};
+
+/// Retrieve the MPI operation cache
+inline mpi_op_map& mpi_op_cache()
+{
+  static mpi_op_map cache;
+  return cache;
+}
+
+
+} } } // ns mpi4cpp::mpi::detail
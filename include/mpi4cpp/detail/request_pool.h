@@ -0,0 +1,123 @@
+// Copyright 2018 - 2026, Joonas Nättilä and the hel-astro-lab contributors
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <cstddef>
+#include <new>
+
+
+namespace mpi4cpp { namespace mpi { namespace detail {
+
+
+/// @brief per-thread free list of memory blocks of @c Size bytes
+///
+/// Request state is allocated when an operation is posted and freed
+/// when the last copy of its request goes away, typically a few
+/// microseconds later; recycling the blocks keeps that out of the heap.
+/// A block freed on another thread joins that thread's list. The list
+/// keeps at most @c max_free blocks, so a burst of requests does not
+/// pin its peak memory; the rest, and the list itself when the thread
+/// exits, are returned to the heap. Blocks freed after that, e.g. by
+/// requests in static objects, go straight to the heap.
+template<std::size_t Size, std::size_t Align>
+class block_pool
+{
+  struct node { node* next; };
+
+  static constexpr std::size_t block_size = Size < sizeof(node) ? sizeof(node) : Size;
+  static constexpr std::size_t block_align = Align < alignof(node) ? alignof(node) : Align;
+
+  /// Blocks kept for reuse at most
+  static constexpr std::size_t max_free = 256;
+
+  /// Set when the pool of this thread is destroyed; being trivially
+  /// destructible it can still be read afterwards
+  static inline thread_local bool t_destroyed = false;
+
+  node* m_free{nullptr};
+  std::size_t m_count{0};
+
+  block_pool() = default;
+
+  ~block_pool()
+  {
+    t_destroyed = true;
+    while (m_free) {
+      node* next = m_free->next;
+      ::operator delete(m_free, std::align_val_t(block_align));
+      m_free = next;
+    }
+  }
+
+  static block_pool& local()
+  {
+    thread_local block_pool pool;
+    return pool;
+  }
+
+public:
+  block_pool(const block_pool&) = delete;
+  block_pool& operator=(const block_pool&) = delete;
+
+  static void* allocate()
+  {
+    if (!t_destroyed) {
+      block_pool& pool = local();
+      if (node* block = pool.m_free) {
+        pool.m_free = block->next;
+        --pool.m_count;
+        return block;
+      }
+    }
+    return ::operator new(block_size, std::align_val_t(block_align));
+  }
+
+  static void deallocate(void* p) noexcept
+  {
+    if (!t_destroyed) {
+      block_pool& pool = local();
+      if (pool.m_count < max_free) {
+        node* block = static_cast<node*>(p);
+        block->next = pool.m_free;
+        pool.m_free = block;
+        ++pool.m_count;
+        return;
+      }
+    }
+    ::operator delete(p, std::align_val_t(block_align));
+  }
+};
+
+
+/// @brief allocator drawing single objects from the @c block_pool of
+/// their size, for @c std::allocate_shared of request state
+template<class T>
+struct pool_allocator
+{
+  using value_type = T;
+
+  pool_allocator() = default;
+  template<class U> pool_allocator(const pool_allocator<U>&) noexcept {}
+
+  T* allocate(std::size_t n)
+  {
+    if (n != 1)
+      return static_cast<T*>(::operator new(n*sizeof(T), std::align_val_t(alignof(T))));
+    return static_cast<T*>(block_pool<sizeof(T), alignof(T)>::allocate());
+  }
+
+  void deallocate(T* p, std::size_t n) noexcept
+  {
+    if (n != 1)
+      ::operator delete(p, std::align_val_t(alignof(T)));
+    else
+      block_pool<sizeof(T), alignof(T)>::deallocate(p);
+  }
+
+  template<class U> bool operator==(const pool_allocator<U>&) const noexcept { return true; }
+  template<class U> bool operator!=(const pool_allocator<U>&) const noexcept { return false; }
+};
+
+
+} } } // ns mpi4cpp::mpi::detail
@@ -0,0 +1,144 @@
+// Copyright 2018 - 2026, Joonas Nättilä and the hel-astro-lab contributors
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+#include "mpi4cpp/datatype_fwd.h"
+#include "mpi4cpp/exception.h"
+#include "mpi4cpp/detail/mpi_datatype_cache.h"
+
+
+namespace mpi4cpp { namespace mpi { namespace detail {
+
+/// @brief How a struct member of type @c M maps to a block of an MPI
+/// struct datatype: @c count consecutive elements of @c datatype().
+///
+/// Arrays (@c std::array and C-style, also nested) are flattened into
+/// blocks of their element type.
+template<typename M>
+struct member_layout
+{
+  static constexpr int count = 1;
+  static MPI_Datatype datatype() { return get_mpi_datatype<M>(); }
+};
+
+template<typename E, std::size_t N>
+struct member_layout<std::array<E,N> >
+{
+  static constexpr int count = int(N)*member_layout<E>::count;
+  static MPI_Datatype datatype() { return member_layout<E>::datatype(); }
+};
+
+template<typename E, std::size_t N>
+struct member_layout<E[N]>
+{
+  static constexpr int count = int(N)*member_layout<E>::count;
+  static MPI_Datatype datatype() { return member_layout<E>::datatype(); }
+};
+
+
+/// Byte offset of a member within @p obj
+template<typename S, typename M>
+inline MPI_Aint member_offset(const S& obj, M S::* member)
+{
+  return reinterpret_cast<const char*>(&(obj.*member))
+       - reinterpret_cast<const char*>(&obj);
+}
+
+
+/// @brief Struct datatype of @c S made of the given members.
+///
+/// The datatype is built on the first call and stored in the datatype
+/// cache, which frees it before @c MPI_Finalize; later calls are a
+/// cache lookup. Its extent is resized to @c sizeof(S) so that arrays
+/// of @c S are laid out correctly even with trailing padding.
+template<typename S, typename... Ms>
+inline MPI_Datatype struct_datatype(const S& obj, Ms S::*... members)
+{
+  return mpi_datatype_cache().get_or_create<S>([&]() {
+    constexpr std::size_t n = sizeof...(Ms);
+    std::array<int, n> block_lengths{ { member_layout<Ms>::count... } };
+    std::array<MPI_Aint, n> offsets{ { member_offset(obj, members)... } };
+    std::array<MPI_Datatype, n> datatypes{ { member_layout<Ms>::datatype()... } };
+
+    MPI_Datatype packed_type, datatype;
+    MPI_CHECK_RESULT(MPI_Type_create_struct,
+        (int(n), block_lengths.data(), offsets.data(), datatypes.data(),
+         &packed_type));
+    MPI_CHECK_RESULT(MPI_Type_create_resized,
+        (packed_type, 0, MPI_Aint(sizeof(S)), &datatype));
+    MPI_CHECK_RESULT(MPI_Type_free, (&packed_type));
+    MPI_CHECK_RESULT(MPI_Type_commit, (&datatype));
+    return datatype;
+  });
+}
+
+
+} } } // ns mpi4cpp::mpi::detail
+
+
+/// INTERNAL ONLY
+/// Expand the member names m1, m2, ... into &S::m1, &S::m2, ...
+#define MPI4CPP_NARGS(...) \
+  MPI4CPP_NARGS_(__VA_ARGS__, 16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0)
+#define MPI4CPP_NARGS_(_1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, N, ...) N
+
+#define MPI4CPP_MEMBERS_1(S, m)      &S::m
+#define MPI4CPP_MEMBERS_2(S, m, ...) &S::m, MPI4CPP_MEMBERS_1(S, __VA_ARGS__)
+#define MPI4CPP_MEMBERS_3(S, m, ...) &S::m, MPI4CPP_MEMBERS_2(S, __VA_ARGS__)
+#define MPI4CPP_MEMBERS_4(S, m, ...) &S::m, MPI4CPP_MEMBERS_3(S, __VA_ARGS__)
+#define MPI4CPP_MEMBERS_5(S, m, ...) &S::m, MPI4CPP_MEMBERS_4(S, __VA_ARGS__)
+#define MPI4CPP_MEMBERS_6(S, m, ...) &S::m, MPI4CPP_MEMBERS_5(S, __VA_ARGS__)
+#define MPI4CPP_MEMBERS_7(S, m, ...) &S::m, MPI4CPP_MEMBERS_6(S, __VA_ARGS__)
+#define MPI4CPP_MEMBERS_8(S, m, ...) &S::m, MPI4CPP_MEMBERS_7(S, __VA_ARGS__)
+#define MPI4CPP_MEMBERS_9(S, m, ...) &S::m, MPI4CPP_MEMBERS_8(S, __VA_ARGS__)
+#define MPI4CPP_MEMBERS_10(S, m, ...) &S::m, MPI4CPP_MEMBERS_9(S, __VA_ARGS__)
+#define MPI4CPP_MEMBERS_11(S, m, ...) &S::m, MPI4CPP_MEMBERS_10(S, __VA_ARGS__)
+#define MPI4CPP_MEMBERS_12(S, m, ...) &S::m, MPI4CPP_MEMBERS_11(S, __VA_ARGS__)
+#define MPI4CPP_MEMBERS_13(S, m, ...) &S::m, MPI4CPP_MEMBERS_12(S, __VA_ARGS__)
+#define MPI4CPP_MEMBERS_14(S, m, ...) &S::m, MPI4CPP_MEMBERS_13(S, __VA_ARGS__)
+#define MPI4CPP_MEMBERS_15(S, m, ...) &S::m, MPI4CPP_MEMBERS_14(S, __VA_ARGS__)
+#define MPI4CPP_MEMBERS_16(S, m, ...) &S::m, MPI4CPP_MEMBERS_15(S, __VA_ARGS__)
+
+#define MPI4CPP_MEMBERS(S, ...) \
+  MPI4CPP_JOIN(MPI4CPP_MEMBERS_, MPI4CPP_NARGS(__VA_ARGS__))(S, __VA_ARGS__)
+
+
+/** @brief Introduce a struct to MPI by listing its members.
+ *
+ *  Specializes @c is_mpi_datatype and @c get_mpi_datatype for the
+ *  struct @p Type so that it can be sent like any built-in type:
+ *
+ *    @code
+ *    struct Blob {
+ *      int ivar;
+ *      float var;
+ *      std::array<double,3> x;
+ *    };
+ *    MPI4CPP_STRUCT(Blob, ivar, var, x)
+ *    @endcode
+ *
+ *  The members (up to 16) may be MPI data types, (nested) arrays of
+ *  them or other structs introduced with this macro. Members that are
+ *  left out, e.g. pointers, are not transmitted. The datatype is built
+ *  once and freed by the environment before @c MPI_Finalize.
+ *
+ *  The macro has to be used in the global namespace with the fully
+ *  qualified name of the struct.
+ */
+#define MPI4CPP_STRUCT(Type, ...)                                       \
+namespace mpi4cpp { namespace mpi {                                     \
+template<>                                                              \
+struct is_mpi_datatype< Type >                                          \
+  : mpl::true_ { };                                                     \
+                                                                        \
+template<>                                                              \
+inline MPI_Datatype                                                     \
+get_mpi_datatype< Type >(const Type& x)                                 \
+{                                                                       \
+  return detail::struct_datatype(x, MPI4CPP_MEMBERS(Type, __VA_ARGS__)); \
+}                                                                       \
+} }
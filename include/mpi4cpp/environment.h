@@ -7,6 +7,8 @@
 #include <optional>
 
 #include "mpi4cpp/detail/mpi_datatype_cache.h"
+#include "mpi4cpp/detail/mpi_op_cache.h"
+#include "mpi4cpp/detail/comm_state.h"
 
 
 namespace mpi4cpp { namespace mpi {
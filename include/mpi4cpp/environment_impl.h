@@ -27,6 +27,7 @@ inline environment::environment(bool abort_on_exception)
     i_initialized = true;
   }
   MPI_Comm_set_errhandler(MPI_COMM_WORLD, MPI_ERRORS_RETURN);
+  detail::world_comm_state()->node();
 }
 
 
@@ -43,6 +44,7 @@ inline environment::environment(int& argc, char** &argv, bool abort_on_exception
     i_initialized = true;
   }
   MPI_Comm_set_errhandler(MPI_COMM_WORLD, MPI_ERRORS_RETURN);
+  detail::world_comm_state()->node();
 }
 
 
@@ -63,6 +65,7 @@ inline environment::environment(int& argc, char** &argv, threading::level mt_lev
     i_initialized = true;
   }
   MPI_Comm_set_errhandler(MPI_COMM_WORLD, MPI_ERRORS_RETURN);
+  detail::world_comm_state()->node();
 }
 
 
@@ -73,6 +76,7 @@ inline environment::~environment()
       abort(-1);
     } else if (!finalized()) {
 
+      detail::mpi_op_cache().clear();
       detail::mpi_datatype_cache().clear();
 
       MPI_CHECK_RESULT(MPI_Finalize, ());
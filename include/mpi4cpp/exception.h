@@ -67,6 +67,39 @@ class MPI_Waitany_Error : MPIerror
   }
 };
 
+/// A matched message is not a whole number of elements of the type it
+/// is received as
+class MPI_Count_Error : public MPIerror
+{
+  public:
+  const char* what() const noexcept override
+  {
+    return "mpi4cpp: message size is not a multiple of the element size";
+  }
+};
+
+/// A count or displacement does not fit into the @c int arguments of
+/// MPI routines without MPI-4 large counts
+class MPI_Count_Overflow_Error : public MPIerror
+{
+  public:
+  const char* what() const noexcept override
+  {
+    return "mpi4cpp: count or displacement exceeds MPI4CPP_MAX_COUNT";
+  }
+};
+
+/// A communicator that is not valid for communication, e.g. the one
+/// that @c split with @c MPI_UNDEFINED returns, is queried
+class MPI_Invalid_Comm_Error : public MPIerror
+{
+  public:
+  const char* what() const noexcept override
+  {
+    return "mpi4cpp: invalid communicator (MPI_COMM_NULL)";
+  }
+};
+
 
 
 
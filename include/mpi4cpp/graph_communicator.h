@@ -0,0 +1,85 @@
+// Copyright 2018 - 2026, Joonas Nättilä and the hel-astro-lab contributors
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "communicator.h"
+
+
+namespace mpi4cpp { namespace mpi {
+
+/**
+ * @brief A communicator with a distributed graph topology, i.e. an
+ * explicit list of neighbours for every process.
+ *
+ * Every process names the processes it receives from (its
+ * @c sources()) and sends to (its @c destinations()); the graph is
+ * created with @c MPI_Dist_graph_create_adjacent. The neighbour lists
+ * define the pattern of the neighbourhood collectives (see
+ * neighborhood_collectives.h), e.g. a halo exchange with all 26
+ * neighbours of a 3D domain, which the MPI library can then schedule
+ * as a whole. The lists are stored when the communicator is created
+ * and shared by its copies.
+ */
+class graph_communicator : public communicator
+{
+ public:
+  /**
+   * Build a distributed graph over the processes of @p comm.
+   *
+   * The same process may appear several times in a list; each
+   * occurrence is a separate edge.
+   *
+   * @param comm The communicator whose processes form the graph.
+   *
+   * @param sources The ranks in @p comm of the processes that send to
+   * the calling process.
+   *
+   * @param destinations The ranks in @p comm of the processes the
+   * calling process sends to.
+   *
+   * @param reorder Whether MPI may renumber the processes. Disabled
+   * by default since the neighbour lists are usually derived from the
+   * ranks in @p comm; @c sources() and @c destinations() always hold
+   * the ranks in the new communicator.
+   */
+  graph_communicator(const communicator& comm,
+                     const std::vector<int>& sources,
+                     const std::vector<int>& destinations,
+                     bool reorder = false);
+
+  /**
+   * Ranks of the processes that send to the calling process, in the
+   * order of the received blocks of the neighbourhood collectives.
+   */
+  const std::vector<int>& sources() const { return m_graph->sources; }
+
+  /**
+   * Ranks of the processes the calling process sends to, in the order
+   * of the sent blocks of the neighbourhood collectives.
+   */
+  const std::vector<int>& destinations() const { return m_graph->destinations; }
+
+ private:
+  /**
+   * INTERNAL ONLY
+   *
+   * Neighbour lists of the calling process, queried once per MPI
+   * communicator.
+   */
+  struct cache
+  {
+    std::vector<int> sources;
+    std::vector<int> destinations;
+  };
+
+  std::shared_ptr<const cache> m_graph;
+};
+
+
+} } // ns mpi4cpp::mpi
+
+#include "graph_communicator_impl.h"
@@ -0,0 +1,42 @@
+// Copyright 2018 - 2026, Joonas Nättilä and the hel-astro-lab contributors
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include "graph_communicator.h"
+
+
+namespace mpi4cpp { namespace mpi {
+
+
+inline
+graph_communicator::graph_communicator(const communicator& comm,
+                                       const std::vector<int>& sources,
+                                       const std::vector<int>& destinations,
+                                       bool reorder)
+{
+  MPI_Comm newcomm;
+  MPI_CHECK_RESULT(MPI_Dist_graph_create_adjacent,
+                  (MPI_Comm(comm),
+                  static_cast<int>(sources.size()), const_cast<int*>(sources.data()),
+                  MPI_UNWEIGHTED,
+                  static_cast<int>(destinations.size()), const_cast<int*>(destinations.data()),
+                  MPI_UNWEIGHTED, MPI_INFO_NULL, int(reorder), &newcomm));
+  comm_ptr = std::make_shared<detail::comm_state>(newcomm, true, true);
+
+  // the neighbours in the numbering of the new communicator
+  auto graph = std::make_shared<cache>();
+  int indegree, outdegree, weighted;
+  MPI_CHECK_RESULT(MPI_Dist_graph_neighbors_count,
+                  (newcomm, &indegree, &outdegree, &weighted));
+
+  graph->sources.resize(indegree);
+  graph->destinations.resize(outdegree);
+  MPI_CHECK_RESULT(MPI_Dist_graph_neighbors,
+                  (newcomm, indegree, graph->sources.data(), MPI_UNWEIGHTED,
+                  outdegree, graph->destinations.data(), MPI_UNWEIGHTED));
+  m_graph = graph;
+}
+
+
+} } // ns mpi4cpp::mpi
@@ -0,0 +1,122 @@
+// Copyright 2018 - 2026, Joonas Nättilä and the hel-astro-lab contributors
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "detail/mpl.h"
+#include "status.h"
+#include "request.h"
+#include "datatype.h"
+
+
+namespace mpi4cpp { namespace mpi {
+
+/**
+ *  @brief A matched message waiting to be received.
+ *
+ *  This structure is returned from @c communicator::mprobe and
+ *  @c communicator::improbe. The message has been removed from the
+ *  matching queue of the communicator, so it can only be received
+ *  through this handle (and only once), even if other threads probe or
+ *  receive with the same source and tag. Because the size of the message
+ *  is known, receiving into a @c std::vector allocates exactly once.
+ */
+class message
+{
+ public:
+  /**
+   *  Constructs a NULL message.
+   */
+  message() = default;
+
+  /**
+   *  Adopts a matched @c MPI_Message together with its probe status.
+   */
+  message(MPI_Message msg, const mpi::status& stat)
+    : m_message(msg), m_status(stat) {}
+
+  /**
+   *  Information about the matched message: its source, tag and, via
+   *  @c status::count<T>(), its size.
+   */
+  const mpi::status& status() const { return m_status; }
+
+  /**
+   *  Is there a message left to receive?
+   */
+  operator bool() const { return m_message != MPI_MESSAGE_NULL; }
+
+  /**
+   *  Receive the message into a single value, or into the elements of
+   *  a contiguous range (see @c communicator::recv).
+   */
+  template<typename T>
+  mpi::status recv(T& value);
+
+  /**
+   *  Receive the message into an array of at least @p n values.
+   */
+  template<typename T>
+  mpi::status recv(T* values, std::size_t n);
+
+  /**
+   *  Receive the message into a vector sized to fit it exactly.
+   */
+  template<typename T, class A>
+  mpi::status recv(std::vector<T,A>& values);
+
+  /**
+   *  Receive the message into a string sized to fit it exactly.
+   */
+  template<typename C, class Tr, class A>
+  mpi::status recv(std::basic_string<C,Tr,A>& values);
+
+  /**
+   *  Start receiving the message into a single value or the elements
+   *  of a contiguous range.
+   */
+  template<typename T>
+  request irecv(T& value);
+
+  /**
+   *  Start receiving the message into an array of at least @p n values.
+   */
+  template<typename T>
+  request irecv(T* values, std::size_t n);
+
+  /**
+   *  Start receiving the message into a vector. The vector is resized
+   *  immediately, so the returned request is a trivial one.
+   */
+  template<typename T, class A>
+  request irecv(std::vector<T,A>& values);
+
+  /**
+   *  Start receiving the message into a string, resized immediately.
+   */
+  template<typename C, class Tr, class A>
+  request irecv(std::basic_string<C,Tr,A>& values);
+
+ private:
+
+  template<typename T>
+  mpi::status array_recv_impl(T* values, std::size_t n, mpl::true_ /*unused*/);
+
+  template<typename T>
+  request array_irecv_impl(T* values, std::size_t n, mpl::true_ /*unused*/);
+
+  /// Number of T elements in the message; throws @c MPI_Count_Error
+  /// if it is not a whole number of them
+  template<typename T>
+  std::size_t count() const;
+
+  MPI_Message m_message{MPI_MESSAGE_NULL};
+  mpi::status m_status;
+};
+
+} } // end namespace mpi4cpp::mpi
+
+#include "message_impl.h"
@@ -0,0 +1,125 @@
+// Copyright 2018 - 2026, Joonas Nättilä and the hel-astro-lab contributors
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <cassert>
+#include <optional>
+
+#include "message.h"
+#include "exception.h"
+#include "detail/large_count.h"
+#include "detail/contiguous_range.h"
+
+
+namespace mpi4cpp { namespace mpi {
+
+template<typename T>
+inline std::size_t
+message::count() const
+{
+  std::optional<std::size_t> n = m_status.count<T>();
+  if (!n) throw MPI_Count_Error();
+  return *n;
+}
+
+//--------------------------------------------------
+// blocking
+
+template<typename T>
+inline mpi::status
+message::array_recv_impl(T* values, std::size_t n, mpl::true_ /*unused*/)
+{
+  mpi::status stat;
+  detail::large_count lcount(get_mpi_datatype<T>(), n);
+  MPI_CHECK_RESULT(MPI4CPP_LARGE(MPI_Mrecv),
+                  (values, lcount.count(), lcount.datatype(),
+                  &m_message, &stat.m_status));
+  return stat;
+}
+
+template<typename T>
+inline mpi::status
+message::recv(T& value)
+{
+  if constexpr (detail::is_contiguous_range<T>::value)
+    return array_recv_impl(std::data(value), std::size(value), 
+                           is_mpi_datatype<detail::range_value_t<T>>());
+  else
+    return array_recv_impl(&value, 1, is_mpi_datatype<T>());
+}
+
+template<typename T>
+inline mpi::status
+message::recv(T* values, std::size_t n)
+{
+  return array_recv_impl(values, n, is_mpi_datatype<T>());
+}
+
+template<typename T, class A>
+inline mpi::status
+message::recv(std::vector<T,A>& values)
+{
+  values.resize( count<T>() );
+  return array_recv_impl(values.data(), values.size(), is_mpi_datatype<T>());
+}
+
+template<typename C, class Tr, class A>
+inline mpi::status
+message::recv(std::basic_string<C,Tr,A>& values)
+{
+  values.resize( count<C>() );
+  return array_recv_impl(values.data(), values.size(), is_mpi_datatype<C>());
+}
+
+//--------------------------------------------------
+// non-blocking
+
+template<typename T>
+inline request
+message::array_irecv_impl(T* values, std::size_t n, mpl::true_ /*unused*/)
+{
+  request req;
+  detail::large_count lcount(get_mpi_datatype<T>(), n);
+  MPI_CHECK_RESULT(MPI4CPP_LARGE(MPI_Imrecv),
+                  (values, lcount.count(), lcount.datatype(),
+                  &m_message, req.trivial()));
+  return req;
+}
+
+template<typename T>
+inline request
+message::irecv(T& value)
+{
+  if constexpr (detail::is_contiguous_range<T>::value)
+    return array_irecv_impl(std::data(value), std::size(value), 
+                            is_mpi_datatype<detail::range_value_t<T>>());
+  else
+    return array_irecv_impl(&value, 1, is_mpi_datatype<T>());
+}
+
+template<typename T>
+inline request
+message::irecv(T* values, std::size_t n)
+{
+  return array_irecv_impl(values, n, is_mpi_datatype<T>());
+}
+
+template<typename T, class A>
+inline request
+message::irecv(std::vector<T,A>& values)
+{
+  values.resize( count<T>() );
+  return array_irecv_impl(values.data(), values.size(), is_mpi_datatype<T>());
+}
+
+template<typename C, class Tr, class A>
+inline request
+message::irecv(std::basic_string<C,Tr,A>& values)
+{
+  values.resize( count<C>() );
+  return array_irecv_impl(values.data(), values.size(), is_mpi_datatype<C>());
+}
+
+
+} } // end namespace mpi4cpp::mpi
@@ -9,9 +9,20 @@
 // new implementations
 #include "environment.h"
 #include "communicator.h"
+#include "cartesian_communicator.h"
+#include "graph_communicator.h"
 #include "status.h"
 #include "request.h"
+#include "message.h"
+#include "persistent_request.h"
+#include "subarray.h"
 #include "nonblocking.h"
+#include "request_set.h"
+#include "progress_engine.h"
+#include "coroutine.h"
+#include "operations.h"
+#include "collectives.h"
+#include "neighborhood_collectives.h"
 
 
 
@@ -0,0 +1,244 @@
+// Copyright 2018 - 2026, Joonas Nättilä and the hel-astro-lab contributors
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <vector>
+
+#include "collectives.h"
+#include "cartesian_communicator.h"
+#include "graph_communicator.h"
+
+
+namespace mpi4cpp { namespace mpi {
+
+//--------------------------------------------------
+// neighbourhood collectives
+//
+// The neighbourhood collectives exchange data with the neighbours of
+// every process in a process topology, i.e. a @c cartesian_communicator
+// or a @c graph_communicator (the @c Topology template parameter). Each
+// process sends one block to each of its @c comm.destinations() and
+// receives one block from each of its @c comm.sources(), in the order
+// of these lists. A halo exchange is thus one call that the MPI library
+// can schedule as a whole, instead of a pair of @c isend / @c irecv per
+// neighbour.
+//
+// Blocks to and from @c proc_null neighbours (beyond the non-periodic
+// boundaries of a Cartesian grid) are not transferred; the receive
+// buffers of those blocks are left untouched.
+
+/**
+ *  @brief Gather a value from every source neighbour.
+ *
+ *  Sends @p in_value to all destinations; @c out_values[i] receives
+ *  the value of @c comm.sources()[i]. Maps to
+ *  @c MPI_Neighbor_allgather; @p out_values is resized to the number
+ *  of sources.
+ */
+template<typename Topology, typename T, typename A>
+void neighbor_all_gather(const Topology& comm, const T& in_value,
+                         std::vector<T,A>& out_values);
+
+/**
+ *  @brief Gather arrays of @p n values from every source neighbour;
+ *  @p out_values must have room for @p n elements per source.
+ */
+template<typename Topology, typename T>
+void neighbor_all_gather(const Topology& comm, const T* in_values, std::size_t n,
+                         T* out_values);
+
+/**
+ *  @brief Send a different value to every destination neighbour and
+ *  receive one from every source neighbour.
+ *
+ *  @c in_values[i] goes to @c comm.destinations()[i] and
+ *  @c out_values[i] receives the value of @c comm.sources()[i]. Maps to
+ *  @c MPI_Neighbor_alltoall; @p out_values is resized to the number of
+ *  sources.
+ */
+template<typename Topology, typename T, typename A>
+void neighbor_all_to_all(const Topology& comm, const std::vector<T,A>& in_values,
+                         std::vector<T,A>& out_values);
+
+/**
+ *  @brief Exchange arrays of @p n values with every neighbour:
+ *  @p in_values holds @p n elements per destination and @p out_values
+ *  room for @p n elements per source.
+ */
+template<typename Topology, typename T>
+void neighbor_all_to_all(const Topology& comm, const T* in_values, std::size_t n,
+                         T* out_values);
+
+/**
+ *  @brief Exchange blocks of different length with the neighbours,
+ *  e.g. the particles that moved into the halo.
+ *
+ *  @c buckets[i] goes to @c comm.destinations()[i]; the block received
+ *  from @c comm.sources()[i] is [@c out.begin(i), @c out.end(i)). Like
+ *  @c all_to_allv, the sizes are exchanged first (with an
+ *  @c MPI_Neighbor_alltoall) and the payload goes with a single
+ *  @c MPI_Neighbor_alltoallv into the reusable @p out.
+ */
+template<typename Topology, typename T, typename A, typename AA>
+void neighbor_all_to_allv(const Topology& comm,
+                          const std::vector<std::vector<T,A>,AA>& buckets,
+                          all_to_allv_buffer<T,A>& out);
+
+/**
+ *  @brief Exchange blocks of different length with the neighbours that
+ *  are already back to back in @p in_values: @c sizes[i] elements for
+ *  each destination in turn.
+ */
+template<typename Topology, typename T, typename A>
+void neighbor_all_to_allv(const Topology& comm, const std::vector<T,A>& in_values,
+                          const std::vector<std::size_t>& sizes,
+                          all_to_allv_buffer<T,A>& out);
+
+/**
+ *  @brief Exchange blocks that are described by a different datatype
+ *  for every neighbour, e.g. the faces, edges and corners of a grid
+ *  given as @c subarray views, without packing them.
+ *
+ *  @c in_blocks[i] is sent to @c comm.destinations()[i] and
+ *  @c out_blocks[i] is received from @c comm.sources()[i] with a single
+ *  @c MPI_Neighbor_alltoallw. The blocks may be datatype views or
+ *  contiguous ranges, like for @c all_to_allw.
+ *
+ *    @code
+ *    // ghost layers of a field on a 26-neighbour graph
+ *    std::vector<mpi::subarray<double,3>> send, recv;
+ *    ...
+ *    mpi::neighbor_all_to_allw(halo_graph, send, recv);
+ *    @endcode
+ */
+template<typename Topology, typename S, typename R>
+void neighbor_all_to_allw(const Topology& comm, const std::vector<S>& in_blocks,
+                          const std::vector<R>& out_blocks);
+
+
+//--------------------------------------------------
+// nonblocking neighbourhood collectives
+//
+// Like the nonblocking collectives of collectives.h: the buffers must
+// stay alive until the returned request has completed. The payload of
+// @c ineighbor_all_to_allv, which exchanges the sizes first, goes to a
+// duplicate of @p comm like that of @c iall_to_allv.
+
+/**
+ *  @brief Start gathering a value from every source neighbour; see
+ *  @c neighbor_all_gather.
+ */
+template<typename Topology, typename T, typename A>
+request ineighbor_all_gather(const Topology& comm, const T& in_value,
+                             std::vector<T,A>& out_values);
+
+/**
+ *  @brief Start gathering arrays of @p n values from every source
+ *  neighbour.
+ */
+template<typename Topology, typename T>
+request ineighbor_all_gather(const Topology& comm, const T* in_values,
+                             std::size_t n, T* out_values);
+
+/**
+ *  @brief Start exchanging one value with every neighbour; see
+ *  @c neighbor_all_to_all.
+ */
+template<typename Topology, typename T, typename A>
+request ineighbor_all_to_all(const Topology& comm, const std::vector<T,A>& in_values,
+                             std::vector<T,A>& out_values);
+
+/**
+ *  @brief Start exchanging arrays of @p n values with every neighbour.
+ */
+template<typename Topology, typename T>
+request ineighbor_all_to_all(const Topology& comm, const T* in_values,
+                             std::size_t n, T* out_values);
+
+/**
+ *  @brief Start exchanging blocks of different length with the
+ *  neighbours; see @c neighbor_all_to_allv. The buckets are staged in
+ *  @p out right away.
+ */
+template<typename Topology, typename T, typename A, typename AA>
+request ineighbor_all_to_allv(const Topology& comm,
+                              const std::vector<std::vector<T,A>,AA>& buckets,
+                              all_to_allv_buffer<T,A>& out);
+
+/**
+ *  @brief Start exchanging blocks of different length with the
+ *  neighbours that are already back to back in @p in_values; see
+ *  @c neighbor_all_to_allv.
+ */
+template<typename Topology, typename T, typename A>
+request ineighbor_all_to_allv(const Topology& comm, const std::vector<T,A>& in_values,
+                              const std::vector<std::size_t>& sizes,
+                              all_to_allv_buffer<T,A>& out);
+
+/**
+ *  @brief Start exchanging blocks that are described by a different
+ *  datatype for every neighbour; see @c neighbor_all_to_allw.
+ */
+template<typename Topology, typename S, typename R>
+request ineighbor_all_to_allw(const Topology& comm, const std::vector<S>& in_blocks,
+                              const std::vector<R>& out_blocks);
+
+
+//--------------------------------------------------
+// persistent neighbourhood collectives
+//
+// Like the persistent collectives of collectives.h: MPI-4
+// @c MPI_Neighbor_*_init calls where available, nonblocking
+// neighbourhood collectives started on every @c start() otherwise.
+
+/**
+ *  @brief Create a persistent gather of arrays of @p n values from
+ *  every source neighbour.
+ */
+template<typename Topology, typename T>
+persistent_request neighbor_all_gather_init(const Topology& comm, const T* in_values,
+                                            std::size_t n, T* out_values);
+
+/**
+ *  @brief Create a persistent exchange of arrays of @p n values with
+ *  every neighbour.
+ */
+template<typename Topology, typename T>
+persistent_request neighbor_all_to_all_init(const Topology& comm, const T* in_values,
+                                            std::size_t n, T* out_values);
+
+/**
+ *  @brief Create a persistent exchange of blocks of fixed but
+ *  different lengths with the neighbours, e.g. a fixed halo pattern
+ *  of unstructured data.
+ *
+ *  @c sizes[i] consecutive elements of @p in_values go to
+ *  @c comm.destinations()[i]. Like for @c all_to_allv_init the sizes
+ *  are exchanged once, here, with a blocking @c MPI_Neighbor_alltoall
+ *  and @p out is laid out for them; every @c start() then transfers
+ *  the current contents of @p in_values into @c out.values. @p out is
+ *  bound to the request like for @c all_to_allv_init.
+ */
+template<typename Topology, typename T, typename A>
+persistent_request neighbor_all_to_allv_init(const Topology& comm,
+                                             const std::vector<T,A>& in_values,
+                                             const std::vector<std::size_t>& sizes,
+                                             all_to_allv_buffer<T,A>& out);
+
+/**
+ *  @brief Create a persistent halo exchange of blocks described by a
+ *  different datatype for every neighbour; see @c neighbor_all_to_allw.
+ *
+ *  Every @c start() transfers the current contents of the viewed
+ *  arrays.
+ */
+template<typename Topology, typename S, typename R>
+persistent_request neighbor_all_to_allw_init(const Topology& comm,
+                                             const std::vector<S>& in_blocks,
+                                             const std::vector<R>& out_blocks);
+
+
+} } // ns mpi4cpp::mpi
+
+#include "neighborhood_collectives_impl.h"
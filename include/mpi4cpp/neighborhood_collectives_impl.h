@@ -0,0 +1,466 @@
+// Copyright 2018 - 2026, Joonas Nättilä and the hel-astro-lab contributors
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <memory>
+
+#include "neighborhood_collectives.h"
+
+
+namespace mpi4cpp { namespace mpi {
+
+namespace detail {
+  // We're exchanging arrays of a type that has an associated MPI
+  // datatype, so we map directly to that datatype.
+  template<typename T>
+  inline void
+  array_neighbor_all_gather_impl(const communicator& comm, const T* in_values,
+                                 std::size_t n, T* out_values, mpl::true_ /*unused*/)
+  {
+    large_count count(get_mpi_datatype<T>(), n);
+    MPI_CHECK_RESULT(MPI4CPP_LARGE(MPI_Neighbor_allgather),
+                    (const_cast<T*>(in_values), count.count(), count.datatype(),
+                    out_values, count.count(), count.datatype(), MPI_Comm(comm)));
+  }
+
+  template<typename T>
+  inline void
+  array_neighbor_all_to_all_impl(const communicator& comm, const T* in_values,
+                                 std::size_t n, T* out_values, mpl::true_ /*unused*/)
+  {
+    large_count count(get_mpi_datatype<T>(), n);
+    MPI_CHECK_RESULT(MPI4CPP_LARGE(MPI_Neighbor_alltoall),
+                    (const_cast<T*>(in_values), count.count(), count.datatype(),
+                    out_values, count.count(), count.datatype(), MPI_Comm(comm)));
+  }
+
+  // Copy the buckets back to back into the staging area of out
+  template<typename T, typename A, typename AA>
+  inline void
+  stage_buckets(const std::vector<std::vector<T,A>,AA>& buckets,
+                all_to_allv_buffer<T,A>& out)
+  {
+    out.m_send_sizes.resize(buckets.size());
+    std::size_t total = 0;
+    for(std::size_t i=0; i<buckets.size(); i++) {
+      out.m_send_sizes[i] = buckets[i].size();
+      total += buckets[i].size();
+    }
+
+    out.m_send.resize(total);
+    auto it = out.m_send.begin();
+    for(auto& bucket : buckets) it = std::copy(bucket.begin(), bucket.end(), it);
+  }
+
+  /// @brief state of a neighbourhood all_to_allv: the send sizes are in
+  /// @c out.m_send_sizes; the receive sizes arrive in
+  /// @c out.m_recv_sizes before the payload is posted
+  template<typename T, typename A>
+  struct neighbor_all_to_allv_data : two_step_collective
+  {
+    neighbor_all_to_allv_data(const communicator& comm, std::size_t indegree,
+                              const T* in_values, all_to_allv_buffer<T,A>& out)
+      : comm(comm), indegree(indegree), in_values(in_values), out(out)
+    { }
+
+    // sizes from proc_null neighbours are never written
+    void prepare_sizes()
+    {
+      out.m_recv_sizes.assign(indegree, 0);
+    }
+
+    void post_sizes(MPI_Request* req)
+    {
+      prepare_sizes();
+      MPI_Datatype size_type = get_mpi_datatype<std::size_t>();
+      MPI_CHECK_RESULT(MPI_Ineighbor_alltoall,
+                      (out.m_send_sizes.data(), 1, size_type,
+                      out.m_recv_sizes.data(), 1, size_type, MPI_Comm(comm), req));
+    }
+
+    void exchange_sizes()
+    {
+      prepare_sizes();
+      MPI_Datatype size_type = get_mpi_datatype<std::size_t>();
+      MPI_CHECK_RESULT(MPI_Neighbor_alltoall,
+                      (out.m_send_sizes.data(), 1, size_type,
+                      out.m_recv_sizes.data(), 1, size_type, MPI_Comm(comm)));
+    }
+
+    void layout()
+    {
+      out.m_send_layout.assign(out.m_send_sizes.data(), out.m_send_sizes.size());
+      out.values.resize(out.m_recv_layout.assign(out.m_recv_sizes.data(), indegree));
+      out.m_recv_layout.offsets(out.offsets);
+    }
+
+    // blocking variants: all processes throw if any layout overflows
+    void agreed_layout()
+    {
+      detail::agreed_layout(comm, [this] { layout(); });
+    }
+
+    // the duplicate of a topology communicator has the same neighbours
+    void post_payload(MPI_Comm payload_comm, MPI_Request* req) override
+    {
+      layout();
+      MPI_Datatype type = get_mpi_datatype<T>();
+      MPI_CHECK_RESULT(MPI4CPP_LARGE(MPI_Ineighbor_alltoallv),
+                      (const_cast<T*>(in_values),
+                      out.m_send_layout.counts.data(), out.m_send_layout.displs.data(),
+                      type, out.values.data(),
+                      out.m_recv_layout.counts.data(), out.m_recv_layout.displs.data(),
+                      type, payload_comm, req));
+    }
+
+    void exchange_payload()
+    {
+      agreed_layout();
+      MPI_Datatype type = get_mpi_datatype<T>();
+      MPI_CHECK_RESULT(MPI4CPP_LARGE(MPI_Neighbor_alltoallv),
+                      (const_cast<T*>(in_values),
+                      out.m_send_layout.counts.data(), out.m_send_layout.displs.data(),
+                      type, out.values.data(),
+                      out.m_recv_layout.counts.data(), out.m_recv_layout.displs.data(),
+                      type, MPI_Comm(comm)));
+    }
+
+    communicator comm;
+    std::size_t indegree;
+    const T* in_values;
+    all_to_allv_buffer<T,A>& out;
+  };
+
+  /// @brief counts, byte displacements and datatypes of the blocks of
+  /// a neighbourhood all_to_allw; MPI reads them until the operation
+  /// has completed
+  struct neighbor_all_to_allw_data
+  {
+    template<typename S, typename R>
+    neighbor_all_to_allw_data(const std::vector<S>& in_blocks,
+                              const std::vector<R>& out_blocks)
+    {
+      send_base = alltoallw_blocks(in_blocks, send_counts, send_displs, send_types);
+      recv_base = alltoallw_blocks(out_blocks, recv_counts, recv_displs, recv_types);
+    }
+
+    std::vector<count_type> send_counts, recv_counts;
+    std::vector<MPI_Aint> send_displs, recv_displs;
+    std::vector<MPI_Datatype> send_types, recv_types;
+    void* send_base;
+    void* recv_base;
+  };
+}
+
+template<typename Topology, typename T, typename A>
+inline void
+neighbor_all_gather(const Topology& comm, const T& in_value,
+                    std::vector<T,A>& out_values)
+{
+  out_values.resize(comm.sources().size());
+  detail::array_neighbor_all_gather_impl(comm, &in_value, 1, out_values.data(),
+                                         is_mpi_datatype<T>());
+}
+
+template<typename Topology, typename T>
+inline void
+neighbor_all_gather(const Topology& comm, const T* in_values, std::size_t n,
+                    T* out_values)
+{
+  detail::array_neighbor_all_gather_impl(comm, in_values, n, out_values,
+                                         is_mpi_datatype<T>());
+}
+
+template<typename Topology, typename T, typename A>
+inline void
+neighbor_all_to_all(const Topology& comm, const std::vector<T,A>& in_values,
+                    std::vector<T,A>& out_values)
+{
+  assert(in_values.size() == comm.destinations().size());
+  out_values.resize(comm.sources().size());
+  detail::array_neighbor_all_to_all_impl(comm, in_values.data(), 1, out_values.data(),
+                                         is_mpi_datatype<T>());
+}
+
+template<typename Topology, typename T>
+inline void
+neighbor_all_to_all(const Topology& comm, const T* in_values, std::size_t n,
+                    T* out_values)
+{
+  detail::array_neighbor_all_to_all_impl(comm, in_values, n, out_values,
+                                         is_mpi_datatype<T>());
+}
+
+template<typename Topology, typename T, typename A, typename AA>
+inline void
+neighbor_all_to_allv(const Topology& comm,
+                     const std::vector<std::vector<T,A>,AA>& buckets,
+                     all_to_allv_buffer<T,A>& out)
+{
+  assert(buckets.size() == comm.destinations().size());
+  detail::stage_buckets(buckets, out);
+
+  detail::neighbor_all_to_allv_data<T,A> data(comm, comm.sources().size(),
+                                              out.m_send.data(), out);
+  data.exchange_sizes();
+  data.exchange_payload();
+}
+
+template<typename Topology, typename T, typename A>
+inline void
+neighbor_all_to_allv(const Topology& comm, const std::vector<T,A>& in_values,
+                     const std::vector<std::size_t>& sizes,
+                     all_to_allv_buffer<T,A>& out)
+{
+  assert(sizes.size() == comm.destinations().size());
+  out.m_send_sizes.assign(sizes.begin(), sizes.end());
+
+  detail::neighbor_all_to_allv_data<T,A> data(comm, comm.sources().size(),
+                                              in_values.data(), out);
+  data.exchange_sizes();
+  data.exchange_payload();
+}
+
+template<typename Topology, typename S, typename R>
+inline void
+neighbor_all_to_allw(const Topology& comm, const std::vector<S>& in_blocks,
+                     const std::vector<R>& out_blocks)
+{
+  assert(in_blocks.size() == comm.destinations().size());
+  assert(out_blocks.size() == comm.sources().size());
+
+  detail::neighbor_all_to_allw_data w(in_blocks, out_blocks);
+  MPI_CHECK_RESULT(MPI4CPP_LARGE(MPI_Neighbor_alltoallw),
+                  (w.send_base, w.send_counts.data(), w.send_displs.data(), w.send_types.data(),
+                  w.recv_base, w.recv_counts.data(), w.recv_displs.data(), w.recv_types.data(),
+                  MPI_Comm(comm)));
+}
+
+
+//--------------------------------------------------
+// nonblocking
+
+template<typename Topology, typename T, typename A>
+inline request
+ineighbor_all_gather(const Topology& comm, const T& in_value,
+                     std::vector<T,A>& out_values)
+{
+  out_values.resize(comm.sources().size());
+  return ineighbor_all_gather(comm, &in_value, 1, out_values.data());
+}
+
+template<typename Topology, typename T>
+inline request
+ineighbor_all_gather(const Topology& comm, const T* in_values, std::size_t n,
+                     T* out_values)
+{
+  request req;
+  detail::large_count count(get_mpi_datatype<T>(), n);
+  MPI_CHECK_RESULT(MPI4CPP_LARGE(MPI_Ineighbor_allgather),
+                  (const_cast<T*>(in_values), count.count(), count.datatype(),
+                  out_values, count.count(), count.datatype(),
+                  MPI_Comm(comm), req.trivial()));
+  return req;
+}
+
+template<typename Topology, typename T, typename A>
+inline request
+ineighbor_all_to_all(const Topology& comm, const std::vector<T,A>& in_values,
+                     std::vector<T,A>& out_values)
+{
+  assert(in_values.size() == comm.destinations().size());
+  out_values.resize(comm.sources().size());
+  return ineighbor_all_to_all(comm, in_values.data(), 1, out_values.data());
+}
+
+template<typename Topology, typename T>
+inline request
+ineighbor_all_to_all(const Topology& comm, const T* in_values, std::size_t n,
+                     T* out_values)
+{
+  request req;
+  detail::large_count count(get_mpi_datatype<T>(), n);
+  MPI_CHECK_RESULT(MPI4CPP_LARGE(MPI_Ineighbor_alltoall),
+                  (const_cast<T*>(in_values), count.count(), count.datatype(),
+                  out_values, count.count(), count.datatype(),
+                  MPI_Comm(comm), req.trivial()));
+  return req;
+}
+
+template<typename Topology, typename T, typename A, typename AA>
+inline request
+ineighbor_all_to_allv(const Topology& comm,
+                      const std::vector<std::vector<T,A>,AA>& buckets,
+                      all_to_allv_buffer<T,A>& out)
+{
+  assert(buckets.size() == comm.destinations().size());
+  detail::stage_buckets(buckets, out);
+
+  using data_t = detail::neighbor_all_to_allv_data<T,A>;
+  return request(std::make_shared<data_t>(comm, comm.sources().size(),
+                                          out.m_send.data(), out));
+}
+
+template<typename Topology, typename T, typename A>
+inline request
+ineighbor_all_to_allv(const Topology& comm, const std::vector<T,A>& in_values,
+                      const std::vector<std::size_t>& sizes,
+                      all_to_allv_buffer<T,A>& out)
+{
+  assert(sizes.size() == comm.destinations().size());
+  out.m_send_sizes.assign(sizes.begin(), sizes.end());
+
+  using data_t = detail::neighbor_all_to_allv_data<T,A>;
+  return request(std::make_shared<data_t>(comm, comm.sources().size(),
+                                          in_values.data(), out));
+}
+
+template<typename Topology, typename S, typename R>
+inline request
+ineighbor_all_to_allw(const Topology& comm, const std::vector<S>& in_blocks,
+                      const std::vector<R>& out_blocks)
+{
+  assert(in_blocks.size() == comm.destinations().size());
+  assert(out_blocks.size() == comm.sources().size());
+
+  auto w = std::make_shared<detail::neighbor_all_to_allw_data>(in_blocks, out_blocks);
+  request req;
+  MPI_CHECK_RESULT(MPI4CPP_LARGE(MPI_Ineighbor_alltoallw),
+                  (w->send_base, w->send_counts.data(), w->send_displs.data(),
+                  w->send_types.data(),
+                  w->recv_base, w->recv_counts.data(), w->recv_displs.data(),
+                  w->recv_types.data(), MPI_Comm(comm), req.trivial()));
+  req.set_data(w);
+  return req;
+}
+
+
+//--------------------------------------------------
+// persistent
+
+template<typename Topology, typename T>
+inline persistent_request
+neighbor_all_gather_init(const Topology& comm, const T* in_values, std::size_t n,
+                         T* out_values)
+{
+  T* in                    = const_cast<T*>(in_values);
+  detail::count_type count = detail::checked_count(n);
+  MPI_Datatype type        = get_mpi_datatype<T>();
+
+#ifdef MPI4CPP_HAS_PERSISTENT_COLLECTIVES
+  MPI_Request req;
+  MPI_CHECK_RESULT(MPI4CPP_LARGE(MPI_Neighbor_allgather_init),
+                  (in, count, type, out_values, count, type,
+                  MPI_Comm(comm), MPI_INFO_NULL, &req));
+  return persistent_request(req);
+#else
+  communicator c = comm;
+  return persistent_request([=](MPI_Request* req) {
+    MPI_CHECK_RESULT(MPI_Ineighbor_allgather,
+                    (in, count, type, out_values, count, type, MPI_Comm(c), req));
+  });
+#endif
+}
+
+template<typename Topology, typename T>
+inline persistent_request
+neighbor_all_to_all_init(const Topology& comm, const T* in_values, std::size_t n,
+                         T* out_values)
+{
+  T* in                    = const_cast<T*>(in_values);
+  detail::count_type count = detail::checked_count(n);
+  MPI_Datatype type        = get_mpi_datatype<T>();
+
+#ifdef MPI4CPP_HAS_PERSISTENT_COLLECTIVES
+  MPI_Request req;
+  MPI_CHECK_RESULT(MPI4CPP_LARGE(MPI_Neighbor_alltoall_init),
+                  (in, count, type, out_values, count, type,
+                  MPI_Comm(comm), MPI_INFO_NULL, &req));
+  return persistent_request(req);
+#else
+  communicator c = comm;
+  return persistent_request([=](MPI_Request* req) {
+    MPI_CHECK_RESULT(MPI_Ineighbor_alltoall,
+                    (in, count, type, out_values, count, type, MPI_Comm(c), req));
+  });
+#endif
+}
+
+template<typename Topology, typename T, typename A>
+inline persistent_request
+neighbor_all_to_allv_init(const Topology& comm, const std::vector<T,A>& in_values,
+                          const std::vector<std::size_t>& sizes,
+                          all_to_allv_buffer<T,A>& out)
+{
+  assert(sizes.size() == comm.destinations().size());
+
+  // the layout is fixed from here on
+  out.m_send_sizes.assign(sizes.begin(), sizes.end());
+  detail::neighbor_all_to_allv_data<T,A> data(comm, comm.sources().size(),
+                                              in_values.data(), out);
+  data.exchange_sizes();
+  data.agreed_layout();
+
+  auto layout = std::make_shared<detail::persistent_alltoallv_layout>(
+                   out.m_send_layout, out.m_recv_layout);
+  T* in                    = const_cast<T*>(in_values.data());
+  T* recv                  = out.values.data();
+  MPI_Datatype type        = get_mpi_datatype<T>();
+
+#ifdef MPI4CPP_HAS_PERSISTENT_COLLECTIVES
+  MPI_Request req;
+  MPI_CHECK_RESULT(MPI4CPP_LARGE(MPI_Neighbor_alltoallv_init),
+                  (in, layout->send.counts.data(), layout->send.displs.data(), type,
+                  recv, layout->recv.counts.data(), layout->recv.displs.data(), type,
+                  MPI_Comm(comm), MPI_INFO_NULL, &req));
+  persistent_request preq(req);
+  preq.set_data(layout);
+  return preq;
+#else
+  communicator c = comm;
+  return persistent_request([=](MPI_Request* req) {
+    MPI_CHECK_RESULT(MPI_Ineighbor_alltoallv,
+                    (in, layout->send.counts.data(), layout->send.displs.data(), type,
+                    recv, layout->recv.counts.data(), layout->recv.displs.data(), type,
+                    MPI_Comm(c), req));
+  });
+#endif
+}
+
+template<typename Topology, typename S, typename R>
+inline persistent_request
+neighbor_all_to_allw_init(const Topology& comm, const std::vector<S>& in_blocks,
+                          const std::vector<R>& out_blocks)
+{
+  assert(in_blocks.size() == comm.destinations().size());
+  assert(out_blocks.size() == comm.sources().size());
+
+  auto w = std::make_shared<detail::neighbor_all_to_allw_data>(in_blocks, out_blocks);
+
+#ifdef MPI4CPP_HAS_PERSISTENT_COLLECTIVES
+  MPI_Request req;
+  MPI_CHECK_RESULT(MPI4CPP_LARGE(MPI_Neighbor_alltoallw_init),
+                  (w->send_base, w->send_counts.data(), w->send_displs.data(),
+                  w->send_types.data(),
+                  w->recv_base, w->recv_counts.data(), w->recv_displs.data(),
+                  w->recv_types.data(), MPI_Comm(comm), MPI_INFO_NULL, &req));
+  persistent_request preq(req);
+  preq.set_data(w);
+  return preq;
+#else
+  communicator c = comm;
+  return persistent_request([=](MPI_Request* req) {
+    MPI_CHECK_RESULT(MPI_Ineighbor_alltoallw,
+                    (w->send_base, w->send_counts.data(), w->send_displs.data(),
+                    w->send_types.data(),
+                    w->recv_base, w->recv_counts.data(), w->recv_displs.data(),
+                    w->recv_types.data(), MPI_Comm(c), req));
+  });
+#endif
+}
+
+
+} } // ns mpi4cpp::mpi
@@ -97,9 +97,11 @@ wait_any(ForwardIterator first, ForwardIterator last)
           //MPI_ERR_REQUEST;
 
         // Find the iterator corresponding to the completed request.
+        // Completed requests become null; persistent requests keep
+        // their handle elsewhere.
         current = first;
         advance(current, index);
-        *current->trivial() = requests[index];
+        *current->trivial() = MPI_REQUEST_NULL;
         return std::make_pair(stat, current);
       }
 
@@ -222,6 +224,10 @@ wait_all(ForwardIterator first, ForwardIterator last, OutputIterator out)
                        (num_outstanding_requests, &requests[0], 
                        &stats[0]));
 
+      // Completed requests become null
+      for (ForwardIterator current = first; current != last; ++current)
+        *current->trivial() = MPI_REQUEST_NULL;
+
       for (auto i = stats.begin(); 
            i != stats.end(); ++i, ++out) {
         status stat;
@@ -288,6 +294,10 @@ wait_all(ForwardIterator first, ForwardIterator last)
                        (num_outstanding_requests, &requests[0], 
                        MPI_STATUSES_IGNORE));
 
+      // Completed requests become null
+      for (ForwardIterator current = first; current != last; ++current)
+        *current->trivial() = MPI_REQUEST_NULL;
+
       // Signal completion
       num_outstanding_requests = 0;
     }
@@ -330,13 +340,13 @@ std::optional<OutputIterator>
 test_all(ForwardIterator first, ForwardIterator last, OutputIterator out)
 {
   std::vector<MPI_Request> requests;
-  for (; first != last; ++first) {
+  for (ForwardIterator current = first; current != last; ++current) {
     // If we have a non-trivial request, then no requests can be
     // completed.
-    if (!first->trivial()) {
+    if (!current->trivial()) {
       return std::optional<OutputIterator>();
     }
-    requests.push_back(*first->trivial());
+    requests.push_back(*current->trivial());
   }
 
   int flag = 0;
@@ -344,6 +354,10 @@ test_all(ForwardIterator first, ForwardIterator last, OutputIterator out)
   std::vector<MPI_Status> stats(n);
   MPI_CHECK_RESULT(MPI_Testall, (n, &requests[0], &flag, &stats[0]));
   if (flag) {
+    // Completed requests become null
+    for (; first != last; ++first)
+      *first->trivial() = MPI_REQUEST_NULL;
+
     for (int i = 0; i < n; ++i, ++out) {
       status stat;
       stat.m_status = stats[i];
@@ -363,19 +377,24 @@ bool
 test_all(ForwardIterator first, ForwardIterator last)
 {
   std::vector<MPI_Request> requests;
-  for (; first != last; ++first) {
+  for (ForwardIterator current = first; current != last; ++current) {
     // If we have a non-trivial request, then no requests can be
     // completed.
-    if (!first->trivial()) {
+    if (!current->trivial()) {
       return false;
     }
-    requests.push_back(*first->trivial());
+    requests.push_back(*current->trivial());
   }
 
   int flag = 0;
   int n = requests.size();
   MPI_CHECK_RESULT(MPI_Testall, 
                          (n, &requests[0], &flag, MPI_STATUSES_IGNORE));
+  if (flag) {
+    // Completed requests become null
+    for (; first != last; ++first)
+      *first->trivial() = MPI_REQUEST_NULL;
+  }
   return flag != 0;
 }
 
@@ -499,7 +518,7 @@ wait_some(BidirectionalIterator first, BidirectionalIterator last,
 
           // Finish up the request and swap it into the "completed
           // requests" partition.
-          *current->trivial() = requests[indices[index]];
+          *current->trivial() = MPI_REQUEST_NULL;
           --start_of_completed;
           iter_swap(current, start_of_completed);
         }
@@ -601,7 +620,7 @@ wait_some(BidirectionalIterator first, BidirectionalIterator last)
 
           // Finish up the request and swap it into the "completed
           // requests" partition.
-          *current->trivial() = requests[indices[index]];
+          *current->trivial() = MPI_REQUEST_NULL;
           --start_of_completed;
           iter_swap(current, start_of_completed);
         }
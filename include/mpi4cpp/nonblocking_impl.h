@@ -4,8 +4,11 @@
 #pragma once
 
 #include "request.h"
+#include "detail/request_pool.h"
 
+#include <memory>
 #include <optional>
+#include <type_traits>
 
 namespace mpi4cpp { namespace mpi {
 
@@ -56,7 +59,14 @@ template<typename T>
 inline request 
 communicator::isend(int dest, int tag, const T& value) const
 {
-  return this->isend_impl(dest, tag, value, is_mpi_datatype<T>());
+  // contiguous ranges are sent as an array of their elements
+  if constexpr (detail::is_contiguous_range<T>::value)
+    return this->array_isend_impl(dest, tag, std::data(value), std::size(value),
+                                  is_mpi_datatype<detail::range_value_t<T>>());
+  else if constexpr (detail::is_datatype_view<T>::value)
+    return this->datatype_isend_impl(dest, tag, value.base(), value.datatype());
+  else
+    return this->isend_impl(dest, tag, value, is_mpi_datatype<T>());
 }
 
 
@@ -78,7 +88,18 @@ template<typename T>
 inline request 
 communicator::irecv(int source, int tag, T& value) const
 {
-  return this->irecv_impl(source, tag, value, is_mpi_datatype<T>());
+  // contiguous ranges receive at most their current size
+  if constexpr (detail::is_contiguous_range<T>::value) {
+    static_assert(!std::is_const<std::remove_pointer_t<decltype(std::data(value))>>::value,
+                  "cannot receive into a read-only range");
+    return this->array_irecv_impl(source, tag, std::data(value), std::size(value),
+                                  is_mpi_datatype<detail::range_value_t<T>>());
+  } else if constexpr (detail::is_datatype_view<T>::value) {
+    static_assert(!std::is_const<std::remove_pointer_t<decltype(value.base())>>::value,
+                  "cannot receive into a read-only view");
+    return this->datatype_irecv_impl(source, tag, value.base(), value.datatype());
+  } else
+    return this->irecv_impl(source, tag, value, is_mpi_datatype<T>());
 }
 
 
@@ -99,14 +120,69 @@ inline request
 communicator::isend_vector(int dest, int tag, const std::vector<T,A>& values,
                            mpl::true_ /*unused*/) const
 {
-  std::size_t size = values.size();
-  request req = this->isend_impl(dest, tag, size, mpl::true_());
-  MPI_CHECK_RESULT(MPI_Isend,
-                         (const_cast<T*>(values.data()), size, 
-                          get_mpi_datatype<T>(),
-                          dest, tag, MPI_Comm(*this), &req.payload_request()));
+  // same single-message format as the blocking send_vector
+  request req;
+  detail::large_count count(get_mpi_datatype<T>(), values.size());
+  MPI_CHECK_RESULT(MPI4CPP_LARGE(MPI_Isend),
+                         (const_cast<T*>(values.data()), count.count(), 
+                          count.datatype(),
+                          dest, tag, MPI_Comm(*this), req.trivial()));
+  return req;
+}
+
+
+template<typename T, class A>
+inline request 
+communicator::isend(int dest, int tag, std::vector<T,A>&& values) const
+{
+  // move the buffer into the request so that it lives until completion
+  auto buffer = std::make_shared<std::vector<T,A> >(std::move(values));
+  request req = this->isend_vector(dest, tag, *buffer, is_mpi_datatype<T>());
+  req.set_data(buffer);
+  return req;
+}
+
+template<typename C, class Tr, class A>
+inline request 
+communicator::isend(int dest, int tag, std::basic_string<C,Tr,A>&& values) const
+{
+  auto buffer = std::make_shared<std::basic_string<C,Tr,A> >(std::move(values));
+  request req = this->array_isend_impl(dest, tag, buffer->data(), buffer->size(), 
+                                       is_mpi_datatype<C>());
+  req.set_data(buffer);
+  return req;
+}
+
+
+namespace detail {
+  /**
+   * Type-erased handle that only keeps a (possibly const) buffer alive.
+   */
+  template<typename T>
+  inline std::shared_ptr<void> keep_alive(const std::shared_ptr<T>& buffer)
+  {
+    return std::const_pointer_cast<typename std::remove_const<T>::type>(buffer);
+  }
+}
+
+template<typename T>
+inline request 
+communicator::isend(int dest, int tag, std::shared_ptr<T> value) const
+{
+  request req = this->isend(dest, tag, *value);
+  std::shared_ptr<void> buffer = detail::keep_alive(value);
+  req.set_data(buffer);
+  return req;
+}
+
+template<typename T>
+inline request 
+communicator::isend(int dest, int tag, std::shared_ptr<T> values, std::size_t n) const
+{
+  request req = this->isend(dest, tag, values.get(), n);
+  std::shared_ptr<void> buffer = detail::keep_alive(values);
+  req.set_data(buffer);
   return req;
-  
 }
 
 
@@ -115,100 +191,135 @@ namespace detail {
    * Internal data structure that stores everything required to manage
    * the receipt of an array of primitive data but unknown size.
    * Such an array can have been send with blocking operation and so must
-   * be compatible with the (size_t,raw_data[]) format.
+   * be compatible with the single message format of send_vector: the
+   * message is matched with a probe and the buffer is sized from it.
+   * It is allocated from the per-thread @c block_pool, so posting and
+   * completing such receives does not touch the heap.
    */
-  template<typename T, class A>
+  template<class Container>
   struct dynamic_array_irecv_data
   {
     //BOOST_STATIC_ASSERT_MSG(is_mpi_datatype<T>::value, "Can only be specialized for MPI datatypes.");
 
     dynamic_array_irecv_data(const communicator& comm, int source, int tag, 
-                             std::vector<T,A>& values)
-      : comm(comm), source(source), tag(tag), count(-1), values(values)
+                             Container& values)
+      : comm(comm), source(source), tag(tag), values(values)
     { 
     }
 
     communicator comm;
     int source;
     int tag;
-    std::size_t count;
-    std::vector<T,A>& values;
+    Container& values;
   };
 
 }
 
-template<typename T, class A>
+template<class Container>
 inline std::optional<status> 
 request::handle_dynamic_primitive_array_irecv(request* self, request_action action)
 {
-  typedef detail::dynamic_array_irecv_data<T,A> data_t;
-  std::shared_ptr<data_t> data = std::static_pointer_cast<data_t>(self->m_data);
+  typedef detail::dynamic_array_irecv_data<Container> data_t;
+  data_t* data = static_cast<data_t*>(self->m_data.get());
 
   if (action == ra_wait) {
     status stat;
-    if (self->m_requests[1] == MPI_REQUEST_NULL) {
-      // Wait for the count message to complete
-      MPI_CHECK_RESULT(MPI_Wait, (self->m_requests, &stat.m_status));
-      // Resize our buffer and get ready to receive its data
-      data->values.resize(data->count);
-      MPI_CHECK_RESULT(MPI_Irecv,
-                             (&(data->values[0]), data->values.size(), get_mpi_datatype<T>(),
-                              stat.source(), stat.tag(), 
-                              MPI_Comm(data->comm), self->m_requests + 1));
+    if (self->m_requests[0] == MPI_REQUEST_NULL) {
+      // Wait until a message is matched, then size our buffer and
+      // receive it
+      message msg = data->comm.mprobe(data->source, data->tag);
+      self->m_requests[0] = *msg.irecv(data->values).trivial();
     }
     // Wait until we have received the entire message
-    MPI_CHECK_RESULT(MPI_Wait, (self->m_requests + 1, &stat.m_status));
+    MPI_CHECK_RESULT(MPI_Wait, (self->m_requests, &stat.m_status));
     return stat;
   } else if (action == ra_test) {
     status stat;
     int flag = 0;
 
-    if (self->m_requests[1] == MPI_REQUEST_NULL) {
-      // Check if the count message has completed
-      MPI_CHECK_RESULT(MPI_Test, (self->m_requests, &flag, &stat.m_status));
-      if (flag) {
-        // Resize our buffer and get ready to receive its data
-        data->values.resize(data->count);
-
-        //std::cout << "sending " << data->values.size() << " " << data->values[0] << "\n";
-        //int dsize = data->values.size();
-        MPI_CHECK_RESULT(MPI_Irecv,
-                               (data->values.data(), //&(data->values[0]), 
-                                data->count, //dsize, //data->values.size(), 
-                                get_mpi_datatype<T>(), //MPI_PACKED,
-                                stat.source(), 
-                                stat.tag(), 
-                                MPI_Comm(data->comm), 
-                                self->m_requests + 1));
-
+    if (self->m_requests[0] == MPI_REQUEST_NULL) {
+      // Check if a matching message has arrived
+      if (std::optional<message> msg = data->comm.improbe(data->source, data->tag)) {
+        self->m_requests[0] = *msg->irecv(data->values).trivial();
       } else
         return std::optional<status>(); // We have not finished yet
     } 
 
     // Check if we have received the message data
-    MPI_CHECK_RESULT(MPI_Test, (self->m_requests + 1, &flag, &stat.m_status));
+    MPI_CHECK_RESULT(MPI_Test, (self->m_requests, &flag, &stat.m_status));
     if (flag) {
       return stat;
     } else 
       return std::optional<status>();
   } else {
+    // Only a matched message has something to cancel
+    if (self->m_requests[0] != MPI_REQUEST_NULL)
+    {
+      MPI_CHECK_RESULT(MPI_Cancel, (self->m_requests));
+    }
     return std::optional<status>();
   }
 }
 
 
-template<typename T, class A>
-inline request::request(communicator const& comm, int source, int tag, std::vector<T,A>& values, mpl::true_ /*primitive*/)
-  : m_data(new detail::dynamic_array_irecv_data<T,A>(comm, source, tag, values)),
-    m_handler(handle_dynamic_primitive_array_irecv<T,A>)
+template<class Container>
+inline request::request(communicator const& comm, int source, int tag, Container& values, mpl::true_ /*primitive*/)
+  : m_data(std::allocate_shared<detail::dynamic_array_irecv_data<Container>>(
+             detail::pool_allocator<detail::dynamic_array_irecv_data<Container>>(),
+             comm, source, tag, values)),
+    m_handler(handle_dynamic_primitive_array_irecv<Container>)
 {
   m_requests[0] = MPI_REQUEST_NULL;
   m_requests[1] = MPI_REQUEST_NULL;
-  std::size_t& count = data<detail::dynamic_array_irecv_data<T,A> >()->count;
-  MPI_CHECK_RESULT(MPI_Irecv,
-                         (&count, 1, 
-                          get_mpi_datatype(count),
-                          source, tag, comm, &size_request()));
+
+  // Match a message that has already arrived right away, so receives
+  // posted one after the other match in posting order. Otherwise the
+  // message is matched when the request is first tested or waited on.
+  if (std::optional<message> msg = comm.improbe(source, tag))
+    m_requests[0] = *msg->irecv(values).trivial();
+}
+
+
+template<class Data>
+inline std::optional<status> 
+request::handle_two_step_collective(request* self, request_action action)
+{
+  Data* data = static_cast<Data*>(self->m_data.get());
+  detail::comm_state& state = *data->comm.comm_ptr;
+
+  // The payloads of all two step collectives on the communicator are
+  // posted in the order they were started, so this may post those of
+  // earlier requests first.
+  if (action == ra_wait) {
+    status stat;
+    state.post_payloads(data, true);
+    MPI_CHECK_RESULT(MPI_Wait, (&data->payload, &stat.m_status));
+    return stat;
+  } else if (action == ra_test) {
+    status stat;
+    int flag = 0;
+    if (!state.post_payloads(data, false))
+      return std::optional<status>(); // sizes still in flight
+    MPI_CHECK_RESULT(MPI_Test, (&data->payload, &flag, &stat.m_status));
+    if (flag) {
+      return stat;
+    } else
+      return std::optional<status>();
+  } else {
+    // Collective operations cannot be cancelled
+    return std::optional<status>();
+  }
+}
+
+template<class Data>
+inline request::request(std::shared_ptr<Data> data)
+  : m_data(data),
+    m_handler(handle_two_step_collective<Data>)
+{
+  m_requests[0] = MPI_REQUEST_NULL;
+  m_requests[1] = MPI_REQUEST_NULL;
+  data->post_sizes(&data->sizes);
+  data->comm.comm_ptr->start_two_step(data);
 }
 
 
@@ -228,19 +339,35 @@ communicator::irecv(int source, int tag, std::vector<T,A>& values) const
   return irecv_vector(source, tag, values, is_mpi_datatype<T>());
 }
 
+template<typename R, typename>
+inline request
+communicator::irecv(int source, int tag, R&& values) const
+{
+  return this->irecv(source, tag, values);
+}
+
+// strings are resized on receipt just like vectors
+template<typename C, class Tr, class A>
+inline request
+communicator::irecv(int source, int tag, std::basic_string<C,Tr,A>& values) const
+{
+  return request(*this, source, tag, values, is_mpi_datatype<C>());
+}
+
 
 //--------------------------------------------------
 // send/recv array
   
 template<typename T>
 inline request
-communicator::array_isend_impl(int dest, int tag, const T* values, int n,
+communicator::array_isend_impl(int dest, int tag, const T* values, std::size_t n,
                                mpl::true_ /*unused*/) const
 {
   request req;
-  MPI_CHECK_RESULT(MPI_Isend,
-                         (const_cast<T*>(values), n, 
-                          get_mpi_datatype<T>(*values),
+  detail::large_count count(get_mpi_datatype<T>(), n);
+  MPI_CHECK_RESULT(MPI4CPP_LARGE(MPI_Isend),
+                         (const_cast<T*>(values), count.count(), 
+                          count.datatype(),
                           dest, tag, MPI_Comm(*this), req.trivial()));
   return req;
 }
@@ -248,7 +375,7 @@ communicator::array_isend_impl(int dest, int tag, const T* values, int n,
 // Array isend must send the elements directly
 template<typename T>
 inline request 
-communicator::isend(int dest, int tag, const T* values, int n) const
+communicator::isend(int dest, int tag, const T* values, std::size_t n) const
 {
   return array_isend_impl(dest, tag, values, n, is_mpi_datatype<T>());
 }
@@ -256,13 +383,14 @@ communicator::isend(int dest, int tag, const T* values, int n) const
 
 template<typename T>
 inline request 
-communicator::array_irecv_impl(int source, int tag, T* values, int n, 
+communicator::array_irecv_impl(int source, int tag, T* values, std::size_t n, 
                                mpl::true_ /*unused*/) const
 {
   request req;
-  MPI_CHECK_RESULT(MPI_Irecv,
-                         (const_cast<T*>(values), n, 
-                          get_mpi_datatype<T>(*values),
+  detail::large_count count(get_mpi_datatype<T>(), n);
+  MPI_CHECK_RESULT(MPI4CPP_LARGE(MPI_Irecv),
+                         (values, count.count(), 
+                          count.datatype(),
                           source, tag, MPI_Comm(*this), &req.size_request()));
   return req;
 }
@@ -270,7 +398,7 @@ communicator::array_irecv_impl(int source, int tag, T* values, int n,
 // Array receive must receive the elements directly into a buffer.
 template<typename T>
 inline request 
-communicator::irecv(int source, int tag, T* values, int n) const
+communicator::irecv(int source, int tag, T* values, std::size_t n) const
 {
   return this->array_irecv_impl(source, tag, values, n, is_mpi_datatype<T>());
 }
@@ -278,4 +406,119 @@ communicator::irecv(int source, int tag, T* values, int n) const
 
 
 
+//--------------------------------------------------
+// send/recv views with a derived datatype
+
+inline request
+communicator::datatype_isend_impl(int dest, int tag, const void* base, 
+                                  MPI_Datatype type) const
+{
+  request req;
+  MPI_CHECK_RESULT(MPI_Isend,
+                         (const_cast<void*>(base), 1, type,
+                          dest, tag, MPI_Comm(*this), req.trivial()));
+  return req;
+}
+
+inline request
+communicator::datatype_irecv_impl(int source, int tag, void* base, 
+                                  MPI_Datatype type) const
+{
+  request req;
+  MPI_CHECK_RESULT(MPI_Irecv,
+                         (base, 1, type,
+                          source, tag, MPI_Comm(*this), req.trivial()));
+  return req;
+}
+
+
+//--------------------------------------------------
+// persistent send/recv
+
+template<typename T>
+inline persistent_request
+communicator::array_send_init_impl(int dest, int tag, const T* values, std::size_t n,
+                                   mpl::true_ /*unused*/) const
+{
+  MPI_Request req;
+  detail::large_count count(get_mpi_datatype<T>(), n);
+  MPI_CHECK_RESULT(MPI4CPP_LARGE(MPI_Send_init),
+                         (const_cast<T*>(values), count.count(), 
+                          count.datatype(),
+                          dest, tag, MPI_Comm(*this), &req));
+  return persistent_request(req);
+}
+
+template<typename T>
+inline persistent_request
+communicator::array_recv_init_impl(int source, int tag, T* values, std::size_t n,
+                                   mpl::true_ /*unused*/) const
+{
+  MPI_Request req;
+  detail::large_count count(get_mpi_datatype<T>(), n);
+  MPI_CHECK_RESULT(MPI4CPP_LARGE(MPI_Recv_init),
+                         (values, count.count(), 
+                          count.datatype(),
+                          source, tag, MPI_Comm(*this), &req));
+  return persistent_request(req);
+}
+
+inline persistent_request
+communicator::datatype_send_init_impl(int dest, int tag, const void* base,
+                                      MPI_Datatype type) const
+{
+  MPI_Request req;
+  MPI_CHECK_RESULT(MPI_Send_init,
+                         (const_cast<void*>(base), 1, type,
+                          dest, tag, MPI_Comm(*this), &req));
+  return persistent_request(req);
+}
+
+inline persistent_request
+communicator::datatype_recv_init_impl(int source, int tag, void* base,
+                                      MPI_Datatype type) const
+{
+  MPI_Request req;
+  MPI_CHECK_RESULT(MPI_Recv_init,
+                         (base, 1, type,
+                          source, tag, MPI_Comm(*this), &req));
+  return persistent_request(req);
+}
+
+template<typename T>
+inline persistent_request
+communicator::send_init(int dest, int tag, const T& value) const
+{
+  if constexpr (detail::is_datatype_view<T>::value)
+    return this->datatype_send_init_impl(dest, tag, value.base(), value.datatype());
+  else
+    return this->array_send_init_impl(dest, tag, &value, 1, is_mpi_datatype<T>());
+}
+
+template<typename T>
+inline persistent_request
+communicator::send_init(int dest, int tag, const T* values, std::size_t n) const
+{
+  return this->array_send_init_impl(dest, tag, values, n, is_mpi_datatype<T>());
+}
+
+template<typename T>
+inline persistent_request
+communicator::recv_init(int source, int tag, T& value) const
+{
+  if constexpr (detail::is_datatype_view<T>::value)
+    return this->datatype_recv_init_impl(source, tag, value.base(), value.datatype());
+  else
+    return this->array_recv_init_impl(source, tag, &value, 1, is_mpi_datatype<T>());
+}
+
+template<typename T>
+inline persistent_request
+communicator::recv_init(int source, int tag, T* values, std::size_t n) const
+{
+  return this->array_recv_init_impl(source, tag, values, n, is_mpi_datatype<T>());
+}
+
+
+
 } } // ns mpi4cpp::mpi
@@ -0,0 +1,183 @@
+// Copyright 2018 - 2026, Joonas Nättilä and the hel-astro-lab contributors
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <functional>
+#include <utility>
+
+#include "detail/mpl.h"
+#include "datatype.h"
+
+
+namespace mpi4cpp { namespace mpi {
+
+/**
+ *  @brief Compute the maximum of two values.
+ *
+ *  This binary function object computes the maximum of the two values
+ *  it is given. When used with MPI and a type @c T that has an
+ *  associated, built-in MPI data type, translates to @c MPI_MAX.
+ *  @c maximum<> deduces the type of its arguments.
+ */
+template<typename T = void>
+struct maximum
+{
+  const T& operator()(const T& x, const T& y) const
+  {
+    return x < y ? y : x;
+  }
+};
+
+template<>
+struct maximum<void>
+{
+  template<typename T>
+  const T& operator()(const T& x, const T& y) const
+  {
+    return x < y ? y : x;
+  }
+};
+
+/**
+ *  @brief Compute the minimum of two values.
+ *
+ *  Translates to @c MPI_MIN for types with an associated, built-in
+ *  MPI data type.
+ */
+template<typename T = void>
+struct minimum
+{
+  const T& operator()(const T& x, const T& y) const
+  {
+    return x < y ? x : y;
+  }
+};
+
+template<>
+struct minimum<void>
+{
+  template<typename T>
+  const T& operator()(const T& x, const T& y) const
+  {
+    return x < y ? x : y;
+  }
+};
+
+/**
+ *  @brief Compute the logical exclusive OR of two values.
+ *
+ *  Translates to @c MPI_LXOR for types with an associated, built-in
+ *  MPI data type.
+ */
+template<typename T = void>
+struct logical_xor
+{
+  bool operator()(const T& x, const T& y) const
+  {
+    return bool(x) != bool(y);
+  }
+};
+
+template<>
+struct logical_xor<void>
+{
+  template<typename T>
+  bool operator()(const T& x, const T& y) const
+  {
+    return bool(x) != bool(y);
+  }
+};
+
+
+/**
+ *  @brief Determine if a function object type is a built-in MPI
+ *  operation for values of type @c T.
+ *
+ *  If it is, @c is_mpi_op<Op,T> derives @c mpl::true_ and its static
+ *  @c op() returns the @c MPI_Op. The mappings are resolved at compile
+ *  time:
+ *
+ *    - @c maximum, @c minimum: @c MPI_MAX, @c MPI_MIN
+ *    - @c std::plus, @c std::multiplies: @c MPI_SUM, @c MPI_PROD
+ *    - @c std::logical_and, @c std::logical_or, @c logical_xor:
+ *      @c MPI_LAND, @c MPI_LOR, @c MPI_LXOR
+ *    - @c std::bit_and, @c std::bit_or, @c std::bit_xor:
+ *      @c MPI_BAND, @c MPI_BOR, @c MPI_BXOR
+ *
+ *  each for the element types MPI allows with that operation, both
+ *  with an explicit type (@c std::plus<T>) and deduced
+ *  (@c std::plus<>). All other function objects are turned into a
+ *  user-defined @c MPI_Op by the reductions.
+ */
+template<typename Op, typename T>
+struct is_mpi_op
+  : mpl::false_
+{ };
+
+/**
+ *  @brief Determine if a function object type is commutative.
+ *
+ *  Built-in operations are commutative. For other function objects
+ *  MPI may only reduce in rank order; specialize this trait to derive
+ *  @c mpl::true_ if your operation is commutative so that the MPI
+ *  library is free to use faster algorithms.
+ */
+template<typename Op, typename T>
+struct is_commutative
+  : mpl::false_
+{ };
+
+
+/// INTERNAL ONLY
+#define MPI4CPP_OP(Functor, MPIOp, ...)                                 \
+template<typename T>                                                    \
+struct is_mpi_op< Functor<T>, T > : __VA_ARGS__                         \
+{ static MPI_Op op() { return MPIOp; } };                               \
+                                                                        \
+template<typename T>                                                    \
+struct is_mpi_op< Functor<void>, T > : __VA_ARGS__                      \
+{ static MPI_Op op() { return MPIOp; } };                               \
+                                                                        \
+template<typename T>                                                    \
+struct is_commutative< Functor<T>, T > : mpl::true_ { };                \
+                                                                        \
+template<typename T>                                                    \
+struct is_commutative< Functor<void>, T > : mpl::true_ { }
+
+MPI4CPP_OP(maximum, MPI_MAX,
+  mpl::or_<is_mpi_integer_datatype<T>,
+           is_mpi_floating_point_datatype<T> >);
+MPI4CPP_OP(minimum, MPI_MIN,
+  mpl::or_<is_mpi_integer_datatype<T>,
+           is_mpi_floating_point_datatype<T> >);
+MPI4CPP_OP(std::plus, MPI_SUM,
+  mpl::or_<is_mpi_integer_datatype<T>,
+           is_mpi_floating_point_datatype<T>,
+           is_mpi_complex_datatype<T> >);
+MPI4CPP_OP(std::multiplies, MPI_PROD,
+  mpl::or_<is_mpi_integer_datatype<T>,
+           is_mpi_floating_point_datatype<T>,
+           is_mpi_complex_datatype<T> >);
+MPI4CPP_OP(std::logical_and, MPI_LAND,
+  mpl::or_<is_mpi_integer_datatype<T>,
+           is_mpi_logical_datatype<T> >);
+MPI4CPP_OP(std::logical_or, MPI_LOR,
+  mpl::or_<is_mpi_integer_datatype<T>,
+           is_mpi_logical_datatype<T> >);
+MPI4CPP_OP(logical_xor, MPI_LXOR,
+  mpl::or_<is_mpi_integer_datatype<T>,
+           is_mpi_logical_datatype<T> >);
+MPI4CPP_OP(std::bit_and, MPI_BAND,
+  mpl::or_<is_mpi_integer_datatype<T>,
+           is_mpi_byte_datatype<T> >);
+MPI4CPP_OP(std::bit_or, MPI_BOR,
+  mpl::or_<is_mpi_integer_datatype<T>,
+           is_mpi_byte_datatype<T> >);
+MPI4CPP_OP(std::bit_xor, MPI_BXOR,
+  mpl::or_<is_mpi_integer_datatype<T>,
+           is_mpi_byte_datatype<T> >);
+#undef MPI4CPP_OP
+
+
+} } // ns mpi4cpp::mpi
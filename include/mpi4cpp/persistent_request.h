@@ -0,0 +1,162 @@
+// Copyright 2018 - 2026, Joonas Nättilä and the hel-astro-lab contributors
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <cassert>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "status.h"
+#include "exception.h"
+
+namespace mpi4cpp { namespace mpi {
+
+/**
+ *  @brief A persistent request for a repeated send or receive.
+ *
+ *  Persistent requests are returned from @c communicator::send_init and
+ *  @c communicator::recv_init. They bind the buffer, peer and tag of a
+ *  communication once; each @c start() then initiates the same
+ *  communication again without building it from scratch in MPI or in
+ *  the wrapper. While started, a persistent request behaves like a
+ *  trivial @c request and can be completed with @c wait(), @c test() or
+ *  the @c wait_all / @c test_some etc. helpers of nonblocking.h. Once
+ *  completed it becomes inactive and can be started again.
+ *
+ *  Copies share the underlying MPI request, which is freed when the
+ *  last copy is destroyed.
+ */
+class persistent_request
+{
+ public:
+  /**
+   *  Constructs a NULL request.
+   */
+  persistent_request() = default;
+
+  /**
+   *  Adopts an inactive persistent request created with one of the
+   *  @c MPI_*_init calls.
+   */
+  explicit persistent_request(MPI_Request req);
+
+  /**
+   *  Emulates a persistent request with a nonblocking operation: each
+   *  @c start() calls @p post to initiate it into the given request.
+   *  Used for the persistent collectives when the MPI library does not
+   *  provide the MPI-4 @c MPI_*_init collectives. Such a request must
+   *  be completed through the same copy that started it.
+   */
+  explicit persistent_request(std::function<void(MPI_Request*)> post);
+
+  /**
+   *  Initiate the communication associated with this request. The
+   *  request must not be active.
+   */
+  void start();
+
+  /**
+   *  Wait until the communication started last has completed, then
+   *  return a @c status object describing the communication.
+   */
+  status wait();
+
+  /**
+   *  Determine whether the communication started last has completed.
+   *  If so, returns the @c status object describing the communication
+   *  and the request becomes inactive. Otherwise, returns an empty @c
+   *  std::optional<>.
+   */
+  std::optional<status> test();
+
+  /**
+   *  Cancel a pending communication, assuming it has not already been
+   *  completed.
+   */
+  void cancel();
+
+  /**
+   * The MPI request of the ongoing communication; @c MPI_REQUEST_NULL
+   * while inactive. Persistent requests are always trivial.
+   */
+  MPI_Request* trivial() { return &m_request; }
+
+  /**
+   * Has this request been started but not yet completed?
+   */
+  bool active() const { return m_request != MPI_REQUEST_NULL; }
+
+  /**
+   * Keep @p d alive for as long as the request, e.g. the count and
+   * displacement arrays that MPI reads on every start.
+   */
+  template<class T> void set_data(std::shared_ptr<T> d) { m_data = d; }
+
+ private:
+  template<typename ForwardIterator>
+  friend void start_all(ForwardIterator first, ForwardIterator last);
+
+  /**
+   * INTERNAL ONLY
+   *
+   * Function object that frees a persistent MPI request. Intended to
+   * be used as a deleter with shared_ptr.
+   */
+  struct request_free
+  {
+    void operator()(MPI_Request* req) const;
+  };
+
+  /// The handle returned by MPI_*_init; lives as long as any copy
+  std::shared_ptr<MPI_Request> m_persistent;
+
+  /// Buffers that must live as long as the request
+  std::shared_ptr<void> m_data;
+
+  /// Initiates the emulated operation instead of MPI_Start, if set
+  std::function<void(MPI_Request*)> m_post;
+
+  /// Equals the persistent handle (or the nonblocking request of an
+  /// emulated operation) while started, null otherwise
+  MPI_Request m_request{MPI_REQUEST_NULL};
+};
+
+
+/**
+ *  @brief Start all persistent requests in the iterator range
+ *  @c [first,last).
+ *
+ *  Equivalent to @c MPI_Startall, which starts all requests created by
+ *  MPI at once. Emulated persistent collectives are started afterwards,
+ *  one by one in order. None of the requests may be active.
+ */
+template<typename ForwardIterator>
+void start_all(ForwardIterator first, ForwardIterator last)
+{
+  std::vector<MPI_Request> handles;
+  for (ForwardIterator current = first; current != last; ++current) {
+    assert(!current->active());
+    if (!current->m_post) {
+      assert(current->m_persistent);
+      handles.push_back(*current->m_persistent);
+    }
+  }
+
+  if (!handles.empty())
+    MPI_CHECK_RESULT(MPI_Startall,
+                    (static_cast<int>(handles.size()), handles.data()));
+
+  for (; first != last; ++first) {
+    if (first->m_post)
+      first->m_post(&first->m_request);
+    else
+      first->m_request = *first->m_persistent;
+  }
+}
+
+} } // end namespace mpi4cpp::mpi
+
+#include "persistent_request_impl.h"
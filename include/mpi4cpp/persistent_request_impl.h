@@ -0,0 +1,88 @@
+// Copyright 2018 - 2026, Joonas Nättilä and the hel-astro-lab contributors
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <cassert>
+#include <optional>
+#include <utility>
+
+#include "persistent_request.h"
+#include "exception.h"
+
+
+namespace mpi4cpp { namespace mpi {
+
+
+inline void
+persistent_request::request_free::operator()(MPI_Request* req) const
+{
+  assert( req != nullptr );
+  int finalized;
+  MPI_CHECK_RESULT(MPI_Finalized, (&finalized));
+  if (finalized == 0 && *req != MPI_REQUEST_NULL)
+    MPI_CHECK_RESULT(MPI_Request_free, (req));
+  delete req;
+}
+
+
+inline persistent_request::persistent_request(MPI_Request req)
+  : m_persistent(new MPI_Request(req), request_free())
+{ }
+
+
+inline persistent_request::persistent_request(std::function<void(MPI_Request*)> post)
+  : m_post(std::move(post))
+{ }
+
+
+inline void
+persistent_request::start()
+{
+  assert(!active());
+  if (m_post) {
+    m_post(&m_request);
+    return;
+  }
+
+  assert(m_persistent);
+  MPI_CHECK_RESULT(MPI_Start, (m_persistent.get()));
+  m_request = *m_persistent;
+}
+
+
+inline status
+persistent_request::wait()
+{
+  // MPI leaves completed persistent requests in place, so we mark
+  // this one inactive ourselves
+  status result;
+  MPI_CHECK_RESULT(MPI_Wait, (&m_request, &result.m_status));
+  m_request = MPI_REQUEST_NULL;
+  return result;
+}
+
+
+inline std::optional<status>
+persistent_request::test()
+{
+  status result;
+  int flag = 0;
+  MPI_CHECK_RESULT(MPI_Test, (&m_request, &flag, &result.m_status));
+  if (flag == 0) return std::optional<status>();
+
+  m_request = MPI_REQUEST_NULL;
+  return result;
+}
+
+
+inline void
+persistent_request::cancel()
+{
+  if (active()) {
+    MPI_CHECK_RESULT(MPI_Cancel, (&m_request));
+  }
+}
+
+
+} } // end namespace mpi4cpp::mpi
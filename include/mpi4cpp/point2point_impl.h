@@ -65,7 +65,14 @@ template<typename T>
 inline void 
 communicator::send(int dest, int tag, const T& value) const
 {
-  this->send_impl(dest, tag, value, is_mpi_datatype<T>());
+  // contiguous ranges are sent as an array of their elements
+  if constexpr (detail::is_contiguous_range<T>::value)
+    this->array_send_impl(dest, tag, std::data(value), std::size(value),
+                          is_mpi_datatype<detail::range_value_t<T>>());
+  else if constexpr (detail::is_datatype_view<T>::value)
+    this->datatype_send_impl(dest, tag, value.base(), value.datatype());
+  else
+    this->send_impl(dest, tag, value, is_mpi_datatype<T>());
 }
 
 // Single-element receive may either receive the element directly or
@@ -74,7 +81,18 @@ template<typename T>
 inline status 
 communicator::recv(int source, int tag, T& value) const
 {
-  return this->recv_impl(source, tag, value, is_mpi_datatype<T>());
+  // contiguous ranges receive at most their current size
+  if constexpr (detail::is_contiguous_range<T>::value) {
+    static_assert(!std::is_const<std::remove_pointer_t<decltype(std::data(value))>>::value,
+                  "cannot receive into a read-only range");
+    return this->array_recv_impl(source, tag, std::data(value), std::size(value),
+                                 is_mpi_datatype<detail::range_value_t<T>>());
+  } else if constexpr (detail::is_datatype_view<T>::value) {
+    static_assert(!std::is_const<std::remove_pointer_t<decltype(value.base())>>::value,
+                  "cannot receive into a read-only view");
+    return this->datatype_recv_impl(source, tag, value.base(), value.datatype());
+  } else
+    return this->recv_impl(source, tag, value, is_mpi_datatype<T>());
 }
 
 //--------------------------------------------------
@@ -83,56 +101,74 @@ communicator::recv(int source, int tag, T& value) const
 // datatype, so we map directly to that datatype.
 template<typename T>
 inline void
-communicator::array_send_impl(int dest, int tag, const T* values, int n,
+communicator::array_send_impl(int dest, int tag, const T* values, std::size_t n,
                               mpl::true_ /*unused*/) const
 {
-  MPI_CHECK_RESULT(MPI_Send,
-                  (const_cast<T*>(values), n, 
-                  get_mpi_datatype<T>(*values),
+  detail::large_count count(get_mpi_datatype<T>(), n);
+  MPI_CHECK_RESULT(MPI4CPP_LARGE(MPI_Send),
+                  (const_cast<T*>(values), count.count(), count.datatype(),
                   dest, tag, MPI_Comm(*this)));
 }
 
 template<typename T>
 inline status 
-communicator::array_recv_impl(int source, int tag, T* values, int n, 
+communicator::array_recv_impl(int source, int tag, T* values, std::size_t n, 
                               mpl::true_ /*unused*/) const
 {
   status stat;
-  MPI_CHECK_RESULT(MPI_Recv,
-                  (const_cast<T*>(values), n, 
-                  get_mpi_datatype<T>(*values),
+  detail::large_count count(get_mpi_datatype<T>(), n);
+  MPI_CHECK_RESULT(MPI4CPP_LARGE(MPI_Recv),
+                  (values, count.count(), count.datatype(),
                   source, tag, MPI_Comm(*this), &stat.m_status));
   return stat;
 }
 
 //--------------------------------------------------
 
+// Views with a derived datatype go as a single element of that type
+inline void
+communicator::datatype_send_impl(int dest, int tag, const void* base, 
+                                 MPI_Datatype type) const
+{
+  MPI_CHECK_RESULT(MPI_Send,
+                  (const_cast<void*>(base), 1, type, dest, tag, MPI_Comm(*this)));
+}
+
+inline status 
+communicator::datatype_recv_impl(int source, int tag, void* base, 
+                                 MPI_Datatype type) const
+{
+  status stat;
+  MPI_CHECK_RESULT(MPI_Recv,
+                  (base, 1, type, source, tag, MPI_Comm(*this), &stat.m_status));
+  return stat;
+}
+
+//--------------------------------------------------
+
 // vector of a type has an associated MPI datatype, so we map directly to 
-// that datatype
+// that datatype. The vector travels as a single message; the receiver
+// learns its length from the matched message itself.
 template<typename T, typename A>
 inline void 
 communicator::send_vector(int dest, int tag, 
-  const std::vector<T,A>& value, mpl::true_ true_type) const
+  const std::vector<T,A>& value, mpl::true_ /*true_type*/) const
 {
-  // send the vector size
-  typename std::vector<T,A>::size_type size = value.size();
-  send(dest, tag, size);
-  // send the data
-  this->array_send_impl(dest, tag, value.data(), size, true_type);
+  detail::large_count count(get_mpi_datatype<T>(), value.size());
+  MPI_CHECK_RESULT(MPI4CPP_LARGE(MPI_Send),
+                  (const_cast<T*>(value.data()), count.count(), count.datatype(),
+                  dest, tag, MPI_Comm(*this)));
 }
 
 template<typename T, typename A>
 inline status 
 communicator::recv_vector(int source, int tag, 
-  std::vector<T,A>& value, mpl::true_ true_type) const
+  std::vector<T,A>& value, mpl::true_ /*true_type*/) const
 {
-  // receive the vector size
-  typename std::vector<T,A>::size_type size = 0;
-  recv(source, tag, size);
-  // size the vector
-  value.resize(size);
-  // receive the data
-  return this->array_recv_impl(source, tag, value.data(), size, true_type);
+  // match the message first; the returned handle can only be received
+  // by us so no other thread can steal it between probe and receive.
+  // The vector is then sized from the matched message.
+  return mprobe(source, tag).recv(value);
 }
 
 //--------------------------------------------------
@@ -151,12 +187,28 @@ communicator::recv(int source, int tag, std::vector<T,A>& value) const
   return recv_vector(source, tag, value, is_mpi_datatype<T>());
 }
 
+// strings are resized to the matched message just like vectors
+template<typename C, class Tr, class A>
+inline status 
+communicator::recv(int source, int tag, std::basic_string<C,Tr,A>& value) const
+{
+  return mprobe(source, tag).recv(value);
+}
+
+// temporary views (e.g. a subspan) still refer to the caller's buffer
+template<typename R, typename>
+inline status 
+communicator::recv(int source, int tag, R&& values) const
+{
+  return this->recv(source, tag, values);
+}
+
 //--------------------------------------------------
 
 // Array send must send the elements directly
 template<typename T>
 inline void 
-communicator::send(int dest, int tag, const T* values, int n) const
+communicator::send(int dest, int tag, const T* values, std::size_t n) const
 {
   this->array_send_impl(dest, tag, values, n, is_mpi_datatype<T>());
 }
@@ -164,7 +216,7 @@ communicator::send(int dest, int tag, const T* values, int n) const
 // Array receive must receive the elements directly into a buffer.
 template<typename T>
 inline status 
-communicator::recv(int source, int tag, T* values, int n) const
+communicator::recv(int source, int tag, T* values, std::size_t n) const
 {
   return this->array_recv_impl(source, tag, values, n, is_mpi_datatype<T>());
 }
@@ -172,4 +224,119 @@ communicator::recv(int source, int tag, T* values, int n) const
 //--------------------------------------------------
 
 
+// sendrecv
+
+template<typename T>
+inline status 
+communicator::array_sendrecv_impl(int dest, int stag, const T* svalues, std::size_t sn,
+                                  int source, int rtag, T* rvalues, std::size_t rn,
+                                  mpl::true_ /*unused*/) const
+{
+  status stat;
+  detail::large_count scount(get_mpi_datatype<T>(), sn);
+  detail::large_count rcount(get_mpi_datatype<T>(), rn);
+  MPI_CHECK_RESULT(MPI4CPP_LARGE(MPI_Sendrecv),
+                  (const_cast<T*>(svalues), scount.count(), scount.datatype(),
+                  dest, stag,
+                  rvalues, rcount.count(), rcount.datatype(),
+                  source, rtag, MPI_Comm(*this), &stat.m_status));
+  return stat;
+}
+
+template<typename T, typename A>
+inline status 
+communicator::sendrecv_vector(int dest, int stag, const std::vector<T,A>& svalues,
+                              int source, int rtag, std::vector<T,A>& rvalues,
+                              mpl::true_ primitive) const
+{
+  // post the send so that both sides can enter the receive
+  request req = this->isend_vector(dest, stag, svalues, primitive);
+  status stat = this->recv_vector(source, rtag, rvalues, primitive);
+  req.wait();
+  return stat;
+}
+
+template<typename T>
+inline status 
+communicator::array_sendrecv_replace_impl(int dest, int stag, int source, int rtag,
+                                          T* values, std::size_t n, 
+                                          mpl::true_ /*unused*/) const
+{
+  status stat;
+  detail::large_count count(get_mpi_datatype<T>(), n);
+  MPI_CHECK_RESULT(MPI4CPP_LARGE(MPI_Sendrecv_replace),
+                  (values, count.count(), count.datatype(),
+                  dest, stag, source, rtag, 
+                  MPI_Comm(*this), &stat.m_status));
+  return stat;
+}
+
+//--------------------------------------------------
+
+template<typename T>
+inline status 
+communicator::sendrecv(int dest, int stag, const T& svalue, 
+                       int source, int rtag, T& rvalue) const
+{
+  return this->array_sendrecv_impl(dest, stag, &svalue, 1, 
+                                   source, rtag, &rvalue, 1, is_mpi_datatype<T>());
+}
+
+template<typename T>
+inline status 
+communicator::sendrecv(int dest, int stag, const T* svalues, std::size_t sn,
+                       int source, int rtag, T* rvalues, std::size_t rn) const
+{
+  return this->array_sendrecv_impl(dest, stag, svalues, sn, 
+                                   source, rtag, rvalues, rn, is_mpi_datatype<T>());
+}
+
+template<typename T, std::size_t N>
+inline status 
+communicator::sendrecv(int dest, int stag, const std::array<T,N>& svalues,
+                       int source, int rtag, std::array<T,N>& rvalues) const
+{
+  return this->array_sendrecv_impl(dest, stag, svalues.data(), N, 
+                                   source, rtag, rvalues.data(), N, is_mpi_datatype<T>());
+}
+
+template<typename T, typename A>
+inline status 
+communicator::sendrecv(int dest, int stag, const std::vector<T,A>& svalues,
+                       int source, int rtag, std::vector<T,A>& rvalues) const
+{
+  return this->sendrecv_vector(dest, stag, svalues, 
+                               source, rtag, rvalues, is_mpi_datatype<T>());
+}
+
+template<typename T>
+inline status 
+communicator::sendrecv_replace(int dest, int stag, int source, int rtag, 
+                               T& value) const
+{
+  return this->array_sendrecv_replace_impl(dest, stag, source, rtag, 
+                                           &value, 1, is_mpi_datatype<T>());
+}
+
+template<typename T>
+inline status 
+communicator::sendrecv_replace(int dest, int stag, int source, int rtag, 
+                               T* values, std::size_t n) const
+{
+  return this->array_sendrecv_replace_impl(dest, stag, source, rtag, 
+                                           values, n, is_mpi_datatype<T>());
+}
+
+template<typename T, std::size_t N>
+inline status 
+communicator::sendrecv_replace(int dest, int stag, int source, int rtag, 
+                               std::array<T,N>& values) const
+{
+  return this->array_sendrecv_replace_impl(dest, stag, source, rtag, 
+                                           values.data(), N, is_mpi_datatype<T>());
+}
+
+//--------------------------------------------------
+
+
 } } // ns mpi4cpp::mpi
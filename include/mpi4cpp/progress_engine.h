@@ -0,0 +1,100 @@
+// Copyright 2018 - 2026, Joonas Nättilä and the hel-astro-lab contributors
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+
+#include "request.h"
+#include "request_set.h"
+#include "status.h"
+
+namespace mpi4cpp { namespace mpi {
+
+/**
+ *  @brief Drives outstanding requests and calls their continuations
+ *  as they complete.
+ *
+ *  Requests are posted with a callback (or a continuation attached
+ *  with @c request::then) and completed in batches with @c
+ *  MPI_Testsome on an internal @c request_set. Each @c poll() runs the
+ *  callbacks of all requests completed so far and returns, so it can
+ *  be interleaved with computation; @c run() blocks until all posted
+ *  requests, including those posted by callbacks, have completed.
+ *
+ *  @code
+ *  mpi::progress_engine engine;
+ *  for(auto& halo : halos)
+ *    engine.post(world.irecv(halo.rank, tag, halo.buffer),
+ *                [&halo](const mpi::status&) { halo.unpack(); });
+ *  while (!engine.empty()) {
+ *    compute_interior_chunk();
+ *    engine.poll();
+ *  }
+ *  @endcode
+ *
+ *  Callbacks may post new requests to the engine but must not call
+ *  its @c poll() or @c run().
+ */
+class progress_engine
+{
+ public:
+  /**
+   *  Constructs an engine without pending requests.
+   */
+  progress_engine() = default;
+
+  /**
+   *  Constructs an engine with room for @p capacity pending requests.
+   */
+  explicit progress_engine(std::size_t capacity) : m_requests(capacity) {}
+
+  /**
+   *  Post the active request @p req; its continuation, if any, is
+   *  called when it completes.
+   */
+  void post(request req) { m_requests.add(std::move(req)); }
+
+  /**
+   *  Post the active request @p req and call @p callback with its
+   *  @c status when it completes.
+   */
+  void post(request req, std::function<void(const status&)> callback)
+  {
+    req.then(std::move(callback));
+    m_requests.add(std::move(req));
+  }
+
+  /**
+   *  Complete the requests that have completed and call their
+   *  callbacks, without waiting.
+   *
+   *  @returns The number of completed requests.
+   */
+  std::size_t poll() { return m_requests.test_some(); }
+
+  /**
+   *  Complete all posted requests, calling the callbacks as they
+   *  complete rather than in posting order.
+   */
+  void run()
+  {
+    while (!m_requests.empty()) m_requests.wait_some();
+  }
+
+  /**
+   *  The number of pending requests.
+   */
+  std::size_t size() const { return m_requests.size(); }
+
+  /**
+   *  Are there no pending requests?
+   */
+  bool empty() const { return m_requests.empty(); }
+
+ private:
+  request_set m_requests;
+};
+
+} } // end namespace mpi4cpp::mpi
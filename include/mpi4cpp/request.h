@@ -4,12 +4,14 @@
 #pragma once
 
 #include <functional>
+#include <memory>
 #include <optional>
 
 namespace mpi4cpp { namespace mpi {
 
 class status;
 class communicator;
+class scheduler;
 
 /**
  *  @brief A request for a non-blocking send or receive.
@@ -39,10 +41,25 @@ class request
   request(communicator const& comm, int source, int tag, T* value, int n);
 
   /**
-   *  Constructs request for array of primitive data.
+   *  Constructs request for a resizable container (@c std::vector or
+   *  @c std::basic_string) of primitive data. A message that has not
+   *  arrived yet is matched by the first @c test() or @c wait(), so
+   *  such requests for the same source and tag match in the order
+   *  they are tested.
    */
-  template<typename T, class A> 
-  request(communicator const& comm, int source, int tag, std::vector<T,A>& values, mpl::true_ primitive);
+  template<class Container> 
+  request(communicator const& comm, int source, int tag, Container& values, mpl::true_ primitive);
+
+  /**
+   *  Constructs request for a nonblocking collective that exchanges
+   *  sizes before the payload, e.g. the broadcast of a @c std::vector.
+   *  @p data, a @c detail::two_step_collective, posts the size exchange
+   *  on @c data->comm with @c data->post_sizes(MPI_Request*) right away
+   *  and the payload with @c data->post_payload(MPI_Comm, MPI_Request*)
+   *  once the sizes have arrived.
+   */
+  template<class Data>
+  explicit request(std::shared_ptr<Data> data);
 
   /**
    *  Wait until the communication associated with this request has
@@ -66,6 +83,20 @@ class request
    *  completed.
    */
   void cancel();
+
+  /**
+   *  Attach a continuation: @p callback is called with the @c status
+   *  of the communication as soon as it is found complete, by @c
+   *  wait(), @c test(), the helpers of nonblocking.h, a @c request_set
+   *  or a @c progress_engine. It replaces an earlier continuation. A
+   *  request with a continuation is not trivial.
+   */
+  request& then(std::function<void(const status&)> callback) &;
+
+  /**
+   *  \overload
+   */
+  request&& then(std::function<void(const status&)> callback) &&;
   
   /**
    * The trivial MPI request implementing this request, provided it's trivial.
@@ -101,6 +132,16 @@ class request
   template<class T> void set_data(std::shared_ptr<T>& d) { m_data = d; }
 
  private:
+  friend class request_set;
+  friend class scheduler;
+
+  /// The completion of @c wait() and @c test() without the continuation
+  status wait_impl();
+  std::optional<status> test_impl();
+
+  /// Call and drop the continuation, if any
+  void run_continuation(const status& stat);
+
   enum request_action { ra_wait, ra_test, ra_cancel };
   using handler_type = std::optional<status> (*)(request *, request_action);
 
@@ -121,14 +162,22 @@ class request
    /**
    * Handles the non-blocking receive of a dynamic array of primitive values.
    */
-  template<typename T, class A>
+  template<class Container>
   static std::optional<status> 
   handle_dynamic_primitive_array_irecv(request* self, request_action action);
 
+  /**
+   * Handles a nonblocking collective with a size and a payload step.
+   */
+  template<class Data>
+  static std::optional<status> 
+  handle_two_step_collective(request* self, request_action action);
+
  private:
   MPI_Request           m_requests[2];
   std::shared_ptr<void> m_data;
   handler_type          m_handler{nullptr};
+  std::function<void(const status&)> m_continuation;
 };
 
 } } // end namespace mpi4cpp::mpi
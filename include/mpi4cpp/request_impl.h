@@ -4,7 +4,9 @@
 #pragma once
 
 #include <exception>
+#include <functional>
 #include <optional>
+#include <utility>
 
 #include "exception.h"
 
@@ -22,7 +24,7 @@ inline request::request()
 //std::optional< std::reference_wrapper<MPI_Request> >
 inline MPI_Request*
 request::trivial() {
-  if ((!bool(m_handler) && m_requests[1] == MPI_REQUEST_NULL)) {
+  if (!bool(m_handler) && !m_continuation && m_requests[1] == MPI_REQUEST_NULL) {
     return &m_requests[0];
   } else {
     return nullptr;
@@ -32,17 +34,64 @@ request::trivial() {
 
 inline bool
 request::active() const {
-  return m_requests[0] != MPI_REQUEST_NULL || m_requests[1] != MPI_REQUEST_NULL;
+  // handler based requests may be pending before any MPI request is posted
+  return m_handler != nullptr 
+      || m_requests[0] != MPI_REQUEST_NULL || m_requests[1] != MPI_REQUEST_NULL;
 }
 
 
-inline status 
+inline request&
+request::then(std::function<void(const status&)> callback) &
+{
+  m_continuation = std::move(callback);
+  return *this;
+}
+
+inline request&&
+request::then(std::function<void(const status&)> callback) &&
+{
+  m_continuation = std::move(callback);
+  return std::move(*this);
+}
+
+inline void
+request::run_continuation(const status& stat)
+{
+  if (!m_continuation) return;
+  // the continuation may post new requests, even into this one
+  std::function<void(const status&)> callback = std::move(m_continuation);
+  m_continuation = nullptr;
+  callback(stat);
+}
+
+
+inline status
 request::wait()
+{
+  status result = wait_impl();
+  run_continuation(result);
+  return result;
+}
+
+inline std::optional<status>
+request::test()
+{
+  std::optional<status> result = test_impl();
+  if (result) run_continuation(*result);
+  return result;
+}
+
+
+inline status 
+request::wait_impl()
 {
   if (m_handler != nullptr) {
     // This request is a receive for a serialized type. Use the
-    // handler to wait for completion.
-    return *m_handler(this, ra_wait);
+    // handler to wait for completion. Once completed it behaves 
+    // like a null request.
+    status result = *m_handler(this, ra_wait);
+    m_handler = nullptr;
+    return result;
   } else if (m_requests[1] == MPI_REQUEST_NULL) {
     // This request is either a send or a receive for a type with an
     // associated MPI datatype, or a serialized datatype that has been
@@ -82,12 +131,15 @@ request::wait()
 
 
 inline std::optional<status> 
-request::test()
+request::test_impl()
 {
   if (m_handler != nullptr) {
     // This request is a receive for a serialized type. Use the
-    // handler to test for completion.
-    return m_handler(this, ra_test);
+    // handler to test for completion. Once completed it behaves 
+    // like a null request.
+    std::optional<status> result = m_handler(this, ra_test);
+    if (result) m_handler = nullptr;
+    return result;
   } else if (m_requests[1] == MPI_REQUEST_NULL) {
     // This request is either a send or a receive for a type with an
     // associated MPI datatype, or a serialized datatype that has been
@@ -137,6 +189,9 @@ request::cancel()
 {
   if (m_handler != nullptr) {
     m_handler(this, ra_cancel);
+    // If nothing was posted yet there is nothing left to complete
+    if (m_requests[0] == MPI_REQUEST_NULL && m_requests[1] == MPI_REQUEST_NULL)
+      m_handler = nullptr;
   } else {
     MPI_CHECK_RESULT(MPI_Cancel, (&m_requests[0]));
     if (m_requests[1] != MPI_REQUEST_NULL)
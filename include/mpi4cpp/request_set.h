@@ -0,0 +1,187 @@
+// Copyright 2018 - 2026, Joonas Nättilä and the hel-astro-lab contributors
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "request.h"
+#include "status.h"
+
+namespace mpi4cpp { namespace mpi {
+
+namespace detail {
+  /**
+   * Output iterator that only counts the values written through it.
+   */
+  struct counting_iterator
+  {
+    using iterator_category = std::output_iterator_tag;
+    using value_type        = void;
+    using difference_type   = std::ptrdiff_t;
+    using pointer           = void;
+    using reference         = void;
+
+    std::size_t count{0};
+
+    counting_iterator& operator*() { return *this; }
+    counting_iterator& operator++() { return *this; }
+    counting_iterator& operator++(int) { return *this; }
+    template<typename T>
+    counting_iterator& operator=(const T&) { ++count; return *this; }
+  };
+}
+
+/**
+ *  @brief A set of pending requests completed together.
+ *
+ *  Each request added to the set gets a slot number that identifies it
+ *  when it completes. The MPI requests of trivial requests are kept in
+ *  one contiguous array indexed by slot, so @c wait_any, @c test_some
+ *  and @c wait_all map directly to @c MPI_Waitany, @c MPI_Testsome and
+ *  @c MPI_Waitall without building a temporary array. Handler based
+ *  requests (serialized data, dynamic size receives, two step
+ *  collectives) are kept apart and tested one by one; their slot in
+ *  the array stays @c MPI_REQUEST_NULL, which MPI ignores.
+ *
+ *  Slots of completed requests are reused by later @c add calls, and
+ *  the scratch space for the MPI calls only grows, so a set with a
+ *  steady number of requests in flight does not allocate.
+ *
+ *  The continuations of the requests (see @c request::then) are called
+ *  as the set completes them. They may add new requests to the set but
+ *  must not complete requests of the same set.
+ */
+class request_set
+{
+ public:
+  /**
+   *  Constructs an empty set.
+   */
+  request_set() = default;
+
+  /**
+   *  Constructs an empty set with room for @p capacity requests.
+   */
+  explicit request_set(std::size_t capacity);
+
+  /**
+   *  Adds the active request @p req and returns its slot number,
+   *  which is valid until the request completes.
+   */
+  std::size_t add(request req);
+
+  /**
+   *  The number of pending requests.
+   */
+  std::size_t size() const { return m_pending; }
+
+  /**
+   *  Are there no pending requests?
+   */
+  bool empty() const { return m_pending == 0; }
+
+  /**
+   *  Wait until any request has completed, equivalent to @c
+   *  MPI_Waitany. The set must not be empty.
+   *
+   *  @returns The @c status of the completed request and its slot.
+   */
+  std::pair<status, std::size_t> wait_any();
+
+  /**
+   *  Complete one request if any has completed, equivalent to @c
+   *  MPI_Testany.
+   */
+  std::optional<std::pair<status, std::size_t>> test_any();
+
+  /**
+   *  Complete all requests that have completed, equivalent to @c
+   *  MPI_Testsome. A @c std::pair<status, std::size_t> of the status
+   *  and the slot of each of them is written to @p out.
+   *
+   *  @returns @p out after the completed requests have been written.
+   */
+  template<typename OutputIterator>
+  OutputIterator test_some(OutputIterator out);
+
+  /**
+   *  \overload
+   *
+   *  @returns The number of completed requests.
+   */
+  std::size_t test_some();
+
+  /**
+   *  Wait until at least one request has completed, then complete all
+   *  that have, equivalent to @c MPI_Waitsome. The set must not be
+   *  empty. See @c test_some.
+   */
+  template<typename OutputIterator>
+  OutputIterator wait_some(OutputIterator out);
+
+  /**
+   *  \overload
+   *
+   *  @returns The number of completed requests.
+   */
+  std::size_t wait_some();
+
+  /**
+   *  Wait until all requests have completed, equivalent to @c
+   *  MPI_Waitall. The pairs of status and slot are written to @p out.
+   *  Requests added by continuations meanwhile are waited on, too.
+   */
+  template<typename OutputIterator>
+  OutputIterator wait_all(OutputIterator out);
+
+  /**
+   *  \overload
+   */
+  void wait_all();
+
+ private:
+  /// Marks @p slot free after its request has completed, then calls
+  /// its continuation
+  void complete(std::size_t slot, const status& stat);
+
+  /// Test the handler based requests; completed ones go to @p out
+  template<typename OutputIterator>
+  OutputIterator test_handled(OutputIterator out);
+
+  /// Completed trivial requests from the scratch space go to @p out
+  template<typename OutputIterator>
+  OutputIterator emit_completed(int outcount, OutputIterator out);
+
+  /// MPI requests of the trivial requests, indexed by slot
+  std::vector<MPI_Request> m_requests;
+
+  /// Buffers kept alive by the trivial requests, indexed by slot
+  std::vector<std::shared_ptr<void>> m_data;
+
+  /// Continuations of all requests, indexed by slot
+  std::vector<std::function<void(const status&)>> m_continuations;
+
+  /// Handler based requests and their slots
+  std::vector<std::pair<request, std::size_t>> m_handled;
+
+  /// Slots ready for reuse
+  std::vector<std::size_t> m_free;
+
+  /// Scratch space for @c MPI_Testsome and @c MPI_Waitsome
+  std::vector<int>        m_indices;
+  std::vector<MPI_Status> m_statuses;
+
+  std::size_t m_pending{0};
+  std::size_t m_completed{0};
+};
+
+} } // end namespace mpi4cpp::mpi
+
+#include "request_set_impl.h"
@@ -0,0 +1,245 @@
+// Copyright 2018 - 2026, Joonas Nättilä and the hel-astro-lab contributors
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <cassert>
+
+#include "exception.h"
+
+
+namespace mpi4cpp { namespace mpi {
+
+
+inline request_set::request_set(std::size_t capacity)
+{
+  m_requests.reserve(capacity);
+  m_data.reserve(capacity);
+  m_continuations.reserve(capacity);
+  m_free.reserve(capacity);
+  m_indices.reserve(capacity);
+  m_statuses.reserve(capacity);
+}
+
+inline std::size_t
+request_set::add(request req)
+{
+  assert(req.active());
+
+  std::size_t slot;
+  if (!m_free.empty()) {
+    slot = m_free.back();
+    m_free.pop_back();
+  } else {
+    slot = m_requests.size();
+    m_requests.push_back(MPI_REQUEST_NULL);
+    m_data.emplace_back();
+    m_continuations.emplace_back();
+    if (m_indices.size() < m_requests.size()) {
+      m_indices.resize(m_requests.capacity());
+      m_statuses.resize(m_requests.capacity());
+    }
+  }
+
+  // the set calls the continuation itself, which also lets trivial
+  // requests keep their MPI request in the array
+  m_continuations[slot] = std::move(req.m_continuation);
+  req.m_continuation = nullptr;
+
+  if (MPI_Request* trivial = req.trivial()) {
+    m_requests[slot] = *trivial;
+    m_data[slot] = req.data<void>();
+  } else
+    m_handled.emplace_back(std::move(req), slot);
+
+  ++m_pending;
+  return slot;
+}
+
+inline void
+request_set::complete(std::size_t slot, const status& stat)
+{
+  std::function<void(const status&)> callback = std::move(m_continuations[slot]);
+  m_continuations[slot] = nullptr;
+  m_data[slot].reset();
+  m_free.push_back(slot);
+  --m_pending;
+  ++m_completed;
+
+  if (callback) callback(stat);
+}
+
+
+template<typename OutputIterator>
+inline OutputIterator
+request_set::test_handled(OutputIterator out)
+{
+  for(std::size_t i=0; i<m_handled.size(); ) {
+    if (std::optional<status> result = m_handled[i].first.test()) {
+      std::size_t slot = m_handled[i].second;
+      // keep the handled requests compact
+      std::swap(m_handled[i], m_handled.back());
+      m_handled.pop_back();
+      complete(slot, *result);
+      *out++ = std::make_pair(*result, slot);
+    } else
+      ++i;
+  }
+  return out;
+}
+
+template<typename OutputIterator>
+inline OutputIterator
+request_set::emit_completed(int outcount, OutputIterator out)
+{
+  if (outcount == MPI_UNDEFINED) return out;
+  for(int i=0; i<outcount; i++) {
+    // continuations may add requests and so resize the scratch space
+    std::size_t slot = static_cast<std::size_t>(m_indices[i]);
+    status result;
+    static_cast<MPI_Status&>(result) = m_statuses[i];
+    complete(slot, result);
+    *out++ = std::make_pair(result, slot);
+  }
+  return out;
+}
+
+
+inline std::optional<std::pair<status, std::size_t>>
+request_set::test_any()
+{
+  for(std::size_t i=0; i<m_handled.size(); i++) {
+    if (std::optional<status> result = m_handled[i].first.test()) {
+      std::size_t slot = m_handled[i].second;
+      std::swap(m_handled[i], m_handled.back());
+      m_handled.pop_back();
+      complete(slot, *result);
+      return std::make_pair(*result, slot);
+    }
+  }
+
+  if (m_requests.empty()) return std::nullopt;
+
+  int index, flag;
+  status result;
+  MPI_CHECK_RESULT(MPI_Testany,
+                  (static_cast<int>(m_requests.size()), m_requests.data(),
+                  &index, &flag, &static_cast<MPI_Status&>(result)));
+  if (!flag || index == MPI_UNDEFINED) return std::nullopt;
+
+  complete(static_cast<std::size_t>(index), result);
+  return std::make_pair(result, static_cast<std::size_t>(index));
+}
+
+inline std::pair<status, std::size_t>
+request_set::wait_any()
+{
+  assert(!empty());
+
+  // Handler based requests progress only when tested, so they cannot
+  // be waited on inside MPI
+  if (!m_handled.empty()) {
+    while (true) {
+      if (auto result = test_any()) return *result;
+    }
+  }
+
+  int index;
+  status result;
+  MPI_CHECK_RESULT(MPI_Waitany,
+                  (static_cast<int>(m_requests.size()), m_requests.data(),
+                  &index, &static_cast<MPI_Status&>(result)));
+  assert(index != MPI_UNDEFINED);
+
+  complete(static_cast<std::size_t>(index), result);
+  return std::make_pair(result, static_cast<std::size_t>(index));
+}
+
+template<typename OutputIterator>
+inline OutputIterator
+request_set::test_some(OutputIterator out)
+{
+  out = test_handled(out);
+  if (m_requests.empty()) return out;
+
+  int outcount;
+  MPI_CHECK_RESULT(MPI_Testsome,
+                  (static_cast<int>(m_requests.size()), m_requests.data(),
+                  &outcount, m_indices.data(), m_statuses.data()));
+  return emit_completed(outcount, out);
+}
+
+inline std::size_t
+request_set::test_some()
+{
+  return test_some(detail::counting_iterator()).count;
+}
+
+template<typename OutputIterator>
+inline OutputIterator
+request_set::wait_some(OutputIterator out)
+{
+  assert(!empty());
+
+  if (!m_handled.empty()) {
+    std::size_t before = m_completed;
+    do {
+      out = test_some(out);
+    } while (m_completed == before);
+    return out;
+  }
+
+  int outcount;
+  MPI_CHECK_RESULT(MPI_Waitsome,
+                  (static_cast<int>(m_requests.size()), m_requests.data(),
+                  &outcount, m_indices.data(), m_statuses.data()));
+  return emit_completed(outcount, out);
+}
+
+inline std::size_t
+request_set::wait_some()
+{
+  return wait_some(detail::counting_iterator()).count;
+}
+
+template<typename OutputIterator>
+inline OutputIterator
+request_set::wait_all(OutputIterator out)
+{
+  while (!empty()) {
+    // remember which slots are in use; MPI resets them on completion
+    int ndone = 0;
+    for(std::size_t slot=0; slot<m_requests.size(); slot++)
+      if (m_requests[slot] != MPI_REQUEST_NULL) m_indices[ndone++] = static_cast<int>(slot);
+
+    if (ndone > 0)
+      MPI_CHECK_RESULT(MPI_Waitall,
+                      (static_cast<int>(m_requests.size()), m_requests.data(),
+                      m_statuses.data()));
+
+    // the statuses stay indexed by slot
+    for(auto& handled : m_handled) {
+      m_statuses[handled.second] = handled.first.wait();
+      m_indices[ndone++] = static_cast<int>(handled.second);
+    }
+    m_handled.clear();
+
+    for(int i=0; i<ndone; i++) {
+      std::size_t slot = static_cast<std::size_t>(m_indices[i]);
+      status result;
+      static_cast<MPI_Status&>(result) = m_statuses[slot];
+      complete(slot, result);
+      *out++ = std::make_pair(result, slot);
+    }
+  }
+  return out;
+}
+
+inline void
+request_set::wait_all()
+{
+  wait_all(detail::counting_iterator());
+}
+
+
+} } // end namespace mpi4cpp::mpi
@@ -3,6 +3,8 @@
 
 #pragma once
 
+#include <cstddef>
+#include <optional>
 
 namespace mpi4cpp { namespace mpi {
 
@@ -33,12 +35,7 @@ class status
    * Determine whether the communication associated with this object
    * has been successfully cancelled.
   */
-  bool cancelled() const
-  {
-    int flag = 0;
-    MPI_CHECK_RESULT(MPI_Test_cancelled, (&m_status, &flag));
-    return flag != 0;
-  }
+  bool cancelled() const;
 
 
   /**
@@ -46,12 +43,15 @@ class status
    * message. The type @c T must have an associated data type, i.e.,
    * @c is_mpi_datatype<T> must derive @c mpl::true_. In cases where
    * the type @c T does not match the transmitted type, this routine
-   * will return an empty @c std::optional<int>.
+   * will return an empty @c std::optional<std::size_t>.
    *
    * @returns the number of @c T elements in the message, if it can be
    * determined.
+   *
+   * The result is cached, so repeated queries with the same type do not
+   * call back into MPI.
    */
-  //template<typename T> std::optional<int> count() const;
+  template<typename T> std::optional<std::size_t> count() const;
 
 
   /**
@@ -67,7 +67,8 @@ class status
 
   /// INTERNAL ONLY
   mutable MPI_Status m_status;
-  mutable int m_count{-1};
+  mutable MPI_Count m_count{-1};
+  mutable MPI_Datatype m_count_type{MPI_DATATYPE_NULL};
 
   friend class communicator;
   //friend class request;
@@ -79,3 +80,5 @@ class status
 
 
 } } // ns mpi4cpp::mpi
+
+#include "status_impl.h"
@@ -4,6 +4,9 @@
 #pragma once
 
 #include "status.h"
+#include "datatype.h"
+#include "exception.h"
+#include "detail/large_count.h"
 
 namespace mpi4cpp { namespace mpi {
 
@@ -15,6 +18,23 @@ status::cancelled() const
   return flag != 0;
 }
 
+template<typename T>
+inline std::optional<std::size_t>
+status::count() const
+{
+  MPI_Datatype datatype = get_mpi_datatype<T>();
+  if (m_count == -1 || m_count_type != datatype) {
+    std::optional<std::size_t> count = detail::get_count(m_status, datatype);
+    if (!count)
+      return std::optional<std::size_t>();
+
+    m_count      = *count;
+    m_count_type = datatype;
+  }
+
+  return static_cast<std::size_t>(m_count);
+}
+
 
 
 } } // ns mpi4cpp::mpi
@@ -0,0 +1,119 @@
+// Copyright 2018 - 2026, Joonas Nättilä and the hel-astro-lab contributors
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <type_traits>
+
+#include "datatype.h"
+
+
+namespace mpi4cpp { namespace mpi {
+
+namespace detail {
+  /**
+   * INTERNAL ONLY
+   *
+   * Base of the views whose (non-contiguous) layout is described by a
+   * derived MPI datatype. The communicator transmits one element of
+   * @c datatype() starting from @c base().
+   */
+  struct datatype_view {};
+
+  template<typename T>
+  struct is_datatype_view
+    : mpl::bool_<std::is_base_of<datatype_view, T>::value>
+  { };
+}
+
+/**
+ *  @brief Evenly strided blocks of an array.
+ *
+ *  The view covers @p count blocks of @p blocklength consecutive
+ *  elements whose starts are @p stride elements apart, beginning at
+ *  @p base; e.g. a column of a row-major matrix or a face of a 3D grid
+ *  perpendicular to its fastest index. It maps to an @c MPI_Type_vector
+ *  that is created once per shape and cached, so passing the view to
+ *  @c send, @c recv, @c isend, @c irecv, @c send_init or @c recv_init of
+ *  a communicator transmits the elements directly from (or into) the
+ *  array without packing them into a temporary buffer.
+ *
+ *  Only the number and type of the elements has to match between the
+ *  sender and the receiver: a strided view may be received into a
+ *  contiguous array and vice versa.
+ *
+ *  The view does not own the array, which must outlive any pending
+ *  communication. Use @c strided_view<const T> for sending from a
+ *  read-only array.
+ */
+template<typename T>
+class strided_view : public detail::datatype_view
+{
+ public:
+  strided_view(T* base, std::size_t count, std::size_t blocklength,
+               std::size_t stride);
+
+  /// Address of the first element of the view
+  T* base() const { return m_base; }
+
+  /// Cached MPI datatype describing the layout; do not free it
+  MPI_Datatype datatype() const { return m_datatype; }
+
+  /// Number of elements in the view
+  std::size_t elements() const { return m_elements; }
+
+ private:
+  T* m_base;
+  MPI_Datatype m_datatype;
+  std::size_t m_elements;
+};
+
+/**
+ *  @brief A @c D dimensional block of a row-major (C order) array.
+ *
+ *  The full array at @p base has extents @p sizes; the view is the
+ *  block of extents @p subsizes whose first element is at index
+ *  @p starts. Faces, edges and corners of a grid are all subarrays
+ *  (with one, two or three of the @p subsizes equal to the halo
+ *  width). The view maps to an @c MPI_Type_create_subarray datatype
+ *  that is created once per shape and cached; otherwise it is used
+ *  like @c strided_view.
+ *
+ *    @code
+ *    // send the x = 0 face of a nx*ny*nz field to the left neighbour
+ *    mpi::subarray<const double,3> face(field.data(),
+ *                                       {nx, ny, nz}, {1, ny, nz}, {0, 0, 0});
+ *    world.send(left, tag, face);
+ *    @endcode
+ */
+template<typename T, std::size_t D>
+class subarray : public detail::datatype_view
+{
+ public:
+  using extents_type = std::array<int, D>;
+
+  subarray(T* base, const extents_type& sizes, const extents_type& subsizes,
+           const extents_type& starts);
+
+  /// Address of the full array; the offset of the block is part of
+  /// the datatype
+  T* base() const { return m_base; }
+
+  /// Cached MPI datatype describing the layout; do not free it
+  MPI_Datatype datatype() const { return m_datatype; }
+
+  /// Number of elements in the view
+  std::size_t elements() const { return m_elements; }
+
+ private:
+  T* m_base;
+  MPI_Datatype m_datatype;
+  std::size_t m_elements;
+};
+
+
+} } // ns mpi4cpp::mpi
+
+#include "subarray_impl.h"
@@ -0,0 +1,70 @@
+// Copyright 2018 - 2026, Joonas Nättilä and the hel-astro-lab contributors
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include "subarray.h"
+#include "exception.h"
+
+
+namespace mpi4cpp { namespace mpi {
+
+namespace detail {
+  /// Kinds of layouts in the shape keys of the datatype cache
+  enum shape_kind : long { sk_strided = 1, sk_subarray = 2 };
+
+  /// Look up a layout datatype by its shape, creating and committing
+  /// it with @p create on first use.
+  template<class F>
+  inline MPI_Datatype shaped_datatype(const shape_key& key, F create)
+  {
+    return mpi_datatype_cache().get_or_create(key, [&]() {
+      MPI_Datatype datatype = create();
+      MPI_CHECK_RESULT(MPI_Type_commit, (&datatype));
+      return datatype;
+    });
+  }
+}
+
+template<typename T>
+inline strided_view<T>::strided_view(T* base, std::size_t count,
+                                     std::size_t blocklength, std::size_t stride)
+  : m_base(base), m_elements(count*blocklength)
+{
+  MPI_Datatype type = get_mpi_datatype<typename std::remove_const<T>::type>();
+  detail::shape_key key{type, {detail::sk_strided,
+    long(count), long(blocklength), long(stride)} };
+
+  m_datatype = detail::shaped_datatype(key, [&]() {
+    MPI_Datatype strided;
+    MPI_CHECK_RESULT(MPI_Type_vector,
+        (int(count), int(blocklength), int(stride), type, &strided));
+    return strided;
+  });
+}
+
+template<typename T, std::size_t D>
+inline subarray<T,D>::subarray(T* base, const extents_type& sizes,
+                               const extents_type& subsizes,
+                               const extents_type& starts)
+  : m_base(base), m_elements(1)
+{
+  MPI_Datatype type = get_mpi_datatype<typename std::remove_const<T>::type>();
+  detail::shape_key key{type, {detail::sk_subarray}};
+  for(std::size_t i=0; i<D; i++) {
+    key.shape.insert(key.shape.end(), {sizes[i], subsizes[i], starts[i]});
+    m_elements *= subsizes[i];
+  }
+
+  m_datatype = detail::shaped_datatype(key, [&]() {
+    MPI_Datatype block;
+    MPI_CHECK_RESULT(MPI_Type_create_subarray,
+        (int(D), const_cast<int*>(sizes.data()),
+         const_cast<int*>(subsizes.data()), const_cast<int*>(starts.data()),
+         MPI_ORDER_C, type, &block));
+    return block;
+  });
+}
+
+
+} } // ns mpi4cpp::mpi
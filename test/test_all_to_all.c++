@@ -0,0 +1,166 @@
+// Copyright 2018 - 2026, Joonas Nättilä and the hel-astro-lab contributors
+// SPDX-License-Identifier: Apache-2.0
+
+#include <mpi4cpp/mpi.h>
+#include <iostream>
+
+#include <array>
+#include <cassert>
+#include <vector>
+
+
+struct Particle
+{
+  std::array<double,3> pos;
+  long id;
+};
+
+MPI4CPP_STRUCT(Particle, pos, id)
+
+//--------------------------------------------------
+namespace mpi = mpi4cpp::mpi;
+
+#define NX 4
+
+
+bool test_all_to_all(mpi::communicator& world)
+{
+  int rank = world.rank();
+  int size = world.size();
+
+  std::vector<int> in(size), out;
+  for(int r=0; r<size; r++) in[r] = 100*rank + r;
+  mpi::all_to_all(world, in, out);
+  assert(int(out.size()) == size);
+  for(int r=0; r<size; r++) assert(out[r] == 100*r + rank);
+
+  // arrays of the same length
+  std::vector<double> ain(size*NX), aout(size*NX);
+  for(int i=0; i<size*NX; i++) ain[i] = rank*1000 + i;
+  mpi::all_to_all(world, ain.data(), NX, aout.data());
+  for(int r=0; r<size; r++)
+    for(int i=0; i<NX; i++) assert(aout[r*NX + i] == r*1000 + rank*NX + i);
+
+  return true;
+}
+
+// particles leaving the domain, repeated with the same buffer
+bool test_all_to_allv(mpi::communicator& world)
+{
+  int rank = world.rank();
+  int size = world.size();
+
+  mpi::all_to_allv_buffer<Particle> incoming;
+  const Particle* data = nullptr;
+
+  for(int step=0; step<3; step++) {
+    // rank s sends (s + r + step) % 3 particles to rank r
+    std::vector<std::vector<Particle>> outgoing(size);
+    for(int r=0; r<size; r++)
+      for(int i=0; i<(rank + r + step) % 3; i++)
+        outgoing[r].push_back(Particle{ {{double(rank), double(r), 0.0}}, i });
+
+    if (step == 2) {
+      // large enough from the earlier steps: no reallocation
+      incoming.values.reserve(3*size);
+      data = incoming.values.data();
+    }
+    mpi::all_to_allv(world, outgoing, incoming);
+    if (step == 2) assert(incoming.values.data() == data);
+
+    assert(int(incoming.offsets.size()) == size + 1);
+    for(int s=0; s<size; s++) {
+      assert(incoming.count(s) == std::size_t((s + rank + step) % 3));
+      long i = 0;
+      for(auto p = incoming.begin(s); p != incoming.end(s); ++p, ++i) {
+        assert(p->pos[0] == s && p->pos[1] == rank && p->id == i);
+      }
+    }
+  }
+
+  // blocks already back to back: rank s sends r+1 values to rank r
+  std::vector<int> flat;
+  std::vector<std::size_t> sizes;
+  for(int r=0; r<size; r++) {
+    sizes.push_back(r + 1);
+    for(int i=0; i<r+1; i++) flat.push_back(rank);
+  }
+  mpi::all_to_allv_buffer<int> ints;
+  mpi::all_to_allv(world, flat, sizes, ints);
+  assert(ints.values.size() == std::size_t(size*(rank + 1)));
+  for(int s=0; s<size; s++) {
+    assert(ints.count(s) == std::size_t(rank + 1));
+    for(auto p = ints.begin(s); p != ints.end(s); ++p) assert(*p == s);
+  }
+
+  return true;
+}
+
+// every rank sends a different column of its matrix to each rank
+bool test_all_to_allw(mpi::communicator& world)
+{
+  int rank = world.rank();
+  int size = world.size();
+
+  // size x size row-major matrix
+  std::vector<double> matrix(size*size);
+  for(int i=0; i<size; i++)
+    for(int j=0; j<size; j++) matrix[i*size + j] = 100*rank + 10*i + j;
+
+  std::vector<mpi::strided_view<const double>> columns;
+  for(int j=0; j<size; j++)
+    columns.emplace_back(matrix.data() + j, size, 1, size);
+
+  // received contiguously: rows of the transposed blocks
+  std::vector<std::vector<double>> rows(size, std::vector<double>(size));
+  mpi::all_to_allw(world, columns, rows);
+
+  for(int s=0; s<size; s++)
+    for(int i=0; i<size; i++) assert(rows[s][i] == 100*s + 10*i + rank);
+
+  // and views on the receiving side
+  std::vector<double> transposed(size*size, -1.0);
+  std::vector<mpi::strided_view<double>> tcols;
+  for(int s=0; s<size; s++)
+    tcols.emplace_back(transposed.data() + s, size, 1, size);
+  mpi::all_to_allw(world, columns, tcols);
+
+  for(int i=0; i<size; i++)
+    for(int s=0; s<size; s++) assert(transposed[i*size + s] == 100*s + 10*i + rank);
+
+  // migration buckets: nothing for the process itself, so the empty
+  // vectors have no storage at all
+  std::vector<std::vector<int>> outgoing(size), incoming(size);
+  for(int r=0; r<size; r++) {
+    if (r != rank) outgoing[r].assign(rank + r + 1, rank);
+    if (r != rank) incoming[r].resize(rank + r + 1);
+  }
+  mpi::all_to_allw(world, outgoing, incoming);
+
+  assert(incoming[rank].empty());
+  for(int s=0; s<size; s++)
+    for(auto v : incoming[s]) assert(v == s);
+
+  // and only empty buckets
+  std::vector<std::vector<int>> none(size);
+  mpi::all_to_allw(world, none, none);
+
+  return true;
+}
+
+
+int main(int argc, char* argv[])
+{
+  mpi::environment env(argc, argv);
+  mpi::communicator world;
+
+  bool f1 = test_all_to_all(world);
+  bool f2 = test_all_to_allv(world);
+  bool f3 = test_all_to_allw(world);
+
+  assert(f1 && f2 && f3);
+
+  std::cout << "success!\n";
+
+  return 0;
+}
@@ -0,0 +1,146 @@
+// Copyright 2018 - 2026, Joonas Nättilä and the hel-astro-lab contributors
+// SPDX-License-Identifier: Apache-2.0
+
+#include <mpi4cpp/mpi.h>
+#include <iostream>
+
+#include <array>
+#include <cassert>
+#include <string>
+#include <vector>
+
+#if defined(__cpp_lib_span)
+#include <span>
+#endif
+
+
+struct Blob
+{
+  int ivar;
+  float var;
+  std::array<double,3> x;
+};
+
+MPI4CPP_STRUCT(Blob, ivar, var, x)
+
+//--------------------------------------------------
+namespace mpi = mpi4cpp::mpi;
+
+#define NX 10
+
+
+bool test_scalars(mpi::communicator& world)
+{
+  for(int root=0; root<world.size(); root++) {
+    int i    = world.rank() == root ? 42   : 0;
+    double d = world.rank() == root ? 3.5  : 0.0;
+    bool b   = world.rank() == root;
+    Blob blob{0, 0.0f, {{0.0, 0.0, 0.0}} };
+    if (world.rank() == root) blob = Blob{root, 1.0f, {{2.0, 3.0, 4.0}} };
+
+    mpi::broadcast(world, i, root);
+    mpi::broadcast(world, d, root);
+    mpi::broadcast(world, b, root);
+    mpi::broadcast(world, blob, root);
+
+    assert(i == 42);
+    assert(d == 3.5);
+    assert(b);
+    assert(blob.ivar == root && blob.var == 1.0f && blob.x[2] == 4.0);
+  }
+
+  return true;
+}
+
+// fixed size arrays and ranges keep their size
+bool test_arrays(mpi::communicator& world)
+{
+  int carr[NX];
+  std::array<double,NX> arr;
+  std::vector<long> buf(2*NX, -1);
+  for(int i=0; i<NX; i++) {
+    carr[i] = world.rank() == 0 ? i : 0;
+    arr[i]  = world.rank() == 0 ? 0.5*i : 0.0;
+  }
+  if (world.rank() == 0)
+    for(int i=0; i<NX; i++) buf[NX + i] = i;
+
+  mpi::broadcast(world, carr, 0);
+  mpi::broadcast(world, arr, 0);
+#if defined(__cpp_lib_span)
+  mpi::broadcast(world, std::span<long>(buf).subspan(NX), 0);
+#else
+  mpi::broadcast(world, buf.data() + NX, NX, 0);
+#endif
+
+  for(int i=0; i<NX; i++) {
+    assert(carr[i] == i);
+    assert(arr[i] == 0.5*i);
+    assert(buf[i] == -1);
+    assert(buf[NX + i] == i);
+  }
+
+  std::vector<float> raw(NX, world.rank() == 0 ? 7.0f : 0.0f);
+  mpi::broadcast(world, raw.data(), NX, 0);
+  for(auto v : raw) assert(v == 7.0f);
+
+  return true;
+}
+
+// vectors and strings are resized to the root's length
+bool test_dynamic(mpi::communicator& world)
+{
+  std::vector<Blob> blobs;
+  std::vector<int> empty(NX, 1);
+  std::string name;
+  if (world.rank() == 1) {
+    for(int i=0; i<NX; i++) blobs.push_back(Blob{i, float(i), {{0.0, 1.0, 2.0}} });
+    empty.clear();
+    name = "lookup table";
+  }
+
+  mpi::broadcast(world, blobs, 1);
+  mpi::broadcast(world, empty, 1);
+  mpi::broadcast(world, name, 1);
+
+  assert(blobs.size() == NX);
+  for(int i=0; i<NX; i++) assert(blobs[i].ivar == i && blobs[i].x[1] == 1.0);
+  assert(empty.empty());
+  assert(name == "lookup table");
+
+  return true;
+}
+
+// a column of a row-major matrix
+bool test_views(mpi::communicator& world)
+{
+  std::vector<double> mat(NX*NX, 0.0);
+  if (world.rank() == 0)
+    for(int i=0; i<NX; i++) mat[i*NX + 3] = i;
+
+  mpi::broadcast(world, mpi::strided_view<double>(mat.data() + 3, NX, 1, NX), 0);
+
+  for(int i=0; i<NX; i++)
+    for(int j=0; j<NX; j++)
+      assert(mat[i*NX + j] == (j == 3 ? i : 0.0));
+
+  return true;
+}
+
+
+int main(int argc, char* argv[])
+{
+  mpi::environment env(argc, argv);
+  mpi::communicator world;
+
+  bool f1 = test_scalars(world);
+  bool f2 = test_arrays(world);
+  bool f3 = test_dynamic(world);
+  bool f4 = test_views(world);
+
+  assert(f1 && f2 && f3 && f4);
+
+  std::cout << "success!\n";
+
+  return 0;
+}
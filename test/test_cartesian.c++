@@ -0,0 +1,114 @@
+// Copyright 2018 - 2026, Joonas Nättilä and the hel-astro-lab contributors
+// SPDX-License-Identifier: Apache-2.0
+
+#include <mpi4cpp/mpi.h>
+#include <iostream>
+
+#include <cassert>
+#include <functional>
+#include <vector>
+
+
+//--------------------------------------------------
+namespace mpi = mpi4cpp::mpi;
+
+
+// wrap c into [0, n) along periodic dimensions
+int wrap(int c, int n) { return ((c % n) + n) % n; }
+
+bool test_grid(mpi::communicator& world)
+{
+  int size = world.size();
+
+  std::vector<int> dims(3, 0);
+  mpi::cartesian_dimensions(size, dims);
+  assert(dims[0]*dims[1]*dims[2] == size);
+
+  // periodic in x and y, walls in z
+  mpi::cartesian_communicator grid(world, {{0, true}, {0, true}, {0, false}});
+  assert(grid);
+  assert(grid.size() == size);
+  assert(grid.ndims() == 3);
+  for(int d=0; d<3; d++) assert(grid.topology()[d].size == dims[d]);
+  assert(grid.topology()[0].periodic && !grid.topology()[2].periodic);
+
+  const std::vector<int>& coords = grid.coordinates();
+  assert(grid.coordinates(grid.rank()) == coords);
+  assert(grid.rank(coords) == grid.rank());
+
+  // the cached neighbour table agrees with MPI_Cart_rank
+  assert(grid.neighbors().size() == 26);
+  std::size_t i = 0;
+  for(int dx=-1; dx<=1; dx++)
+  for(int dy=-1; dy<=1; dy++)
+  for(int dz=-1; dz<=1; dz++) {
+    int z = coords[2] + dz;
+    int expected = mpi::proc_null;
+    if (z >= 0 && z < dims[2])
+      expected = grid.rank({wrap(coords[0] + dx, dims[0]), wrap(coords[1] + dy, dims[1]), z});
+
+    assert(grid.neighbor({dx, dy, dz}) == expected);
+    if (dx != 0 || dy != 0 || dz != 0) assert(grid.neighbors()[i++] == expected);
+  }
+
+  // cached shifts agree with MPI_Cart_shift
+  for(int d=0; d<3; d++) {
+    int source, dest;
+    for(int disp : {1, -1, 2}) {
+      MPI_Cart_shift(MPI_Comm(grid), d, disp, &source, &dest);
+      auto shifted = grid.shifted_ranks(d, disp);
+      assert(shifted.first == source && shifted.second == dest);
+    }
+  }
+
+  // send to the right in x, receive from the left
+  auto [left, right] = grid.shifted_ranks(0);
+  int from_left = -1;
+  grid.sendrecv(right, 0, grid.rank(), left, 0, from_left);
+  assert(from_left == left);
+
+  // pencils along x: all processes with the same y and z
+  mpi::cartesian_communicator pencil(grid, {0});
+  assert(pencil.ndims() == 1);
+  assert(pencil.size() == dims[0]);
+  assert(pencil.coordinates()[0] == coords[0]);
+  assert(pencil.topology()[0].periodic);
+
+  return true;
+}
+
+// processes that do not fit into the grid get no communicator
+bool test_partial_grid(mpi::communicator& world)
+{
+  int size = world.size();
+  if (size < 2) return true;
+
+  mpi::cartesian_communicator line(world, {{size - 1, false}});
+  int members = mpi::all_reduce(world, line ? 1 : 0, std::plus<int>());
+  assert(members == size - 1);
+
+  if (line) {
+    assert(line.size() == size - 1);
+    auto [lower, upper] = line.shifted_ranks(0);
+    assert(lower == (line.rank() == 0 ? mpi::proc_null : line.rank() - 1));
+    assert(upper == (line.rank() == size - 2 ? mpi::proc_null : line.rank() + 1));
+  }
+
+  return true;
+}
+
+
+int main(int argc, char* argv[])
+{
+  mpi::environment env(argc, argv);
+  mpi::communicator world;
+
+  bool f1 = test_grid(world);
+  bool f2 = test_partial_grid(world);
+
+  assert(f1 && f2);
+
+  std::cout << "success!\n";
+
+  return 0;
+}
@@ -0,0 +1,97 @@
+// Copyright 2018 - 2026, Joonas Nättilä and the hel-astro-lab contributors
+// SPDX-License-Identifier: Apache-2.0
+
+#include <mpi4cpp/mpi.h>
+#include <iostream>
+
+#include <cassert>
+
+
+//--------------------------------------------------
+namespace mpi = mpi4cpp::mpi;
+
+// constructed before MPI is initialized
+static mpi::communicator early;
+
+
+// cached values agree with MPI
+bool test_rank_size(mpi::communicator& world)
+{
+  int rank, size;
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &size);
+  assert(world.rank() == rank && world.size() == size);
+  assert(early.rank() == rank && early.size() == size);
+
+  // split off the odd ranks in reverse order
+  mpi::communicator odd = world.split(rank % 2, -rank);
+  int sub_rank, sub_size;
+  MPI_Comm_rank(MPI_Comm(odd), &sub_rank);
+  MPI_Comm_size(MPI_Comm(odd), &sub_size);
+  assert(odd.rank() == sub_rank && odd.size() == sub_size);
+  assert(odd.size() == (size + 1 - rank % 2)/2);
+
+  // attached handles are queried once, too
+  mpi::communicator self(MPI_COMM_SELF, mpi::comm_attach);
+  assert(self.rank() == 0 && self.size() == 1);
+
+  return true;
+}
+
+// node facts
+bool test_node(mpi::communicator& world)
+{
+  assert(world.node_rank() >= 0 && world.node_rank() < world.node_size());
+  assert(world.node_size() <= world.size());
+
+  // the node roots together count every process
+  int roots = mpi::all_reduce(world, world.node_rank() == 0 ? world.node_size() : 0,
+                              std::plus<int>());
+  assert(roots == world.size());
+
+  mpi::communicator shared = world.split_shared();
+  assert(shared.size() == world.node_size());
+  assert(shared.rank() == world.node_rank());
+  assert(shared.single_node());
+  assert(world.single_node() == (world.node_size() == world.size()));
+
+  // computed collectively on first use for adopted handles
+  MPI_Comm handle;
+  MPI_Comm_dup(MPI_COMM_WORLD, &handle);
+  mpi::communicator adopted(handle, mpi::comm_take_ownership);
+  assert(adopted.node_size() == world.node_size());
+
+  return true;
+}
+
+// copies share the cached state
+bool test_copies(mpi::communicator& world)
+{
+  mpi::communicator dup = world.dup();
+  mpi::communicator copy = dup;
+  assert(copy == dup && !(copy == world));
+  assert(copy.rank() == world.rank() && copy.size() == world.size());
+  assert(copy.node_rank() == world.node_rank());
+
+  mpi::communicator other;
+  assert(other == world && other.rank() == world.rank());
+
+  return true;
+}
+
+
+int main(int argc, char* argv[])
+{
+  mpi::environment env(argc, argv);
+  mpi::communicator world;
+
+  bool f1 = test_rank_size(world);
+  bool f2 = test_node(world);
+  bool f3 = test_copies(world);
+
+  assert(f1 && f2 && f3);
+
+  std::cout << "success!\n";
+
+  return 0;
+}
@@ -0,0 +1,116 @@
+// Copyright 2018 - 2026, Joonas Nättilä and the hel-astro-lab contributors
+// SPDX-License-Identifier: Apache-2.0
+
+#include <mpi4cpp/mpi.h>
+#include <iostream>
+
+#include <cassert>
+#include <functional>
+
+
+//--------------------------------------------------
+namespace mpi = mpi4cpp::mpi;
+
+
+bool test_create(mpi::communicator& world)
+{
+  // attaching does not take ownership
+  mpi::communicator attached(MPI_COMM_WORLD, mpi::comm_attach);
+  assert(attached == world);
+  assert(attached.rank() == world.rank());
+
+  mpi::communicator null(MPI_COMM_NULL, mpi::comm_duplicate);
+  assert(!null);
+
+  MPI_Comm raw;
+  MPI_Comm_dup(MPI_COMM_WORLD, &raw);
+  {
+    mpi::communicator owned(raw, mpi::comm_take_ownership);
+    assert(owned != world);
+    assert(owned.size() == world.size());
+  } // frees raw
+
+  mpi::communicator dup(MPI_COMM_WORLD, mpi::comm_duplicate);
+  assert(dup.size() == world.size() && dup != world);
+
+  return true;
+}
+
+// a duplicate is a separate tag space
+bool test_dup(mpi::communicator& world)
+{
+  int rank = world.rank();
+  int size = world.size();
+  if (size < 2) return true;
+
+  mpi::communicator lib = world.dup();
+  assert(lib.rank() == rank);
+
+  if (rank == 0) {
+    world.send(1, 0, 1);
+    lib.send(1, 0, 2);
+  } else if (rank == 1) {
+    int from_lib = 0, from_world = 0;
+    lib.recv(0, mpi::any_tag, from_lib);
+    world.recv(0, mpi::any_tag, from_world);
+    assert(from_lib == 2 && from_world == 1);
+  }
+
+  return true;
+}
+
+bool test_split(mpi::communicator& world)
+{
+  int rank = world.rank();
+  int size = world.size();
+
+  // even and odd ranks
+  mpi::communicator half = world.split(rank % 2);
+  assert(half.size() == (size + 1 - rank % 2)/2);
+  assert(half.rank() == rank/2);
+
+  // reversed order
+  mpi::communicator reversed = world.split(0, size - rank);
+  assert(reversed.rank() == size - 1 - rank);
+
+  // leave out rank 0
+  mpi::communicator rest = world.split(rank == 0 ? MPI_UNDEFINED : 1);
+  assert(bool(rest) == (rank != 0));
+  if (rest) assert(rest.size() == size - 1);
+
+  // querying the invalid communicator throws instead of crashing
+  bool thrown = false;
+  try {
+    rest.rank();
+  } catch (const mpi::MPI_Invalid_Comm_Error&) {
+    thrown = true;
+  }
+  assert(thrown == !rest);
+
+  // all processes of a test run share a node
+  mpi::communicator node = world.split_shared();
+  int total = mpi::all_reduce(world, node.rank() == 0 ? node.size() : 0, std::plus<int>());
+  assert(total == size);
+
+  mpi::communicator typed = world.split_type(MPI_COMM_TYPE_SHARED, size - rank);
+  assert(typed.size() == node.size());
+
+  return true;
+}
+
+
+int main(int argc, char* argv[])
+{
+  mpi::environment env(argc, argv);
+  mpi::communicator world;
+
+  bool f1 = test_create(world);
+  bool f2 = test_dup(world);
+  bool f3 = test_split(world);
+
+  assert(f1 && f2 && f3);
+
+  std::cout << "success!\n";
+
+  return 0;
+}
@@ -0,0 +1,138 @@
+// Copyright 2018 - 2026, Joonas Nättilä and the hel-astro-lab contributors
+// SPDX-License-Identifier: Apache-2.0
+
+#include <mpi4cpp/mpi.h>
+#include <iostream>
+
+#include <cassert>
+#include <vector>
+
+namespace mpi = mpi4cpp::mpi;
+
+#ifdef MPI4CPP_HAS_COROUTINES
+
+#define NTILES 200
+#define NX 16
+
+struct Tile
+{
+  int id;
+  std::vector<double> boundary;
+  std::vector<double> halo;
+  int steps{0};
+};
+
+// straight-line exchange of one tile with its neighbour on the ring
+mpi::task update(mpi::communicator& world, Tile& t, int nsteps)
+{
+  int rank = world.rank();
+  int size = world.size();
+  int right = (rank + 1) % size;
+  int left  = (rank + size - 1) % size;
+
+  for(int step=0; step<nsteps; step++) {
+    int tag = step*NTILES + t.id;
+    mpi::request send = world.isend(right, tag, t.boundary);
+    mpi::status stat = co_await world.irecv(left, tag, t.halo);
+    assert(stat.source() == left && stat.tag() == tag);
+    assert(t.halo.size() == std::size_t(NX + t.id % 3));
+
+    for(auto& v : t.boundary) v += 1.0;
+    co_await std::move(send);
+    t.steps++;
+  }
+}
+
+bool test_tiles(mpi::communicator& world)
+{
+  int rank = world.rank();
+  int size = world.size();
+  int left = (rank + size - 1) % size;
+
+  std::vector<Tile> tiles;
+  for(int i=0; i<NTILES; i++)
+    tiles.push_back(Tile{i, std::vector<double>(NX + i % 3, rank + i), {}});
+
+  mpi::scheduler sched;
+  for(auto& t : tiles) sched.spawn(update(world, t, 3));
+  assert(sched.size() <= NTILES);
+
+  // make progress in between other work, then finish
+  sched.poll();
+  sched.run();
+  assert(sched.empty());
+
+  for(auto& t : tiles) {
+    assert(t.steps == 3);
+    // the last halo was sent after two updates
+    for(auto v : t.halo) assert(v == left + t.id + 2.0);
+  }
+
+  return true;
+}
+
+mpi::task receive_then(mpi::communicator& world, int& value, int& calls)
+{
+  int left = (world.rank() + world.size() - 1) % world.size();
+  co_await world.irecv(left, 7, value).then([&](const mpi::status&) {
+    assert(value == left);
+    calls++;
+  });
+  // the continuation has run before the task resumes
+  assert(calls == 1);
+  calls++;
+}
+
+// a continuation of an awaited request is kept
+bool test_continuation(mpi::communicator& world)
+{
+  int rank = world.rank();
+  int right = (rank + 1) % world.size();
+
+  int value = -1, calls = 0;
+  mpi::scheduler sched;
+  sched.spawn(receive_then(world, value, calls));
+
+  // the task is parked until the value is sent
+  world.barrier();
+  mpi::request send = world.isend(right, 7, rank);
+  sched.run();
+  send.wait();
+
+  assert(calls == 2);
+
+  return true;
+}
+
+// tasks that are never spawned do not run
+bool test_unstarted(mpi::communicator& world)
+{
+  Tile t{0, {}, {}};
+  {
+    mpi::task unused = update(world, t, 1);
+  }
+  assert(t.steps == 0);
+
+  return true;
+}
+
+#endif
+
+
+int main(int argc, char* argv[])
+{
+  mpi::environment env(argc, argv);
+  mpi::communicator world;
+
+#ifdef MPI4CPP_HAS_COROUTINES
+  bool f1 = test_tiles(world);
+  bool f2 = test_unstarted(world);
+  bool f3 = test_continuation(world);
+
+  assert(f1 && f2 && f3);
+#endif
+
+  std::cout << "success!\n";
+
+  return 0;
+}
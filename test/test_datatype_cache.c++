@@ -0,0 +1,111 @@
+// Copyright 2018 - 2026, Joonas Nättilä and the hel-astro-lab contributors
+// SPDX-License-Identifier: Apache-2.0
+
+#include <mpi4cpp/mpi.h>
+#include <iostream>
+
+#include <array>
+#include <cassert>
+#include <thread>
+#include <vector>
+
+
+struct Blob
+{
+  int ivar;
+  float var;
+  std::array<double,3> x;
+};
+
+struct Pair
+{
+  Blob first;
+  Blob second;
+};
+
+MPI4CPP_STRUCT(Blob, ivar, var, x)
+MPI4CPP_STRUCT(Pair, first, second)
+
+//--------------------------------------------------
+namespace mpi = mpi4cpp::mpi;
+
+#define NTHREADS 4
+
+
+// lookups hit the per-type slot; clear() empties every slot
+bool test_slots(mpi::communicator& /*world*/)
+{
+  auto& cache = mpi::detail::mpi_datatype_cache();
+
+  assert(cache.get<Pair>() == MPI_DATATYPE_NULL);
+  MPI_Datatype pair = mpi::get_mpi_datatype<Pair>();
+  assert(cache.get<Pair>() == pair);
+  assert(cache.get<Blob>() != MPI_DATATYPE_NULL); // built for its member
+  assert(mpi::get_mpi_datatype<Pair>() == pair);
+
+  MPI_Datatype boolean = mpi::get_mpi_datatype<bool>();
+  assert(cache.get<bool>() == boolean);
+
+  cache.clear();
+  assert(cache.get<Pair>() == MPI_DATATYPE_NULL);
+  assert(cache.get<Blob>() == MPI_DATATYPE_NULL);
+  assert(cache.get<bool>() == MPI_DATATYPE_NULL);
+
+  // and rebuilt on next use
+  assert(mpi::get_mpi_datatype<Pair>() != MPI_DATATYPE_NULL);
+
+  return true;
+}
+
+// many threads racing for the first use get the same datatype
+bool test_threads(mpi::communicator& world)
+{
+  mpi::detail::mpi_datatype_cache().clear();
+
+  int other = 1 - world.rank();
+  std::array<MPI_Datatype, NTHREADS> types;
+  std::array<Blob, NTHREADS> sblobs, rblobs;
+
+  std::vector<std::thread> threads;
+  for(int t=0; t<NTHREADS; t++) {
+    threads.emplace_back([&, t]() {
+      types[t] = mpi::get_mpi_datatype<Blob>();
+
+      sblobs[t] = Blob{world.rank(), float(t), {{1.0, 2.0, 3.0}} };
+      mpi::request reqs[2] = {
+        world.isend(other, t, sblobs[t]),
+        world.irecv(other, t, rblobs[t]),
+      };
+      mpi::wait_all(reqs, reqs + 2);
+    });
+  }
+  for(auto& th : threads) th.join();
+
+  for(int t=0; t<NTHREADS; t++) {
+    assert(types[t] == types[0]);
+    assert(rblobs[t].ivar == other);
+    assert(rblobs[t].var == float(t));
+    assert(rblobs[t].x[2] == 3.0);
+  }
+
+  return true;
+}
+
+
+int main(int argc, char* argv[])
+{
+  mpi::environment env(argc, argv, mpi::threading::multiple);
+  mpi::communicator world;
+
+  bool f1 = test_slots(world);
+  assert(f1);
+
+  if (mpi::environment::thread_level() == mpi::threading::multiple) {
+    bool f2 = test_threads(world);
+    assert(f2);
+  }
+
+  std::cout << "success!\n";
+
+  return 0;
+}
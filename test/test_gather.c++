@@ -0,0 +1,169 @@
+// Copyright 2018 - 2026, Joonas Nättilä and the hel-astro-lab contributors
+// SPDX-License-Identifier: Apache-2.0
+
+#include <mpi4cpp/mpi.h>
+#include <iostream>
+
+#include <array>
+#include <cassert>
+#include <vector>
+
+
+struct Blob
+{
+  int ivar;
+  float var;
+  std::array<double,3> x;
+};
+
+MPI4CPP_STRUCT(Blob, ivar, var, x)
+
+//--------------------------------------------------
+namespace mpi = mpi4cpp::mpi;
+
+#define NX 10
+
+
+bool test_gather(mpi::communicator& world)
+{
+  int rank = world.rank();
+  int size = world.size();
+
+  for(int root=0; root<size; root++) {
+    std::vector<int> ranks;
+    Blob blob{rank, 0.5f*rank, {{1.0, 2.0, 3.0}} };
+    std::vector<Blob> blobs;
+
+    if (rank == root) {
+      mpi::gather(world, rank, ranks, root);
+      mpi::gather(world, blob, blobs, root);
+
+      assert(int(ranks.size()) == size);
+      assert(int(blobs.size()) == size);
+      for(int r=0; r<size; r++) {
+        assert(ranks[r] == r);
+        assert(blobs[r].ivar == r && blobs[r].var == 0.5f*r);
+      }
+    } else {
+      mpi::gather(world, rank, root);
+      mpi::gather(world, blob, blobs, root);
+      assert(blobs.empty());
+    }
+  }
+
+  // arrays of the same length
+  std::vector<double> arr(NX), all;
+  for(int i=0; i<NX; i++) arr[i] = rank*NX + i;
+
+  if (rank == 0) {
+    mpi::gather(world, arr.data(), NX, all, 0);
+    assert(int(all.size()) == size*NX);
+    for(int i=0; i<size*NX; i++) assert(all[i] == i);
+  } else
+    mpi::gather(world, arr.data(), NX, 0);
+
+  return true;
+}
+
+bool test_all_gather(mpi::communicator& world)
+{
+  int rank = world.rank();
+  int size = world.size();
+
+  std::vector<long> ranks;
+  mpi::all_gather(world, long(rank), ranks);
+  assert(int(ranks.size()) == size);
+  for(int r=0; r<size; r++) assert(ranks[r] == r);
+
+  std::array<float,NX> arr;
+  arr.fill(float(rank));
+  std::vector<float> all(size*NX);
+  mpi::all_gather(world, arr.data(), NX, all.data());
+  for(int i=0; i<size*NX; i++) assert(all[i] == float(i/NX));
+
+  return true;
+}
+
+// per-rank diagnostics of varying length
+bool test_gatherv(mpi::communicator& world)
+{
+  int rank = world.rank();
+  int size = world.size();
+
+  // rank r contributes r+1 values, then r values (none from rank 0)
+  for(int round=0; round<2; round++) {
+    std::vector<int> diag(rank + 1 - round, rank);
+
+    std::vector<int> flat;
+    std::vector<std::size_t> offsets;
+    std::vector<std::vector<int>> nested;
+
+    if (rank == 0) {
+      mpi::gatherv(world, diag, flat, offsets, 0);
+      mpi::gatherv(world, diag, nested, 0);
+
+      assert(int(offsets.size()) == size + 1);
+      assert(offsets.back() == flat.size());
+      assert(int(nested.size()) == size);
+      for(int r=0; r<size; r++) {
+        std::size_t len = r + 1 - round;
+        assert(offsets[r+1] - offsets[r] == len);
+        assert(nested[r].size() == len);
+        for(std::size_t i=offsets[r]; i<offsets[r+1]; i++) assert(flat[i] == r);
+        for(auto v : nested[r]) assert(v == r);
+      }
+    } else {
+      mpi::gatherv(world, diag, 0);
+      mpi::gatherv(world, diag, nested, 0);
+      assert(nested.empty());
+    }
+  }
+
+  return true;
+}
+
+bool test_all_gatherv(mpi::communicator& world)
+{
+  int rank = world.rank();
+  int size = world.size();
+
+  std::vector<Blob> mine;
+  for(int i=0; i<2*rank+1; i++) mine.push_back(Blob{rank, float(i), {{0.0, 0.0, 0.0}} });
+
+  std::vector<Blob> flat;
+  std::vector<std::size_t> offsets;
+  mpi::all_gatherv(world, mine, flat, offsets);
+
+  std::vector<std::vector<Blob>> nested;
+  mpi::all_gatherv(world, mine, nested);
+
+  assert(int(nested.size()) == size);
+  for(int r=0; r<size; r++) {
+    assert(offsets[r+1] - offsets[r] == std::size_t(2*r+1));
+    assert(nested[r].size() == std::size_t(2*r+1));
+    for(int i=0; i<2*r+1; i++) {
+      assert(flat[offsets[r] + i].ivar == r && flat[offsets[r] + i].var == float(i));
+      assert(nested[r][i].ivar == r && nested[r][i].var == float(i));
+    }
+  }
+
+  return true;
+}
+
+
+int main(int argc, char* argv[])
+{
+  mpi::environment env(argc, argv);
+  mpi::communicator world;
+
+  bool f1 = test_gather(world);
+  bool f2 = test_all_gather(world);
+  bool f3 = test_gatherv(world);
+  bool f4 = test_all_gatherv(world);
+
+  assert(f1 && f2 && f3 && f4);
+
+  std::cout << "success!\n";
+
+  return 0;
+}
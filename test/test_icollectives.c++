@@ -0,0 +1,200 @@
+// Copyright 2018 - 2026, Joonas Nättilä and the hel-astro-lab contributors
+// SPDX-License-Identifier: Apache-2.0
+
+#include <mpi4cpp/mpi.h>
+#include <iostream>
+
+#include <array>
+#include <cassert>
+#include <functional>
+#include <string>
+#include <vector>
+
+
+struct Vec3
+{
+  double x, y, z;
+};
+
+MPI4CPP_STRUCT(Vec3, x, y, z)
+
+//--------------------------------------------------
+namespace mpi = mpi4cpp::mpi;
+
+#define NX 10
+
+
+bool test_ibroadcast(mpi::communicator& world)
+{
+  int rank = world.rank();
+
+  int value = rank == 1 ? 42 : 0;
+  std::array<double,NX> arr;
+  arr.fill(rank == 0 ? 1.5 : 0.0);
+
+  std::vector<mpi::request> reqs;
+  reqs.push_back(mpi::ibroadcast(world, value, 1));
+  reqs.push_back(mpi::ibroadcast(world, arr, 0));
+  mpi::wait_all(reqs.begin(), reqs.end());
+
+  assert(value == 42);
+  for(auto v : arr) assert(v == 1.5);
+
+  // the size is not known on the other processes
+  std::vector<Vec3> vec;
+  if (rank == 0)
+    for(int i=0; i<NX; i++) vec.push_back(Vec3{double(i), 0.0, 0.0});
+  mpi::request req = mpi::ibroadcast(world, vec, 0);
+  while (!req.test()) {}
+  assert(vec.size() == NX);
+  for(int i=0; i<NX; i++) assert(vec[i].x == i);
+
+  std::string str = rank == 1 ? "hello halo" : "";
+  mpi::ibroadcast(world, str, 1).wait();
+  assert(str == "hello halo");
+
+  return true;
+}
+
+bool test_ireduce(mpi::communicator& world)
+{
+  int rank = world.rank();
+  int size = world.size();
+
+  double local = rank + 1.0, total = 0.0;
+  mpi::request req = mpi::iall_reduce(world, local, total, std::plus<>());
+
+  // overlap with local work
+  std::vector<int> work(NX*NX, rank);
+  long sum = 0;
+  for(auto w : work) sum += w;
+  assert(sum == NX*NX*rank);
+
+  req.wait();
+  assert(total == size*(size + 1)/2.0);
+
+  // in place, user-defined operation on a user type
+  auto vsum = [](const Vec3& a, const Vec3& b) {
+    return Vec3{a.x + b.x, a.y + b.y, a.z + b.z};
+  };
+  std::vector<Vec3> vin(NX, Vec3{1.0, double(rank), 0.0}), vout;
+  mpi::iall_reduce(world, vin, vout, vsum).wait();
+  assert(vout.size() == NX);
+  for(auto& v : vout) assert(v.x == size && v.y == size*(size - 1)/2.0);
+
+  std::vector<int> ints(NX, rank);
+  mpi::iall_reduce(world, ints.data(), NX, ints.data(), mpi::maximum<>()).wait();
+  for(auto v : ints) assert(v == size - 1);
+
+  for(int root=0; root<size; root++) {
+    long prod = 0;
+    mpi::ireduce(world, long(rank + 1), prod, std::multiplies<long>(), root).wait();
+    if (rank == root) {
+      long expected = 1;
+      for(int i=1; i<=size; i++) expected *= i;
+      assert(prod == expected);
+    }
+  }
+
+  return true;
+}
+
+bool test_igather_all_to_all(mpi::communicator& world)
+{
+  int rank = world.rank();
+  int size = world.size();
+
+  std::vector<int> ranks;
+  std::vector<int> in(size), out;
+  for(int r=0; r<size; r++) in[r] = 100*rank + r;
+
+  std::vector<mpi::request> reqs;
+  reqs.push_back(mpi::iall_gather(world, rank, ranks));
+  reqs.push_back(mpi::iall_to_all(world, in, out));
+  reqs.push_back(mpi::ibarrier(world));
+
+  std::vector<mpi::request>::iterator done = reqs.end();
+  while (done == reqs.end())
+    done = mpi::test_some(reqs.begin(), reqs.end());
+  mpi::wait_all(reqs.begin(), done);
+
+  for(int r=0; r<size; r++) {
+    assert(ranks[r] == r);
+    assert(out[r] == 100*r + rank);
+  }
+
+  // rank s sends s + r values to rank r
+  std::vector<std::vector<long>> buckets(size);
+  for(int r=0; r<size; r++) buckets[r].assign(rank + r, rank);
+
+  mpi::all_to_allv_buffer<long> incoming;
+  mpi::request req = mpi::iall_to_allv(world, buckets, incoming);
+  buckets.clear(); // staged in the buffer
+  req.wait();
+
+  for(int s=0; s<size; s++) {
+    assert(incoming.count(s) == std::size_t(s + rank));
+    for(auto p = incoming.begin(s); p != incoming.end(s); ++p) assert(*p == s);
+  }
+
+  return true;
+}
+
+bool test_two_step_interleaved(mpi::communicator& world)
+{
+  int rank = world.rank();
+  int size = world.size();
+
+  std::vector<double> vec;
+  if (rank == 0) vec.assign(NX, 1.5);
+  mpi::request bcast = mpi::ibroadcast(world, vec, 0);
+
+  std::vector<std::vector<int>> buckets(size);
+  for(int r=0; r<size; r++) buckets[r].assign(r + 1, rank);
+  mpi::all_to_allv_buffer<int> incoming;
+  mpi::request exchange = mpi::iall_to_allv(world, buckets, incoming);
+
+  // other collectives go on before the payloads have been posted
+  int value = rank == 0 ? 42 : 0;
+  mpi::broadcast(world, value, 0);
+  assert(value == 42);
+  int sum = 0;
+  mpi::iall_reduce(world, 1, sum, std::plus<int>()).wait();
+  assert(sum == size);
+
+  // and the processes complete the two step requests in different orders
+  if (rank % 2 == 0) {
+    bcast.wait();
+    exchange.wait();
+  } else {
+    exchange.wait();
+    bcast.wait();
+  }
+
+  assert(vec.size() == NX);
+  for(auto v : vec) assert(v == 1.5);
+  for(int s=0; s<size; s++) {
+    assert(incoming.count(s) == std::size_t(rank + 1));
+    for(auto p = incoming.begin(s); p != incoming.end(s); ++p) assert(*p == s);
+  }
+
+  return true;
+}
+
+
+int main(int argc, char* argv[])
+{
+  mpi::environment env(argc, argv);
+  mpi::communicator world;
+
+  bool f1 = test_ibroadcast(world);
+  bool f2 = test_ireduce(world);
+  bool f3 = test_igather_all_to_all(world);
+  bool f4 = test_two_step_interleaved(world);
+
+  assert(f1 && f2 && f3 && f4);
+
+  std::cout << "success!\n";
+
+  return 0;
+}
@@ -0,0 +1,92 @@
+// Copyright 2018 - 2026, Joonas Nättilä and the hel-astro-lab contributors
+// SPDX-License-Identifier: Apache-2.0
+
+#include <mpi4cpp/mpi.h>
+#include <iostream>
+
+#include <cassert>
+#include <memory>
+#include <vector>
+
+namespace mpi = mpi4cpp::mpi;
+
+using requests = std::vector<mpi::request>;
+
+
+#define NX 1000
+
+// the request owns the vector; no copy is made
+bool test_moved_vector(mpi::communicator& world)
+{
+  if (world.rank() == 0) {
+    requests reqs;
+    {
+      std::vector<double> msg(NX, 1.0);
+      const double* buffer = msg.data();
+      reqs.push_back( world.isend(1, 0, std::move(msg)) );
+      assert(reqs.back().data<std::vector<double>>()->data() == buffer);
+    }
+    // temporaries are fine too
+    reqs.push_back( world.isend(1, 1, std::vector<double>(NX, 2.0)) );
+    mpi::wait_all(reqs.begin(), reqs.end());
+  } else {
+    std::vector<double> msg0, msg1;
+    world.recv(0, 0, msg0);
+    world.recv(0, 1, msg1);
+    assert(msg0.size() == NX && msg1.size() == NX);
+    for(int i=0; i<NX; i++) assert(msg0[i] == 1.0 && msg1[i] == 2.0);
+  }
+
+  return true;
+}
+
+// shared buffers stay alive while in flight
+bool test_shared(mpi::communicator& world)
+{
+  if (world.rank() == 0) {
+    requests reqs;
+    {
+      auto val = std::make_shared<const int>(42);
+      reqs.push_back( world.isend(1, 0, val) );
+
+      auto vec = std::make_shared<std::vector<float>>(NX, 3.0f);
+      reqs.push_back( world.isend(1, 1, vec) );
+
+      std::shared_ptr<long> arr(new long[NX], std::default_delete<long[]>());
+      for(int i=0; i<NX; i++) arr.get()[i] = i;
+      reqs.push_back( world.isend(1, 2, arr, NX) );
+    }
+    mpi::wait_all(reqs.begin(), reqs.end());
+  } else {
+    int val;
+    world.recv(0, 0, val);
+    assert(val == 42);
+
+    std::vector<float> vec;
+    world.recv(0, 1, vec);
+    assert(vec.size() == NX);
+    for(auto v : vec) assert(v == 3.0f);
+
+    std::vector<long> arr(NX);
+    world.recv(0, 2, arr.data(), NX);
+    for(int i=0; i<NX; i++) assert(arr[i] == i);
+  }
+
+  return true;
+}
+
+
+int main(int argc, char* argv[])
+{
+  mpi::environment env(argc, argv);
+  mpi::communicator world;
+
+  bool f1 = test_moved_vector(world);
+  bool f2 = test_shared(world);
+
+  assert(f1 && f2);
+
+  std::cout << "success!\n";
+
+  return 0;
+}
@@ -0,0 +1,161 @@
+// Copyright 2018 - 2026, Joonas Nättilä and the hel-astro-lab contributors
+// SPDX-License-Identifier: Apache-2.0
+
+// Lower the int count limit so that the large count code paths are
+// exercised without multi-gigabyte buffers.
+#define MPI4CPP_MAX_COUNT 1000
+
+#include <mpi4cpp/mpi.h>
+#include <iostream>
+
+#include <cassert>
+#include <functional>
+#include <vector>
+
+namespace mpi = mpi4cpp::mpi;
+
+using requests = std::vector<mpi::request>;
+
+
+// not a multiple of the block size
+#define NX 2555
+
+template<typename T>
+bool test_blocking(mpi::communicator& world)
+{
+  std::vector<T> msg(NX);
+
+  if (world.rank() == 0) {
+    for(int i=0; i<NX; i++) msg[i] = static_cast<T>(i % 100);
+    world.send(1, 0, msg.data(), NX);
+    world.send(1, 1, msg);
+  } else {
+    world.recv(0, 0, msg.data(), NX);
+    for(int i=0; i<NX; i++) assert(msg[i] == static_cast<T>(i % 100));
+
+    std::vector<T> rmsg;
+    mpi::status stat = world.recv(0, 1, rmsg);
+    assert(*stat.count<T>() == NX);
+    assert(rmsg == msg);
+  }
+
+  return true;
+}
+
+template<typename T>
+bool test_nonblocking(mpi::communicator& world)
+{
+  std::vector<T> smsg(NX, static_cast<T>(world.rank() + 1));
+  std::vector<T> rmsg0(NX), rmsg1;
+  int other = 1 - world.rank();
+
+  requests reqs(4);
+  reqs[0] = world.isend(other, 0, smsg.data(), NX);
+  reqs[1] = world.isend(other, 1, smsg);
+  reqs[2] = world.irecv(other, 0, rmsg0.data(), NX);
+  reqs[3] = world.irecv(other, 1, rmsg1);
+  mpi::wait_all(reqs.begin(), reqs.end());
+
+  assert(rmsg1.size() == NX);
+  for(int i=0; i<NX; i++) {
+    assert(rmsg0[i] == static_cast<T>(other + 1));
+    assert(rmsg1[i] == static_cast<T>(other + 1));
+  }
+
+  return true;
+}
+
+template<typename T>
+bool test_sendrecv(mpi::communicator& world)
+{
+  std::vector<T> smsg(NX, static_cast<T>(world.rank() + 1));
+  std::vector<T> rmsg(NX);
+  int other = 1 - world.rank();
+
+  world.sendrecv(other, 0, smsg.data(), NX, other, 0, rmsg.data(), NX);
+  for(auto v : rmsg) assert(v == static_cast<T>(other + 1));
+
+  world.sendrecv_replace(other, 0, other, 0, smsg.data(), NX);
+  for(auto v : smsg) assert(v == static_cast<T>(other + 1));
+
+  return true;
+}
+
+// reductions are split into chunks of at most MPI4CPP_MAX_COUNT
+template<typename T>
+bool test_collectives(mpi::communicator& world)
+{
+  std::vector<T> msg;
+  if (world.rank() == 0) msg.assign(NX, static_cast<T>(5));
+  mpi::broadcast(world, msg, 0);
+  assert(msg.size() == NX);
+  for(auto v : msg) assert(v == static_cast<T>(5));
+
+  std::vector<T> in(NX, static_cast<T>(world.rank() + 1)), out;
+  mpi::all_reduce(world, in, out, std::plus<T>());
+  assert(out.size() == NX);
+  for(auto v : out) assert(v == static_cast<T>(3));
+
+  // the displacements of the vector variants are ints; every process
+  // finds that the gathered layout does not fit
+  std::vector<T> part(600, static_cast<T>(1)), all;
+  std::vector<std::size_t> offsets;
+  bool thrown = false;
+  try {
+    mpi::all_gatherv(world, part, all, offsets);
+  } catch (const mpi::MPI_Count_Overflow_Error&) {
+    thrown = true;
+  }
+  assert(thrown == (600*world.size() > MPI4CPP_MAX_COUNT));
+
+  // only the root has the layout, yet all processes throw
+  std::vector<T> gathered;
+  thrown = false;
+  try {
+    mpi::gatherv(world, part, gathered, offsets, 0);
+  } catch (const mpi::MPI_Count_Overflow_Error&) {
+    thrown = true;
+  }
+  assert(thrown == (600*world.size() > MPI4CPP_MAX_COUNT));
+
+  // only process 0 receives too much
+  std::vector<std::size_t> sizes(world.size(), 1);
+  sizes[0] = 600;
+  std::vector<T> packed(600 + world.size() - 1, static_cast<T>(1));
+  mpi::all_to_allv_buffer<T> incoming;
+  thrown = false;
+  try {
+    mpi::all_to_allv(world, packed, sizes, incoming);
+  } catch (const mpi::MPI_Count_Overflow_Error&) {
+    thrown = true;
+  }
+  assert(thrown == (600*world.size() > MPI4CPP_MAX_COUNT));
+
+  return true;
+}
+
+template<typename T>
+bool test_all(mpi::communicator& world)
+{
+  bool f1 = test_blocking<T>(world);
+  bool f2 = test_nonblocking<T>(world);
+  bool f3 = test_sendrecv<T>(world);
+  bool f4 = test_collectives<T>(world);
+
+  return f1 && f2 && f3 && f4;
+}
+
+
+int main(int argc, char* argv[])
+{
+  mpi::environment env(argc, argv);
+  mpi::communicator world;
+
+  test_all<char>(world);
+  test_all<int>(world);
+  test_all<double>(world);
+
+  std::cout << "success!\n";
+
+  return 0;
+}
@@ -0,0 +1,179 @@
+// Copyright 2018 - 2026, Joonas Nättilä and the hel-astro-lab contributors
+// SPDX-License-Identifier: Apache-2.0
+
+#include <mpi4cpp/mpi.h>
+#include <iostream>
+
+#include <cassert>
+#include <vector>
+
+
+//--------------------------------------------------
+namespace mpi = mpi4cpp::mpi;
+
+#define NX 6
+#define NY 5
+#define NSTEPS 3
+
+
+bool test_cartesian(mpi::communicator& world)
+{
+  // periodic ring
+  mpi::cartesian_communicator ring(world, {{0, true}});
+  auto [lower, upper] = ring.shifted_ranks(0);
+  assert(ring.sources().size() == 2);
+
+  std::vector<int> ranks;
+  mpi::neighbor_all_gather(ring, ring.rank(), ranks);
+  assert(ranks.size() == 2 && ranks[0] == lower && ranks[1] == upper);
+
+  // what went to the lower neighbour arrives from the upper one
+  std::vector<int> in{10*ring.rank(), 10*ring.rank() + 1}, out;
+  mpi::neighbor_all_to_all(ring, in, out);
+  assert(out[0] == 10*lower + 1 && out[1] == 10*upper);
+
+  // open line: nothing arrives from beyond the ends
+  mpi::cartesian_communicator line(world, {{0, false}});
+  int rank = line.rank(), size = line.size();
+  std::vector<std::vector<long>> buckets{std::vector<long>(rank + 1, rank),
+                                         std::vector<long>(rank + 2, rank)};
+  mpi::all_to_allv_buffer<long> incoming;
+  mpi::neighbor_all_to_allv(line, buckets, incoming);
+
+  assert(incoming.count(0) == (rank == 0 ? 0 : std::size_t(rank - 1 + 2)));
+  assert(incoming.count(1) == (rank == size - 1 ? 0 : std::size_t(rank + 1 + 1)));
+  for(auto p = incoming.begin(0); p != incoming.end(0); ++p) assert(*p == rank - 1);
+  for(auto p = incoming.begin(1); p != incoming.end(1); ++p) assert(*p == rank + 1);
+
+  return true;
+}
+
+bool test_graph(mpi::communicator& world)
+{
+  int rank = world.rank();
+  int size = world.size();
+
+  // send to the next two processes, receive from the previous two
+  int next1 = (rank + 1) % size, next2 = (rank + 2) % size;
+  int prev1 = (rank - 1 + size) % size, prev2 = (rank - 2 + 2*size) % size;
+  mpi::graph_communicator graph(world, {prev1, prev2}, {next1, next2});
+
+  assert(graph.size() == size);
+  assert(graph.sources() == std::vector<int>({prev1, prev2}));
+  assert(graph.destinations() == std::vector<int>({next1, next2}));
+
+  std::vector<int> in{100*rank, 100*rank + 1}, out;
+  mpi::neighbor_all_to_all(graph, in, out);
+  assert(out.size() == 2 && out[0] == 100*prev1 && out[1] == 100*prev2 + 1);
+
+  mpi::ineighbor_all_to_all(graph, in, out).wait();
+  assert(out[0] == 100*prev1 && out[1] == 100*prev2 + 1);
+
+  std::vector<double> all(2*NX);
+  std::vector<double> mine(NX, rank);
+  mpi::ineighbor_all_gather(graph, mine.data(), NX, all.data()).wait();
+  for(int i=0; i<NX; i++) assert(all[i] == prev1 && all[NX + i] == prev2);
+
+  // sizes differ every step
+  mpi::all_to_allv_buffer<int> incoming;
+  for(int step=0; step<NSTEPS; step++) {
+    std::vector<std::vector<int>> buckets{std::vector<int>(step, rank),
+                                          std::vector<int>(step + rank, rank)};
+    mpi::request req = mpi::ineighbor_all_to_allv(graph, buckets, incoming);
+    while (!req.test()) {}
+
+    assert(incoming.count(0) == std::size_t(step));
+    assert(incoming.count(1) == std::size_t(step + prev2));
+    for(auto v : incoming.values) assert(v == prev1 || v == prev2);
+  }
+
+  // fixed sizes: 1 + rank values to next1, 2 to next2
+  std::vector<std::size_t> sizes{std::size_t(1 + rank), 2};
+  std::vector<int> packed(3 + rank);
+  mpi::all_to_allv_buffer<int> fixed;
+  mpi::persistent_request exchange =
+    mpi::neighbor_all_to_allv_init(graph, packed, sizes, fixed);
+  for(int step=0; step<NSTEPS; step++) {
+    for(auto& v : packed) v = 100*step + rank;
+    exchange.start();
+    exchange.wait();
+
+    assert(fixed.count(0) == std::size_t(1 + prev1) && fixed.count(1) == 2);
+    for(auto p = fixed.begin(0); p != fixed.end(0); ++p) assert(*p == 100*step + prev1);
+    for(auto p = fixed.begin(1); p != fixed.end(1); ++p) assert(*p == 100*step + prev2);
+  }
+
+  mpi::all_to_allv_buffer<int> once;
+  mpi::ineighbor_all_to_allv(graph, packed, sizes, once).wait();
+  assert(once.values == fixed.values);
+
+  return true;
+}
+
+// halo exchange of the faces of a 2D field with subarray views
+bool test_halo(mpi::communicator& world)
+{
+  mpi::cartesian_communicator grid(world, {{0, true}, {0, true}});
+  int rank = grid.rank();
+
+  // (NX+2) x (NY+2) with one ghost layer
+  const int sx = NX + 2, sy = NY + 2;
+  std::vector<double> field(sx*sy, -1.0);
+
+  using face = mpi::subarray<double,2>;
+  std::vector<face> send{
+    face(field.data(), {sx, sy}, {1, NY}, {1,  1}),      // to x lower
+    face(field.data(), {sx, sy}, {1, NY}, {NX, 1}),      // to x upper
+    face(field.data(), {sx, sy}, {NX, 1}, {1,  1}),      // to y lower
+    face(field.data(), {sx, sy}, {NX, 1}, {1,  NY}) };   // to y upper
+  std::vector<face> recv{
+    face(field.data(), {sx, sy}, {1, NY}, {0,      1}),  // from x lower
+    face(field.data(), {sx, sy}, {1, NY}, {NX + 1, 1}),  // from x upper
+    face(field.data(), {sx, sy}, {NX, 1}, {1,      0}),  // from y lower
+    face(field.data(), {sx, sy}, {NX, 1}, {1, NY + 1}) };// from y upper
+
+  mpi::persistent_request halo = mpi::neighbor_all_to_allw_init(grid, send, recv);
+
+  for(int step=0; step<NSTEPS; step++) {
+    for(int i=1; i<=NX; i++)
+      for(int j=1; j<=NY; j++) field[i*sy + j] = 100*step + rank;
+
+    if (step == 0)
+      mpi::neighbor_all_to_allw(grid, send, recv);
+    else {
+      halo.start();
+      halo.wait();
+    }
+
+    auto [xl, xu] = grid.shifted_ranks(0);
+    auto [yl, yu] = grid.shifted_ranks(1);
+    for(int j=1; j<=NY; j++) {
+      assert(field[0*sy + j]        == 100*step + xl);
+      assert(field[(NX + 1)*sy + j] == 100*step + xu);
+    }
+    for(int i=1; i<=NX; i++) {
+      assert(field[i*sy + 0]        == 100*step + yl);
+      assert(field[i*sy + NY + 1]   == 100*step + yu);
+    }
+    assert(field[0] == -1.0); // corners are not exchanged
+  }
+
+  return true;
+}
+
+
+int main(int argc, char* argv[])
+{
+  mpi::environment env(argc, argv);
+  mpi::communicator world;
+
+  bool f1 = test_cartesian(world);
+  bool f2 = test_graph(world);
+  bool f3 = test_halo(world);
+
+  assert(f1 && f2 && f3);
+
+  std::cout << "success!\n";
+
+  return 0;
+}
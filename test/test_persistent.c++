@@ -0,0 +1,121 @@
+// Copyright 2018 - 2026, Joonas Nättilä and the hel-astro-lab contributors
+// SPDX-License-Identifier: Apache-2.0
+
+#include <mpi4cpp/mpi.h>
+#include <iostream>
+
+#include <cassert>
+#include <vector>
+
+namespace mpi = mpi4cpp::mpi;
+
+using requests = std::vector<mpi::persistent_request>;
+
+
+#define NX 100
+#define NSTEPS 50
+
+// same exchange every step; buffers are updated in between
+bool test_wait_all(mpi::communicator& world)
+{
+  int other = 1 - world.rank();
+  std::vector<double> smsg(NX);
+  std::vector<double> rmsg(NX);
+  int sval, rval;
+
+  requests reqs;
+  reqs.push_back( world.send_init(other, 0, smsg.data(), NX) );
+  reqs.push_back( world.recv_init(other, 0, rmsg.data(), NX) );
+  reqs.push_back( world.send_init(other, 1, sval) );
+  reqs.push_back( world.recv_init(other, 1, rval) );
+
+  for(int step=0; step<NSTEPS; step++) {
+    for(auto& v : smsg) v = world.rank() + step;
+    sval = step;
+
+    mpi::start_all(reqs.begin(), reqs.end());
+    for(auto& req : reqs) assert(req.active());
+    mpi::wait_all(reqs.begin(), reqs.end());
+    for(auto& req : reqs) assert(!req.active());
+
+    for(auto v : rmsg) assert(v == other + step);
+    assert(rval == step);
+  }
+
+  return true;
+}
+
+// drain with test_some and wait_any
+bool test_partial_completion(mpi::communicator& world)
+{
+  int other = 1 - world.rank();
+  int smsg[4], rmsg[4];
+
+  requests sends, recvs;
+  for(int i=0; i<4; i++) {
+    sends.push_back( world.send_init(other, i, smsg[i]) );
+    recvs.push_back( world.recv_init(other, i, rmsg[i]) );
+  }
+
+  for(int step=0; step<NSTEPS; step++) {
+    for(int i=0; i<4; i++) smsg[i] = step*10 + i;
+
+    mpi::start_all(recvs.begin(), recvs.end());
+    mpi::start_all(sends.begin(), sends.end());
+
+    // receives: test_some until everything is in
+    auto pending = recvs.end();
+    while (pending != recvs.begin()) {
+      pending = mpi::test_some(recvs.begin(), pending);
+    }
+    for(int i=0; i<4; i++) assert(rmsg[i] == step*10 + i);
+
+    // sends: one at a time
+    for(int i=0; i<4; i++) {
+      auto res = mpi::wait_any(sends.begin(), sends.end());
+      assert(!res.second->active());
+    }
+    for(auto& req : sends) assert(!req.active());
+  }
+
+  return true;
+}
+
+// persistent sends are plain messages on the wire
+bool test_compat(mpi::communicator& world)
+{
+  std::vector<float> msg(NX, 1.0f);
+
+  if (world.rank() == 0) {
+    mpi::persistent_request req = world.send_init(1, 0, msg.data(), NX);
+    for(int step=0; step<3; step++) {
+      req.start();
+      while(!req.test()) {}
+    }
+  } else {
+    for(int step=0; step<3; step++) {
+      std::vector<float> rmsg;
+      world.recv(0, 0, rmsg);
+      assert(rmsg.size() == NX);
+    }
+  }
+
+  return true;
+}
+
+
+int main(int argc, char* argv[])
+{
+  mpi::environment env(argc, argv);
+  mpi::communicator world;
+
+  bool f1 = test_wait_all(world);
+  bool f2 = test_partial_completion(world);
+  bool f3 = test_compat(world);
+
+  assert(f1 && f2 && f3);
+
+  std::cout << "success!\n";
+
+  return 0;
+}
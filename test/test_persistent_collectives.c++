@@ -0,0 +1,129 @@
+// Copyright 2018 - 2026, Joonas Nättilä and the hel-astro-lab contributors
+// SPDX-License-Identifier: Apache-2.0
+
+#include <mpi4cpp/mpi.h>
+#include <iostream>
+
+#include <array>
+#include <cassert>
+#include <functional>
+#include <vector>
+
+
+//--------------------------------------------------
+namespace mpi = mpi4cpp::mpi;
+
+#define NX 10
+#define NSTEPS 5
+
+
+// the time step controller: the same reduction every step
+bool test_all_reduce_init(mpi::communicator& world)
+{
+  int rank = world.rank();
+  int size = world.size();
+
+  double local_dt = 0.0, dt = 0.0;
+  mpi::persistent_request min_dt = mpi::all_reduce_init(world, local_dt, dt, mpi::minimum<>());
+  assert(!min_dt.active());
+
+  std::array<long,NX> counts, totals;
+  mpi::persistent_request sum = mpi::all_reduce_init(world, counts, totals, std::plus<>());
+
+  // in place, user-defined operation
+  auto absmax = [](const int& a, const int& b) { return a*a > b*b ? a : b; };
+  std::vector<int> extrema(NX);
+  mpi::persistent_request ext = mpi::all_reduce_init(world, extrema.data(), NX,
+                                                     extrema.data(), absmax);
+
+  for(int step=0; step<NSTEPS; step++) {
+    local_dt = 1.0 + rank + step;
+    counts.fill(rank + step);
+    for(int i=0; i<NX; i++) extrema[i] = (rank == size - 1 ? -1 : 1)*(rank + step);
+
+    min_dt.start();
+    assert(min_dt.active());
+    sum.start();
+    ext.start();
+
+    min_dt.wait();
+    sum.wait();
+    while (!ext.test()) {}
+
+    assert(dt == 1.0 + step);
+    for(auto t : totals) assert(t == size*(size - 1)/2 + size*step);
+    for(auto e : extrema) assert(e == -(size - 1 + step));
+  }
+
+  return true;
+}
+
+bool test_broadcast_init(mpi::communicator& world)
+{
+  int rank = world.rank();
+
+  std::vector<float> params(NX);
+  mpi::persistent_request bcast = mpi::broadcast_init(world, params.data(), NX, 0);
+
+  int flag = 0;
+  mpi::persistent_request bflag = mpi::broadcast_init(world, flag, 1);
+  mpi::persistent_request barrier = mpi::barrier_init(world);
+
+  for(int step=0; step<NSTEPS; step++) {
+    if (rank == 0) for(int i=0; i<NX; i++) params[i] = step*NX + i;
+    if (rank == 1) flag = step;
+
+    std::vector<mpi::persistent_request> reqs{bcast, bflag, barrier};
+    mpi::start_all(reqs.begin(), reqs.end());
+    mpi::wait_all(reqs.begin(), reqs.end());
+
+    for(int i=0; i<NX; i++) assert(params[i] == step*NX + i);
+    assert(flag == step);
+  }
+
+  return true;
+}
+
+// a fixed halo pattern: rank s sends s + r + 1 values to rank r
+bool test_all_to_allv_init(mpi::communicator& world)
+{
+  int rank = world.rank();
+  int size = world.size();
+
+  std::vector<std::size_t> sizes;
+  for(int r=0; r<size; r++) sizes.push_back(rank + r + 1);
+  std::vector<double> halo(size*(rank + 1) + size*(size - 1)/2);
+
+  mpi::all_to_allv_buffer<double> incoming;
+  mpi::persistent_request exchange = mpi::all_to_allv_init(world, halo, sizes, incoming);
+
+  for(int s=0; s<size; s++) assert(incoming.count(s) == std::size_t(s + rank + 1));
+
+  for(int step=0; step<NSTEPS; step++) {
+    for(auto& h : halo) h = 100*rank + step;
+    exchange.start();
+    exchange.wait();
+
+    for(int s=0; s<size; s++)
+      for(auto p = incoming.begin(s); p != incoming.end(s); ++p) assert(*p == 100*s + step);
+  }
+
+  return true;
+}
+
+
+int main(int argc, char* argv[])
+{
+  mpi::environment env(argc, argv);
+  mpi::communicator world;
+
+  bool f1 = test_all_reduce_init(world);
+  bool f2 = test_broadcast_init(world);
+  bool f3 = test_all_to_allv_init(world);
+
+  assert(f1 && f2 && f3);
+
+  std::cout << "success!\n";
+
+  return 0;
+}
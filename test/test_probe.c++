@@ -0,0 +1,160 @@
+// Copyright 2018 - 2026, Joonas Nättilä and the hel-astro-lab contributors
+// SPDX-License-Identifier: Apache-2.0
+
+#include <mpi4cpp/mpi.h>
+#include <iostream>
+
+#include <cassert>
+#include <vector>
+#include <optional>
+#include <string>
+
+namespace mpi = mpi4cpp::mpi;
+
+
+// size the receive buffer from a probed message
+bool test_probe(mpi::communicator& world)
+{
+  if (world.rank() == 0) {
+    std::vector<double> msg(11, 1.0);
+    world.send(1, 3, &msg[0], msg.size());
+  } else {
+    mpi::status stat = world.probe(0, mpi::any_tag);
+    assert(stat.tag() == 3);
+    assert(stat.source() == 0);
+
+    std::optional<std::size_t> n = stat.count<double>();
+    assert(n && *n == 11);
+    assert(*stat.count<double>() == 11); // cached
+    assert(!stat.count<long double>());  // does not fit
+
+    std::vector<double> msg(*n);
+    world.recv(stat.source(), stat.tag(), &msg[0], *n);
+    for(auto v : msg) assert(v == 1.0);
+  }
+
+  return true;
+}
+
+// poll until a message shows up
+bool test_iprobe(mpi::communicator& world)
+{
+  if (world.rank() == 0) {
+    world.send(1, 4, 12);
+  } else {
+    std::optional<mpi::status> stat;
+    while (!(stat = world.iprobe())) {}
+    assert(stat->tag() == 4);
+    assert(*stat->count<int>() == 1);
+
+    int msg;
+    world.recv(0, 4, msg);
+    assert(msg == 12);
+  }
+
+  return true;
+}
+
+// drain many variable-size messages through matched handles
+bool test_mprobe(mpi::communicator& world)
+{
+  const int nmsgs = 10;
+
+  if (world.rank() == 0) {
+    for(int i=0; i<nmsgs; i++) {
+      std::vector<int> msg(i, i);
+      world.send(1, i, msg);
+    }
+  } else {
+    std::vector<std::vector<int>> msgs(nmsgs);
+    std::vector<mpi::request> reqs;
+
+    int received = 0;
+    while (received < nmsgs) {
+      if (std::optional<mpi::message> msg = world.improbe(0, mpi::any_tag)) {
+        int tag = msg->status().tag();
+        assert((int)*msg->status().count<int>() == tag);
+
+        // every second message is received in place, rest are blocking
+        if (tag % 2 == 0) {
+          reqs.push_back( msg->irecv(msgs[tag]) );
+          assert(reqs.back().trivial());
+        } else {
+          msg->recv(msgs[tag]);
+        }
+        assert(!*msg);
+        received++;
+      }
+    }
+    mpi::wait_all(reqs.begin(), reqs.end());
+
+    for(int i=0; i<nmsgs; i++) {
+      assert((int)msgs[i].size() == i);
+      for(auto v : msgs[i]) assert(v == i);
+    }
+  }
+
+  return true;
+}
+
+// blocking matched probe into single values
+bool test_mprobe_value(mpi::communicator& world)
+{
+  if (world.rank() == 0) {
+    world.send(1, 0, 2.5f);
+  } else {
+    mpi::message msg = world.mprobe();
+    assert(*msg.status().count<float>() == 1);
+
+    float val;
+    mpi::status stat = msg.recv(val);
+    assert(stat.source() == 0);
+    assert(val == 2.5f);
+  }
+
+  return true;
+}
+
+// a size that does not fit the element type is an error
+bool test_mprobe_mismatch(mpi::communicator& world)
+{
+  if (world.rank() == 0) {
+    world.send(1, 0, std::string("abc"));
+  } else if (world.rank() == 1) {
+    mpi::message msg = world.mprobe(0, 0);
+    std::vector<int> ints;
+    bool thrown = false;
+    try {
+      msg.recv(ints);
+    } catch (const mpi::MPI_Count_Error&) {
+      thrown = true;
+    }
+    assert(thrown && ints.empty());
+
+    // the message is still there
+    std::string str;
+    msg.recv(str);
+    assert(str == "abc");
+  }
+
+  return true;
+}
+
+
+int main(int argc, char* argv[])
+{
+  mpi::environment env(argc, argv);
+  mpi::communicator world;
+
+  bool f1 = test_probe(world);
+  bool f2 = test_iprobe(world);
+  bool f3 = test_mprobe(world);
+  bool f4 = test_mprobe_value(world);
+  bool f5 = test_mprobe_mismatch(world);
+
+  assert(f1 && f2 && f3 && f4 && f5);
+
+  std::cout << "success!\n";
+
+  return 0;
+}
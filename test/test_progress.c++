@@ -0,0 +1,106 @@
+// Copyright 2018 - 2026, Joonas Nättilä and the hel-astro-lab contributors
+// SPDX-License-Identifier: Apache-2.0
+
+#include <mpi4cpp/mpi.h>
+#include <iostream>
+
+#include <cassert>
+#include <vector>
+
+namespace mpi = mpi4cpp::mpi;
+
+using requests = std::vector<mpi::request>;
+
+
+#define NMSG 20
+#define NX 100
+
+// continuations run when the request is found complete
+bool test_then(mpi::communicator& world)
+{
+  int rank = world.rank();
+  int size = world.size();
+  int right = (rank + 1) % size;
+  int left  = (rank + size - 1) % size;
+
+  int in = -1, calls = 0;
+  mpi::request req = world.irecv(left, 0, in);
+  req.then([&](const mpi::status& stat) {
+    assert(stat.source() == left && in == left);
+    calls++;
+  });
+  assert(req.trivial() == nullptr);
+  world.send(right, 0, rank);
+  req.wait();
+  assert(calls == 1);
+
+  // also through the helpers of nonblocking.h
+  std::vector<double> vec(NX, rank), vin;
+  requests reqs;
+  reqs.push_back( world.irecv(left, 1, vin).then([&](const mpi::status&) { calls++; }) );
+  reqs.push_back( world.isend(right, 1, vec).then([&](const mpi::status&) { calls++; }) );
+  mpi::wait_all(reqs.begin(), reqs.end());
+  assert(calls == 3);
+  assert(vin.size() == NX && vin[0] == left);
+
+  return true;
+}
+
+// halo data is unpacked as it lands; replies are posted from callbacks
+bool test_engine(mpi::communicator& world)
+{
+  int rank = world.rank();
+  int size = world.size();
+  int right = (rank + 1) % size;
+  int left  = (rank + size - 1) % size;
+
+  std::vector<std::vector<int>> halos(NMSG);
+  std::vector<int> replies(NMSG, -1), sums(NMSG, 0);
+  std::vector<int> sent(NMSG);
+  int unpacked = 0;
+
+  mpi::progress_engine engine(2*NMSG);
+  for(int i=0; i<NMSG; i++) {
+    engine.post(world.irecv(left, i, halos[i]), [&, i](const mpi::status& stat) {
+      assert(stat.tag() == i);
+      for(auto v : halos[i]) sums[i] += v;
+      unpacked++;
+      // acknowledge to the sender
+      engine.post(world.isend(left, NMSG + i, sums[i]));
+    });
+    engine.post(world.irecv(right, NMSG + i, replies[i]));
+  }
+
+  for(int i=0; i<NMSG; i++) sent[i] = rank + i;
+  for(int i=0; i<NMSG; i++)
+    engine.post(world.isend(right, i, std::vector<int>(i + 1, sent[i])));
+
+  // interleave polling with other work
+  while (unpacked < NMSG / 2) engine.poll();
+  engine.run();
+  assert(engine.empty());
+
+  for(int i=0; i<NMSG; i++) {
+    assert(halos[i].size() == std::size_t(i + 1));
+    assert(sums[i] == (left + i)*(i + 1));
+    assert(replies[i] == (rank + i)*(i + 1));
+  }
+
+  return true;
+}
+
+
+int main(int argc, char* argv[])
+{
+  mpi::environment env(argc, argv);
+  mpi::communicator world;
+
+  bool f1 = test_then(world);
+  bool f2 = test_engine(world);
+
+  assert(f1 && f2);
+
+  std::cout << "success!\n";
+
+  return 0;
+}
@@ -0,0 +1,190 @@
+// Copyright 2018 - 2026, Joonas Nättilä and the hel-astro-lab contributors
+// SPDX-License-Identifier: Apache-2.0
+
+#include <mpi4cpp/mpi.h>
+#include <iostream>
+
+#include <array>
+#include <cassert>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__cpp_lib_span)
+#include <span>
+#endif
+
+namespace mpi = mpi4cpp::mpi;
+
+using requests = std::vector<mpi::request>;
+
+
+#define NX 100
+
+// minimal non-owning view into part of a buffer
+template<typename T>
+struct view
+{
+  T* ptr;
+  std::size_t len;
+
+  T* data() const { return ptr; }
+  std::size_t size() const { return len; }
+};
+
+
+// temporaries are accepted only if they refer to storage elsewhere
+template<typename R, typename = void>
+struct can_recv : std::false_type { };
+template<typename R>
+struct can_recv<R, std::void_t<decltype(
+    std::declval<mpi::communicator&>().recv(0, 0, std::declval<R>()))> > : std::true_type { };
+
+template<typename R, typename = void>
+struct can_irecv : std::false_type { };
+template<typename R>
+struct can_irecv<R, std::void_t<decltype(
+    std::declval<mpi::communicator&>().irecv(0, 0, std::declval<R>()))> > : std::true_type { };
+
+template<typename R, typename = void>
+struct can_broadcast : std::false_type { };
+template<typename R>
+struct can_broadcast<R, std::void_t<decltype(
+    mpi::broadcast(std::declval<mpi::communicator&>(), std::declval<R>(), 0))> > : std::true_type { };
+
+static_assert(can_recv<view<int>>::value && can_irecv<view<int>>::value &&
+              can_broadcast<view<int>>::value, "views are received into");
+static_assert(!can_recv<std::vector<int>>::value && !can_irecv<std::vector<int>>::value &&
+              !can_broadcast<std::vector<int>>::value, "temporary vectors are rejected");
+static_assert(!can_recv<std::string>::value && !can_irecv<std::string>::value &&
+              !can_broadcast<std::string>::value, "temporary strings are rejected");
+static_assert(!can_recv<std::array<int,4>>::value && !can_irecv<std::array<int,4>>::value,
+              "temporary arrays are rejected");
+static_assert(can_recv<std::vector<int>&>::value && can_irecv<std::string&>::value,
+              "containers are received into");
+
+
+// C arrays, std::array and user views go as plain arrays
+bool test_fixed(mpi::communicator& world)
+{
+  if (world.rank() == 0) {
+    int carr[4] = {1, 2, 3, 4};
+    world.send(1, 0, carr);
+
+    std::array<double,3> arr{ {1.5, 2.5, 3.5} };
+    world.send(1, 1, arr);
+
+    // send only the middle of a larger buffer
+    std::vector<int> buf(NX);
+    for(int i=0; i<NX; i++) buf[i] = i;
+    world.send(1, 2, view<const int>{buf.data() + 10, 20});
+  } else {
+    int carr[4];
+    world.recv(0, 0, carr);
+    for(int i=0; i<4; i++) assert(carr[i] == i+1);
+
+    std::array<double,3> arr;
+    mpi::status stat = world.recv(0, 1, arr);
+    assert(*stat.count<double>() == 3);
+    assert(arr[0] == 1.5 && arr[1] == 2.5 && arr[2] == 3.5);
+
+    // receive into the middle of a larger buffer through a temporary view
+    std::vector<int> buf(NX, -1);
+    world.recv(0, 2, view<int>{buf.data() + 30, 20});
+    for(int i=0; i<NX; i++) assert(buf[i] == (i >= 30 && i < 50 ? i - 20 : -1));
+  }
+
+  return true;
+}
+
+// strings are sent as their characters and resized on receipt
+bool test_strings(mpi::communicator& world)
+{
+  if (world.rank() == 0) {
+    std::string str = "hello world";
+    world.send(1, 0, str);
+    world.send(1, 1, std::string_view(str).substr(6));
+
+    requests reqs;
+    reqs.push_back( world.isend(1, 2, str) );
+    reqs.push_back( world.isend(1, 3, std::string(NX, 'x')) );
+    mpi::wait_all(reqs.begin(), reqs.end());
+  } else {
+    std::string str0, str1;
+    world.recv(0, 0, str0);
+    world.recv(0, 1, str1);
+    assert(str0 == "hello world");
+    assert(str1 == "world");
+
+    std::string str2, str3;
+    requests reqs;
+    reqs.push_back( world.irecv(0, 2, str2) );
+    reqs.push_back( world.irecv(0, 3, str3) );
+    mpi::wait_all(reqs.begin(), reqs.end());
+    assert(str2 == "hello world");
+    assert(str3 == std::string(NX, 'x'));
+  }
+
+  return true;
+}
+
+// non-blocking views into a shared buffer
+bool test_nonblocking(mpi::communicator& world)
+{
+  std::vector<float> sbuf(NX, static_cast<float>(world.rank() + 1));
+  std::vector<float> rbuf(NX, 0.0f);
+  int other = 1 - world.rank();
+
+  // exchange the two halves as separate messages
+  requests reqs;
+  reqs.push_back( world.isend(other, 0, view<float>{sbuf.data(), NX/2}) );
+  reqs.push_back( world.isend(other, 1, view<float>{sbuf.data() + NX/2, NX/2}) );
+  reqs.push_back( world.irecv(other, 1, view<float>{rbuf.data() + NX/2, NX/2}) );
+  reqs.push_back( world.irecv(other, 0, view<float>{rbuf.data(), NX/2}) );
+  mpi::wait_all(reqs.begin(), reqs.end());
+
+  for(auto v : rbuf) assert(v == static_cast<float>(other + 1));
+
+  return true;
+}
+
+#if defined(__cpp_lib_span)
+bool test_span(mpi::communicator& world)
+{
+  std::vector<long> buf(NX, world.rank());
+  int other = 1 - world.rank();
+
+  std::span<long> all(buf);
+  if (world.rank() == 0) {
+    world.send(other, 0, all.first(NX/2));
+  } else {
+    world.recv(other, 0, all.last(NX/2));
+    for(int i=0; i<NX; i++) assert(buf[i] == (i < NX/2 ? 1 : 0));
+  }
+
+  return true;
+}
+#endif
+
+
+int main(int argc, char* argv[])
+{
+  mpi::environment env(argc, argv);
+  mpi::communicator world;
+
+  bool f1 = test_fixed(world);
+  bool f2 = test_strings(world);
+  bool f3 = test_nonblocking(world);
+  assert(f1 && f2 && f3);
+
+#if defined(__cpp_lib_span)
+  bool f4 = test_span(world);
+  assert(f4);
+#endif
+
+  std::cout << "success!\n";
+
+  return 0;
+}
@@ -0,0 +1,163 @@
+// Copyright 2018 - 2026, Joonas Nättilä and the hel-astro-lab contributors
+// SPDX-License-Identifier: Apache-2.0
+
+#include <mpi4cpp/mpi.h>
+#include <iostream>
+
+#include <array>
+#include <cassert>
+#include <functional>
+#include <vector>
+
+
+struct Vec3
+{
+  double x, y, z;
+};
+
+MPI4CPP_STRUCT(Vec3, x, y, z)
+
+//--------------------------------------------------
+namespace mpi = mpi4cpp::mpi;
+
+static_assert(mpi::is_mpi_op<std::plus<double>, double>::value, "MPI_SUM");
+static_assert(mpi::is_mpi_op<mpi::maximum<>, long long>::value, "MPI_MAX");
+static_assert(mpi::is_mpi_op<std::bit_or<>, unsigned>::value, "MPI_BOR");
+static_assert(!mpi::is_mpi_op<std::bit_or<>, double>::value, "no MPI_BOR for double");
+static_assert(!mpi::is_mpi_op<std::plus<Vec3>, Vec3>::value, "user op");
+
+#define NX 10
+
+
+// built-in operations for scalars
+bool test_builtin(mpi::communicator& world)
+{
+  int rank = world.rank();
+  int size = world.size();
+
+  double sum = mpi::all_reduce(world, rank + 1.0, std::plus<double>());
+  assert(sum == size*(size + 1)/2.0);
+
+  int dt = mpi::all_reduce(world, 10 - rank, mpi::minimum<>());
+  assert(dt == 10 - (size - 1));
+
+  long long big = mpi::all_reduce(world, 1LL << (40 + rank), mpi::maximum<>());
+  assert(big == 1LL << (40 + size - 1));
+
+  unsigned mask = mpi::all_reduce(world, 1u << rank, std::bit_or<>());
+  assert(mask == (1u << size) - 1);
+
+  int any = mpi::all_reduce(world, rank == 0 ? 1 : 0, std::logical_or<int>());
+  assert(any == 1);
+
+  for(int root=0; root<size; root++) {
+    long prod = 0;
+    if (rank == root)
+      mpi::reduce(world, long(rank + 1), prod, std::multiplies<long>(), root);
+    else
+      mpi::reduce(world, long(rank + 1), std::multiplies<long>(), root);
+
+    if (rank == root) {
+      long expected = 1;
+      for(int i=1; i<=size; i++) expected *= i;
+      assert(prod == expected);
+    }
+  }
+
+  return true;
+}
+
+// arrays, ranges and vectors are reduced element by element
+bool test_arrays(mpi::communicator& world)
+{
+  int rank = world.rank();
+  int size = world.size();
+
+  std::array<double,NX> arr;
+  for(int i=0; i<NX; i++) arr[i] = rank*i;
+  std::array<double,NX> amax = mpi::all_reduce(world, arr, mpi::maximum<>());
+  for(int i=0; i<NX; i++) assert(amax[i] == (size - 1)*i);
+
+  // in place
+  std::vector<int> vec(NX, rank);
+  mpi::all_reduce(world, vec.data(), NX, vec.data(), std::plus<>());
+  for(auto v : vec) assert(v == size*(size - 1)/2);
+
+  std::vector<float> in(NX, 1.0f), out;
+  mpi::reduce(world, in, out, std::plus<float>(), 0);
+  if (rank == 0) {
+    assert(out.size() == NX);
+    for(auto v : out) assert(v == float(size));
+  } else
+    assert(out.empty());
+
+  std::vector<float> all;
+  mpi::all_reduce(world, in, all, std::plus<float>());
+  assert(all.size() == NX);
+  for(auto v : all) assert(v == float(size));
+
+  return true;
+}
+
+// lambdas and functors over user types get a cached MPI_Op
+bool test_user_ops(mpi::communicator& world)
+{
+  int rank = world.rank();
+  int size = world.size();
+
+  auto vsum = [](const Vec3& a, const Vec3& b) {
+    return Vec3{a.x + b.x, a.y + b.y, a.z + b.z};
+  };
+
+  Vec3 v{1.0, double(rank), -1.0};
+  Vec3 s = mpi::all_reduce(world, v, vsum);
+  assert(s.x == size && s.y == size*(size - 1)/2.0 && s.z == -size);
+
+  auto& slot = mpi::detail::mpi_op_slot<decltype(vsum), Vec3>;
+  MPI_Op op = slot.load();
+  assert(op != MPI_OP_NULL);
+  s = mpi::all_reduce(world, v, vsum);
+  assert(slot.load() == op);
+
+  // non-commutative: ranks are combined in order
+  auto concat = [](const long& a, const long& b) { return a*10 + b; };
+  long digits = mpi::all_reduce(world, long(rank + 1), concat);
+  long expected = 0;
+  for(int i=1; i<=size; i++) expected = expected*10 + i;
+  assert(digits == expected);
+
+  // state is seen by the operation
+  double weight = 0.5;
+  auto weighted = [weight](const double& a, const double& b) { return weight*(a + b); };
+  double w = mpi::all_reduce(world, 2.0, weighted);
+  assert(size != 2 || w == 2.0);
+
+  // element-wise over vectors of user types
+  std::vector<Vec3> vin(NX, v), vout;
+  mpi::all_reduce(world, vin, vout, vsum);
+  assert(vout.size() == NX);
+  for(auto& e : vout) assert(e.x == size && e.z == -size);
+
+  // bool has no built-in MPI type
+  bool all = mpi::all_reduce(world, true, std::logical_and<bool>());
+  assert(all);
+
+  return true;
+}
+
+
+int main(int argc, char* argv[])
+{
+  mpi::environment env(argc, argv);
+  mpi::communicator world;
+
+  bool f1 = test_builtin(world);
+  bool f2 = test_arrays(world);
+  bool f3 = test_user_ops(world);
+
+  assert(f1 && f2 && f3);
+
+  std::cout << "success!\n";
+
+  return 0;
+}
@@ -0,0 +1,133 @@
+// Copyright 2018 - 2026, Joonas Nättilä and the hel-astro-lab contributors
+// SPDX-License-Identifier: Apache-2.0
+
+#include <mpi4cpp/mpi.h>
+#include <iostream>
+
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+namespace mpi = mpi4cpp::mpi;
+
+
+// count the heap allocations of this process
+static std::atomic<long> allocations{0};
+
+void* operator new(std::size_t n)
+{
+  allocations++;
+  if (void* p = std::malloc(n ? n : 1)) return p;
+  throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+void* operator new(std::size_t n, std::align_val_t a)
+{
+  allocations++;
+  std::size_t align = static_cast<std::size_t>(a);
+  if (void* p = std::aligned_alloc(align, (n + align - 1)/align*align)) return p;
+  throw std::bad_alloc();
+}
+
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+
+
+#define NITER 1000
+#define NX 64
+
+// receives into vectors of unknown size, once the buffers have their capacity
+bool test_dynamic_irecv(mpi::communicator& world)
+{
+  int rank = world.rank();
+  int size = world.size();
+  int right = (rank + 1) % size;
+  int left  = (rank + size - 1) % size;
+
+  std::vector<double> out(NX, rank), in;
+  std::string sout(NX, 'a' + rank), sin;
+  in.reserve(NX);
+  sin.reserve(NX);
+
+  // the request_set does not allocate once it has its capacity either
+  mpi::request_set set(4);
+  auto exchange = [&](int i) {
+    set.add( world.irecv(left, i, in) );
+    set.add( world.irecv(left, NITER + i, sin) );
+    set.add( world.isend(right, i, out) );
+    set.add( world.isend(right, NITER + i, sout) );
+    set.wait_all();
+  };
+
+  // warm up the pool and MPI
+  for(int i=0; i<10; i++) exchange(i);
+
+  long before = allocations.load();
+  for(int i=0; i<NITER; i++) exchange(i);
+  long count = allocations.load() - before;
+
+  assert(in.size() == NX && in[0] == left);
+  assert(sin == std::string(NX, 'a' + left));
+
+  // the same request state with plain std::make_shared, as without the pool
+  using data_t = mpi::detail::dynamic_array_irecv_data<std::vector<double>>;
+  std::vector<std::shared_ptr<data_t>> states;
+  states.reserve(NITER);
+  before = allocations.load();
+  for(int i=0; i<NITER; i++) states.push_back(std::make_shared<data_t>(world, left, i, in));
+  long baseline = allocations.load() - before;
+
+  if (rank == 0)
+    std::cout << "allocations per dynamic receive: "
+              << double(count)/(2*NITER) << " (std::make_shared: "
+              << double(baseline)/NITER << ")\n";
+  assert(count == 0);
+  assert(baseline == NITER);
+
+  return true;
+}
+
+// the pool keeps a bounded number of blocks
+bool test_pool_cap()
+{
+  using pool_t = mpi::detail::pool_allocator<std::array<double,4>>;
+  pool_t alloc;
+  std::vector<std::array<double,4>*> blocks(4*NITER);
+
+  for(auto& b : blocks) b = alloc.allocate(1);
+  for(auto b : blocks) alloc.deallocate(b, 1);
+
+  // only part of a burst is served from the pool again
+  long before = allocations.load();
+  for(auto& b : blocks) b = alloc.allocate(1);
+  long count = allocations.load() - before;
+  for(auto b : blocks) alloc.deallocate(b, 1);
+
+  assert(count > 0 && count < long(blocks.size()));
+
+  return true;
+}
+
+
+int main(int argc, char* argv[])
+{
+  mpi::environment env(argc, argv);
+  mpi::communicator world;
+
+  bool f1 = test_dynamic_irecv(world);
+  bool f2 = test_pool_cap();
+
+  assert(f1 && f2);
+
+  std::cout << "success!\n";
+
+  return 0;
+}
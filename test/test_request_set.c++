@@ -0,0 +1,124 @@
+// Copyright 2018 - 2026, Joonas Nättilä and the hel-astro-lab contributors
+// SPDX-License-Identifier: Apache-2.0
+
+#include <mpi4cpp/mpi.h>
+#include <iostream>
+
+#include <cassert>
+#include <iterator>
+#include <memory>
+#include <vector>
+
+namespace mpi = mpi4cpp::mpi;
+
+using completions = std::vector<std::pair<mpi::status, std::size_t>>;
+
+
+#define NMSG 50
+#define NX 100
+
+// many trivial requests to and from the neighbours of a ring
+bool test_trivial(mpi::communicator& world)
+{
+  int rank = world.rank();
+  int size = world.size();
+  int right = (rank + 1) % size;
+  int left  = (rank + size - 1) % size;
+
+  std::vector<int> sent(NMSG), recvd(NMSG, -1);
+  std::vector<std::size_t> recv_slot(NMSG);
+  mpi::request_set set(2*NMSG);
+
+  for(int i=0; i<NMSG; i++) {
+    sent[i] = 1000*rank + i;
+    recv_slot[i] = set.add( world.irecv(left, i, recvd[i]) );
+    set.add( world.isend(right, i, sent[i]) );
+  }
+  assert(set.size() == 2*NMSG);
+
+  // complete one, then the rest in batches
+  auto first = set.wait_any();
+  assert(first.second < 2*NMSG);
+
+  completions done{first};
+  while (!set.empty()) set.wait_some(std::back_inserter(done));
+  assert(done.size() == 2*NMSG);
+
+  for(int i=0; i<NMSG; i++) assert(recvd[i] == 1000*left + i);
+  for(auto& d : done) {
+    for(int i=0; i<NMSG; i++)
+      if (d.second == recv_slot[i]) assert(d.first.tag() == i && d.first.source() == left);
+  }
+
+  // the slots are reused; no new ones are needed
+  std::size_t slot = set.add( world.irecv(left, 0, recvd[0]) );
+  assert(slot < 2*NMSG);
+  set.add( world.isend(right, 0, sent[0]) );
+  set.wait_all();
+  assert(set.empty());
+
+  return true;
+}
+
+// handler based requests share the set with trivial ones
+bool test_mixed(mpi::communicator& world)
+{
+  int rank = world.rank();
+  int size = world.size();
+  int right = (rank + 1) % size;
+  int left  = (rank + size - 1) % size;
+
+  std::vector<double> vec(NX + rank, rank), in;
+  std::string str(rank + 3, 'a'), instr;
+  int value = rank, invalue = -1;
+
+  mpi::request_set set;
+  std::size_t vslot = set.add( world.irecv(left, 1, in) );
+  std::size_t sslot = set.add( world.irecv(left, 2, instr) );
+  set.add( world.irecv(left, 3, invalue) );
+  set.add( world.isend(right, 1, vec) );
+  set.add( world.isend(right, 2, str) );
+  set.add( world.isend(right, 3, std::make_shared<const int>(value)) );
+
+  completions done;
+  while (!set.empty()) set.test_some(std::back_inserter(done));
+  assert(done.size() == 6);
+
+  bool seen_v = false, seen_s = false;
+  for(auto& d : done) {
+    seen_v = seen_v || d.second == vslot;
+    seen_s = seen_s || d.second == sslot;
+  }
+  assert(seen_v && seen_s);
+
+  assert(in.size() == std::size_t(NX + left));
+  for(auto v : in) assert(v == left);
+  assert(instr == std::string(left + 3, 'a'));
+  assert(invalue == left);
+
+  // wait_all reports every request
+  set.add( world.irecv(left, 4, in) );
+  set.add( world.isend(right, 4, vec) );
+  done.clear();
+  set.wait_all(std::back_inserter(done));
+  assert(done.size() == 2 && set.empty());
+  assert(!set.test_any());
+
+  return true;
+}
+
+
+int main(int argc, char* argv[])
+{
+  mpi::environment env(argc, argv);
+  mpi::communicator world;
+
+  bool f1 = test_trivial(world);
+  bool f2 = test_mixed(world);
+
+  assert(f1 && f2);
+
+  std::cout << "success!\n";
+
+  return 0;
+}
@@ -0,0 +1,109 @@
+// Copyright 2018 - 2026, Joonas Nättilä and the hel-astro-lab contributors
+// SPDX-License-Identifier: Apache-2.0
+
+#include <mpi4cpp/mpi.h>
+#include <iostream>
+
+#include <array>
+#include <cassert>
+#include <vector>
+
+
+struct Particle
+{
+  std::array<double,3> pos;
+  long id;
+};
+
+MPI4CPP_STRUCT(Particle, pos, id)
+
+//--------------------------------------------------
+namespace mpi = mpi4cpp::mpi;
+
+#define NX 10
+
+
+bool test_scatter(mpi::communicator& world)
+{
+  int rank = world.rank();
+  int size = world.size();
+
+  for(int root=0; root<size; root++) {
+    int value = -1;
+    if (rank == root) {
+      std::vector<int> values;
+      for(int r=0; r<size; r++) values.push_back(10*r);
+      mpi::scatter(world, values, value, root);
+    } else
+      mpi::scatter(world, value, root);
+    assert(value == 10*rank);
+  }
+
+  // arrays of the same length
+  std::vector<double> slice(NX);
+  if (rank == 0) {
+    std::vector<double> all(size*NX);
+    for(int i=0; i<size*NX; i++) all[i] = i;
+    mpi::scatter(world, all.data(), slice.data(), NX, 0);
+  } else
+    mpi::scatter(world, slice.data(), NX, 0);
+  for(int i=0; i<NX; i++) assert(slice[i] == rank*NX + i);
+
+  return true;
+}
+
+// initial loading: the root holds the particles of all ranks
+bool test_scatterv(mpi::communicator& world)
+{
+  int rank = world.rank();
+  int size = world.size();
+
+  // rank r gets 3*r particles, i.e. none for rank 0
+  std::vector<Particle> mine(5);
+  if (rank == 1) {
+    std::vector<Particle> all;
+    std::vector<std::size_t> sizes;
+    for(int r=0; r<size; r++) {
+      sizes.push_back(3*r);
+      for(int i=0; i<3*r; i++) all.push_back(Particle{ {{double(r), 0.0, 0.0}}, 100*r + i });
+    }
+    mpi::scatterv(world, all, sizes, mine, 1);
+  } else
+    mpi::scatterv(world, mine, 1);
+
+  assert(mine.size() == std::size_t(3*rank));
+  for(int i=0; i<3*rank; i++) {
+    assert(mine[i].pos[0] == rank);
+    assert(mine[i].id == 100*rank + i);
+  }
+
+  // and from per-rank vectors
+  std::vector<int> block;
+  if (rank == 0) {
+    std::vector<std::vector<int>> blocks(size);
+    for(int r=0; r<size; r++) blocks[r].assign(r + 1, r);
+    mpi::scatterv(world, blocks, block, 0);
+  } else
+    mpi::scatterv(world, block, 0);
+
+  assert(block.size() == std::size_t(rank + 1));
+  for(auto v : block) assert(v == rank);
+
+  return true;
+}
+
+
+int main(int argc, char* argv[])
+{
+  mpi::environment env(argc, argv);
+  mpi::communicator world;
+
+  bool f1 = test_scatter(world);
+  bool f2 = test_scatterv(world);
+
+  assert(f1 && f2);
+
+  std::cout << "success!\n";
+
+  return 0;
+}
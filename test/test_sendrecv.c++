@@ -0,0 +1,121 @@
+// Copyright 2018 - 2026, Joonas Nättilä and the hel-astro-lab contributors
+// SPDX-License-Identifier: Apache-2.0
+
+#include <mpi4cpp/mpi.h>
+#include <iostream>
+
+#include <cassert>
+#include <array>
+#include <vector>
+
+namespace mpi = mpi4cpp::mpi;
+
+
+#define NX 100
+
+// both sides send first; would deadlock with large blocking sends
+template<typename T>
+bool test_value(mpi::communicator& world)
+{
+  int other = 1 - world.rank();
+  T smsg = static_cast<T>(world.rank() + 1);
+  T rmsg = static_cast<T>(3);
+
+  mpi::status stat = world.sendrecv(other, world.rank(), smsg, other, other, rmsg);
+  assert(stat.source() == other);
+  assert(stat.tag() == other);
+  assert(rmsg == static_cast<T>(other + 1));
+
+  // in place
+  T msg = static_cast<T>(world.rank() + 1);
+  world.sendrecv_replace(other, 0, other, 0, msg);
+  assert(msg == static_cast<T>(other + 1));
+
+  return true;
+}
+
+template<typename T>
+bool test_carray(mpi::communicator& world)
+{
+  int other = 1 - world.rank();
+  T smsg[NX];
+  T rmsg[NX];
+  for(int i=0; i<NX; i++) smsg[i] = static_cast<T>(world.rank() + 1);
+
+  world.sendrecv(other, 0, &smsg[0], NX, other, 0, &rmsg[0], NX);
+  for(int i=0; i<NX; i++) assert(rmsg[i] == static_cast<T>(other + 1));
+
+  world.sendrecv_replace(other, 1, other, 1, &smsg[0], NX);
+  for(int i=0; i<NX; i++) assert(smsg[i] == static_cast<T>(other + 1));
+
+  return true;
+}
+
+template<typename T>
+bool test_array(mpi::communicator& world)
+{
+  int other = 1 - world.rank();
+  std::array<T, NX> smsg;
+  std::array<T, NX> rmsg;
+  smsg.fill(static_cast<T>(world.rank() + 1));
+
+  world.sendrecv(other, 0, smsg, other, 0, rmsg);
+  for(auto v : rmsg) assert(v == static_cast<T>(other + 1));
+
+  world.sendrecv_replace(other, 1, other, 1, smsg);
+  for(auto v : smsg) assert(v == static_cast<T>(other + 1));
+
+  return true;
+}
+
+// vectors of different lengths in each direction
+template<typename T>
+bool test_vector(mpi::communicator& world)
+{
+  int other = 1 - world.rank();
+  std::vector<T> smsg(NX + world.rank(), static_cast<T>(world.rank() + 1));
+  std::vector<T> rmsg;
+
+  world.sendrecv(other, 0, smsg, mpi::any_source, mpi::any_tag, rmsg);
+  assert((int)rmsg.size() == NX + other);
+  for(auto v : rmsg) assert(v == static_cast<T>(other + 1));
+
+  // interoperates with plain send/recv
+  if (world.rank() == 0) {
+    world.sendrecv(1, 1, smsg, 1, 1, rmsg);
+  } else {
+    world.recv(0, 1, rmsg);
+    world.send(0, 1, smsg);
+  }
+  assert((int)rmsg.size() == NX + other);
+
+  return true;
+}
+
+template<typename T>
+bool test_all(mpi::communicator& world)
+{
+  bool f1 = test_value<T>(world);
+  bool f2 = test_carray<T>(world);
+  bool f3 = test_array<T>(world);
+  bool f4 = test_vector<T>(world);
+
+  return f1 && f2 && f3 && f4;
+}
+
+
+int main(int argc, char* argv[])
+{
+  mpi::environment env(argc, argv);
+  mpi::communicator world;
+
+  test_all<int>(world);
+  test_all<long>(world);
+  test_all<float>(world);
+  test_all<double>(world);
+  test_all<unsigned>(world);
+
+  std::cout << "success!\n";
+
+  return 0;
+}
@@ -0,0 +1,164 @@
+// Copyright 2018 - 2026, Joonas Nättilä and the hel-astro-lab contributors
+// SPDX-License-Identifier: Apache-2.0
+
+#include <mpi4cpp/mpi.h>
+#include <iostream>
+
+#include <array>
+#include <cassert>
+#include <vector>
+
+
+/// user-defined classes
+struct Blob
+{
+  int ivar;
+  float var;
+  std::array<double,3> x;
+};
+
+namespace physics {
+  struct Particle
+  {
+    double pos[3];
+    double vel[3];
+    Blob* owner;   // not transmitted
+    char kind;     // trailing padding
+  };
+
+  struct Cell
+  {
+    Blob blob;
+    std::array<Particle,2> prtcls;
+    long id;
+  };
+}
+
+// introduce classes to mpi
+MPI4CPP_STRUCT(Blob, ivar, var, x)
+MPI4CPP_STRUCT(physics::Particle, pos, vel, kind)
+MPI4CPP_STRUCT(physics::Cell, blob, prtcls, id)
+
+//--------------------------------------------------
+namespace mpi = mpi4cpp::mpi;
+
+static_assert(mpi::is_mpi_datatype<Blob>::value, "Blob is an MPI datatype");
+static_assert(mpi::is_mpi_datatype<physics::Cell>::value, "Cell is an MPI datatype");
+
+
+#define NX 10
+
+physics::Particle make_particle(int i)
+{
+  physics::Particle p;
+  for(int d=0; d<3; d++) {
+    p.pos[d] = i + 0.1*d;
+    p.vel[d] = -i - 0.1*d;
+  }
+  p.owner = nullptr;
+  p.kind  = static_cast<char>('a' + i);
+  return p;
+}
+
+void check_particle(const physics::Particle& p, int i)
+{
+  for(int d=0; d<3; d++) {
+    assert(p.pos[d] == i + 0.1*d);
+    assert(p.vel[d] == -i - 0.1*d);
+  }
+  assert(p.kind == static_cast<char>('a' + i));
+}
+
+
+// the datatype is built once and has the extent of the struct
+bool test_cached(mpi::communicator& /*world*/)
+{
+  MPI_Datatype t1 = mpi::get_mpi_datatype<physics::Particle>();
+  MPI_Datatype t2 = mpi::get_mpi_datatype<physics::Particle>();
+  assert(t1 == t2);
+
+  MPI_Aint lb, extent;
+  MPI_Type_get_extent(t1, &lb, &extent);
+  assert(lb == 0);
+  assert(extent == sizeof(physics::Particle));
+
+  int size;
+  MPI_Type_size(t1, &size);
+  assert(size == int(6*sizeof(double) + sizeof(char)));
+
+  return true;
+}
+
+bool test_single(mpi::communicator& world)
+{
+  if (world.rank() == 0) {
+    Blob blob{10, 11.0f, {{12.0, 13.0, 14.0}} };
+    world.send(1, 0, blob);
+  } else {
+    Blob blob;
+    world.recv(0, 0, blob);
+    assert(blob.ivar == 10 && blob.var == 11.0f);
+    assert(blob.x[0] == 12.0 && blob.x[1] == 13.0 && blob.x[2] == 14.0);
+  }
+
+  return true;
+}
+
+// arrays of padded structs need the resized extent
+bool test_vector(mpi::communicator& world)
+{
+  int other = 1 - world.rank();
+
+  std::vector<physics::Particle> sprtcls, rprtcls;
+  for(int i=0; i<NX; i++) sprtcls.push_back(make_particle(world.rank()*NX + i));
+
+  std::vector<mpi::request> reqs;
+  reqs.push_back( world.isend(other, 0, sprtcls) );
+  reqs.push_back( world.irecv(other, 0, rprtcls) );
+  mpi::wait_all(reqs.begin(), reqs.end());
+
+  assert(rprtcls.size() == NX);
+  for(int i=0; i<NX; i++) check_particle(rprtcls[i], other*NX + i);
+
+  return true;
+}
+
+// structs of structs
+bool test_nested(mpi::communicator& world)
+{
+  if (world.rank() == 0) {
+    physics::Cell cell;
+    cell.blob = Blob{1, 2.0f, {{3.0, 4.0, 5.0}} };
+    cell.prtcls[0] = make_particle(6);
+    cell.prtcls[1] = make_particle(7);
+    cell.id = 8;
+    world.send(1, 0, cell);
+  } else {
+    physics::Cell cell;
+    world.recv(0, 0, cell);
+    assert(cell.blob.ivar == 1 && cell.blob.var == 2.0f && cell.blob.x[2] == 5.0);
+    check_particle(cell.prtcls[0], 6);
+    check_particle(cell.prtcls[1], 7);
+    assert(cell.id == 8);
+  }
+
+  return true;
+}
+
+
+int main(int argc, char* argv[])
+{
+  mpi::environment env(argc, argv);
+  mpi::communicator world;
+
+  bool f1 = test_cached(world);
+  bool f2 = test_single(world);
+  bool f3 = test_vector(world);
+  bool f4 = test_nested(world);
+
+  assert(f1 && f2 && f3 && f4);
+
+  std::cout << "success!\n";
+
+  return 0;
+}
@@ -0,0 +1,169 @@
+// Copyright 2018 - 2026, Joonas Nättilä and the hel-astro-lab contributors
+// SPDX-License-Identifier: Apache-2.0
+
+#include <mpi4cpp/mpi.h>
+#include <iostream>
+
+#include <cassert>
+#include <vector>
+
+namespace mpi = mpi4cpp::mpi;
+
+using requests = std::vector<mpi::request>;
+
+
+// row-major grid with one ghost cell on each side
+#define NX 6
+#define NY 5
+#define NZ 4
+
+inline int idx(int i, int j, int k) { return (i*NY + j)*NZ + k; }
+
+inline double value(int rank, int i, int j, int k)
+{
+  return rank*1000.0 + idx(i, j, k);
+}
+
+
+// strided columns of a matrix
+bool test_strided(mpi::communicator& world)
+{
+  std::vector<int> mat(NX*NY);
+  for(int i=0; i<NX*NY; i++) mat[i] = i;
+
+  if (world.rank() == 0) {
+    // column 2 of a NX x NY matrix
+    mpi::strided_view<const int> col(mat.data() + 2, NX, 1, NY);
+    assert(col.elements() == NX);
+    world.send(1, 0, col);
+    world.send(1, 1, col);
+  } else {
+    // into a contiguous array...
+    std::vector<int> col(NX);
+    world.recv(0, 0, col.data(), NX);
+    for(int i=0; i<NX; i++) assert(col[i] == i*NY + 2);
+
+    // ...and into column 4 of another matrix
+    std::vector<int> dst(NX*NY, -1);
+    mpi::status stat = world.recv(0, 1, mpi::strided_view<int>(dst.data() + 4, NX, 1, NY));
+    assert(*stat.count<int>() == NX);
+    for(int i=0; i<NX; i++)
+      for(int j=0; j<NY; j++)
+        assert(dst[i*NY + j] == (j == 4 ? i*NY + 2 : -1));
+  }
+
+  return true;
+}
+
+// same shapes share one datatype
+bool test_cache(mpi::communicator& /*world*/)
+{
+  std::vector<double> a(NX*NY*NZ), b(NX*NY*NZ);
+
+  mpi::subarray<double,3> fa(a.data(), {NX, NY, NZ}, {1, NY, NZ}, {0, 0, 0});
+  mpi::subarray<const double,3> fb(b.data(), {NX, NY, NZ}, {1, NY, NZ}, {0, 0, 0});
+  mpi::subarray<double,3> fc(a.data(), {NX, NY, NZ}, {1, NY, NZ}, {NX-1, 0, 0});
+  assert(fa.datatype() == fb.datatype());
+  assert(fa.datatype() != fc.datatype());
+  assert(fa.elements() == NY*NZ);
+
+  mpi::subarray<float,3> fd(nullptr, {NX, NY, NZ}, {1, NY, NZ}, {0, 0, 0});
+  assert(fa.datatype() != fd.datatype());
+
+  mpi::strided_view<double> sa(a.data(), NX, 2, NY), sb(b.data() + 1, NX, 2, NY);
+  assert(sa.datatype() == sb.datatype());
+
+  return true;
+}
+
+// exchange the six faces of a 3D grid with the other rank
+bool test_faces(mpi::communicator& world)
+{
+  int rank = world.rank();
+  int other = 1 - rank;
+
+  std::vector<double> field(NX*NY*NZ);
+  for(int i=0; i<NX; i++)
+  for(int j=0; j<NY; j++)
+  for(int k=0; k<NZ; k++) field[idx(i,j,k)] = value(rank, i, j, k);
+
+  // interior faces are sent, ghost faces received
+  using face = mpi::subarray<double,3>;
+  std::vector<face> sends = {
+    face(field.data(), {NX, NY, NZ}, {1, NY-2, NZ-2}, {1, 1, 1}),
+    face(field.data(), {NX, NY, NZ}, {NX-2, 1, NZ-2}, {1, 1, 1}),
+    face(field.data(), {NX, NY, NZ}, {NX-2, NY-2, 1}, {1, 1, 1}),
+  };
+  std::vector<face> recvs = {
+    face(field.data(), {NX, NY, NZ}, {1, NY-2, NZ-2}, {0, 1, 1}),
+    face(field.data(), {NX, NY, NZ}, {NX-2, 1, NZ-2}, {1, 0, 1}),
+    face(field.data(), {NX, NY, NZ}, {NX-2, NY-2, 1}, {1, 1, 0}),
+  };
+
+  requests reqs;
+  for(int d=0; d<3; d++) {
+    reqs.push_back( world.irecv(other, d, recvs[d]) );
+    reqs.push_back( world.isend(other, d, sends[d]) );
+  }
+  mpi::wait_all(reqs.begin(), reqs.end());
+
+  // ghost cells hold the neighbour's first interior layer
+  for(int j=1; j<NY-1; j++)
+  for(int k=1; k<NZ-1; k++) assert(field[idx(0,j,k)] == value(other, 1, j, k));
+  for(int i=1; i<NX-1; i++)
+  for(int k=1; k<NZ-1; k++) assert(field[idx(i,0,k)] == value(other, i, 1, k));
+  for(int i=1; i<NX-1; i++)
+  for(int j=1; j<NY-1; j++) assert(field[idx(i,j,0)] == value(other, i, j, 1));
+
+  // edges and corners were not touched
+  assert(field[idx(0,0,0)] == value(rank, 0, 0, 0));
+  assert(field[idx(0,0,1)] == value(rank, 0, 0, 1));
+
+  return true;
+}
+
+// the same halo exchange repeated with persistent requests
+bool test_persistent(mpi::communicator& world)
+{
+  int other = 1 - world.rank();
+  std::vector<double> field(NX*NY*NZ, 0.0);
+
+  mpi::subarray<double,3> top(field.data(), {NX, NY, NZ}, {1, NY, NZ}, {NX-2, 0, 0});
+  mpi::subarray<double,3> ghost(field.data(), {NX, NY, NZ}, {1, NY, NZ}, {0, 0, 0});
+
+  std::vector<mpi::persistent_request> reqs = {
+    world.recv_init(other, 0, ghost),
+    world.send_init(other, 0, top),
+  };
+
+  for(int step=0; step<3; step++) {
+    for(int j=0; j<NY; j++)
+    for(int k=0; k<NZ; k++) field[idx(NX-2,j,k)] = world.rank() + step;
+
+    mpi::start_all(reqs.begin(), reqs.end());
+    mpi::wait_all(reqs.begin(), reqs.end());
+
+    for(int j=0; j<NY; j++)
+    for(int k=0; k<NZ; k++) assert(field[idx(0,j,k)] == other + step);
+  }
+
+  return true;
+}
+
+
+int main(int argc, char* argv[])
+{
+  mpi::environment env(argc, argv);
+  mpi::communicator world;
+
+  bool f1 = test_strided(world);
+  bool f2 = test_cache(world);
+  bool f3 = test_faces(world);
+  bool f4 = test_persistent(world);
+
+  assert(f1 && f2 && f3 && f4);
+
+  std::cout << "success!\n";
+
+  return 0;
+}
@@ -0,0 +1,155 @@
+// Copyright 2018 - 2026, Joonas Nättilä and the hel-astro-lab contributors
+// SPDX-License-Identifier: Apache-2.0
+
+#include <mpi4cpp/mpi.h>
+#include <iostream>
+
+#include <cassert>
+#include <vector>
+
+namespace mpi = mpi4cpp::mpi;
+
+using requests = std::vector<mpi::request>;
+
+
+// blocking sends are received with nonblocking receives and vice versa
+bool test_mixed_formats(mpi::communicator& world)
+{
+  std::vector<double> smsg(17, world.rank() + 1.0);
+  std::vector<double> rmsg;
+  int other = 1 - world.rank();
+
+  if (world.rank() == 0) {
+    world.send(other, 0, smsg);
+    requests reqs(1);
+    reqs[0] = world.irecv(other, 1, rmsg);
+    mpi::wait_all(reqs.begin(), reqs.end());
+  } else {
+    mpi::request req = world.irecv(other, 0, rmsg);
+    req.wait();
+    mpi::request sreq = world.isend(other, 1, smsg);
+    sreq.wait();
+  }
+
+  assert(rmsg.size() == 17);
+  for(auto v : rmsg) assert(v == other + 1.0);
+
+  return true;
+}
+
+// receiver does not know who sends or with which tag
+bool test_any_source_tag(mpi::communicator& world)
+{
+  std::vector<int> msg;
+
+  if (world.rank() == 0) {
+    for(int i=0; i<5; i++) msg.push_back(i);
+    world.send(1, 42, msg);
+  } else {
+    mpi::status stat = world.recv(mpi::any_source, mpi::any_tag, msg);
+    assert(stat.source() == 0);
+    assert(stat.tag() == 42);
+    assert(msg.size() == 5);
+    for(int i=0; i<5; i++) assert(msg[i] == i);
+  }
+
+  return true;
+}
+
+// empty vectors shrink the receive buffer
+bool test_empty(mpi::communicator& world)
+{
+  std::vector<float> msg(10, 1.0f);
+
+  if (world.rank() == 0) {
+    std::vector<float> empty;
+    world.send(1, 0, empty);
+    mpi::request req = world.isend(1, 1, empty);
+    req.wait();
+  } else {
+    world.recv(0, 0, msg);
+    assert(msg.empty());
+
+    msg.resize(10);
+    mpi::request req = world.irecv(0, 1, msg);
+    while(!req.test()) {}
+    assert(msg.empty());
+    assert(!req.active());
+  }
+
+  return true;
+}
+
+// pending vector receives are seen by wait_any
+bool test_wait_any(mpi::communicator& world)
+{
+  std::vector<long> msg0, msg1;
+
+  if (world.rank() == 0) {
+    world.send(1, 1, std::vector<long>(3, 3));
+    world.send(1, 0, std::vector<long>(7, 7));
+  } else {
+    requests reqs(2);
+    reqs[0] = world.irecv(0, 0, msg0);
+    reqs[1] = world.irecv(0, 1, msg1);
+    assert(reqs[0].active() && reqs[1].active());
+
+    auto res1 = mpi::wait_any(reqs.begin(), reqs.end());
+    assert(!res1.second->active());
+    auto res2 = mpi::wait_any(reqs.begin(), reqs.end());
+    assert(res1.second != res2.second);
+
+    assert(msg0.size() == 7);
+    assert(msg1.size() == 3);
+  }
+
+  return true;
+}
+
+// messages that have arrived are matched in posting order
+bool test_posting_order(mpi::communicator& world)
+{
+  std::vector<int> first, second;
+
+  if (world.rank() == 0) {
+    world.send(1, 2, std::vector<int>(2, 1));
+    world.send(1, 2, std::vector<int>(5, 2));
+    world.send(1, 3, 0);
+  } else if (world.rank() == 1) {
+    // the last message has arrived, and with it the earlier ones
+    world.probe(0, 3);
+    requests reqs(2);
+    reqs[0] = world.irecv(0, 2, first);
+    reqs[1] = world.irecv(0, 2, second);
+
+    // completed out of order
+    reqs[1].wait();
+    reqs[0].wait();
+    assert(first.size() == 2 && first[0] == 1);
+    assert(second.size() == 5 && second[0] == 2);
+
+    int last;
+    world.recv(0, 3, last);
+  }
+
+  return true;
+}
+
+
+int main(int argc, char* argv[])
+{
+  mpi::environment env(argc, argv);
+  mpi::communicator world;
+
+  bool f1 = test_mixed_formats(world);
+  bool f2 = test_any_source_tag(world);
+  bool f3 = test_empty(world);
+  bool f4 = test_wait_any(world);
+  bool f5 = test_posting_order(world);
+
+  assert(f1 && f2 && f3 && f4 && f5);
+
+  std::cout << "success!\n";
+
+  return 0;
+}